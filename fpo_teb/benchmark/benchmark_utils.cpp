@@ -0,0 +1,279 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#include "benchmark_utils.h"
+
+#include <teb_local_planner/optimal_planner.h>
+#include <teb_local_planner/homotopy_class_planner.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <sched.h>
+
+
+namespace teb_local_planner
+{
+
+namespace
+{
+
+//! Escape quotes and backslashes for embedding \c value into a json string
+std::string escapeJson(const std::string& value)
+{
+  std::string escaped;
+  for (char c : value)
+  {
+    if (c == '"' || c == '\\')
+      escaped.push_back('\\');
+    escaped.push_back(c);
+  }
+  return escaped;
+}
+
+//! Number of poses of the trajectory selected by the planner
+int trajectorySize(const PlannerInterfacePtr& planner)
+{
+  if (HomotopyClassPlannerPtr hcp = boost::dynamic_pointer_cast<HomotopyClassPlanner>(planner))
+  {
+    TebOptimalPlannerPtr best_teb = hcp->bestTeb();
+    return best_teb ? best_teb->teb().sizePoses() : 0;
+  }
+  if (TebOptimalPlannerPtr teb = boost::dynamic_pointer_cast<TebOptimalPlanner>(planner))
+    return teb->teb().sizePoses();
+  return 0;
+}
+
+/**
+ * @brief Run the planner on the given cycles
+ * @param planner Planner operating on \c obstacles and \c via_points
+ * @param obstacles Obstacle container of the planner, assigned for each cycle
+ * @param via_points Via-point container of the planner, assigned for each cycle
+ * @param cycles Inputs of the planning cycles
+ * @param measure Append the measurements of each plan() call to \c result
+ * @param result Measurements
+ */
+void runCycles(const PlannerInterfacePtr& planner, ObstContainer& obstacles, ViaPointContainer& via_points,
+               const std::vector<PlanningCycleInput>& cycles, bool measure, BenchmarkResult& result)
+{
+  for (const PlanningCycleInput& cycle : cycles)
+  {
+    obstacles = cycle.obstacles;
+    via_points = cycle.via_points;
+    planner->setObstaclePredictions(cycle.predictions);
+    geometry_msgs::Twist robot_vel = cycle.robot_vel;
+    unsigned long iterations = planner->getSolverIterations();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool success = planner->plan(cycle.plan, &robot_vel, cycle.free_goal_vel);
+    std::chrono::duration<double> latency = std::chrono::steady_clock::now() - start;
+
+    if (!measure)
+      continue;
+    result.latencies.push_back(latency.count());
+    result.iterations.push_back(planner->getSolverIterations() - iterations);
+    result.poses.push_back(trajectorySize(planner));
+    if (!success)
+      ++result.failures;
+  }
+}
+
+} // anonymous namespace
+
+
+PlannerInterfacePtr createPlanner(const std::string& planner_type, const TebConfig& cfg, ObstContainer* obstacles,
+                                  RobotFootprintModelPtr robot_model, ViaPointContainer* via_points)
+{
+  if (planner_type == "hcp")
+    return PlannerInterfacePtr(new HomotopyClassPlanner(cfg, obstacles, robot_model, TebVisualizationPtr(), via_points));
+  if (planner_type == "teb")
+    return PlannerInterfacePtr(new TebOptimalPlanner(cfg, obstacles, robot_model, TebVisualizationPtr(), via_points));
+  ROS_ERROR("Unknown planner type '%s'.", planner_type.c_str());
+  return PlannerInterfacePtr();
+}
+
+
+BenchmarkResult runPlanningCycles(const std::string& name, const std::string& planner_type, const TebConfig& cfg,
+                                  RobotFootprintModelPtr robot_model, const nav_msgs::OccupancyGrid* costmap,
+                                  const std::vector<PlanningCycleInput>& cycles, int warmup, int repetitions)
+{
+  BenchmarkResult result;
+  result.name = name;
+
+  ObstContainer obstacles;
+  ViaPointContainer via_points;
+  PlannerInterfacePtr planner = createPlanner(planner_type, cfg, &obstacles, robot_model, &via_points);
+  if (!planner)
+    return result;
+
+  if (costmap)
+    planner->setGlobalCostmap(*costmap);
+
+  for (int repetition = 0; repetition < warmup + repetitions; ++repetition)
+  {
+    // each repetition runs the complete sequence, starting without a warm start
+    planner->clearPlanner();
+    runCycles(planner, obstacles, via_points, cycles, repetition >= warmup, result);
+  }
+  return result;
+}
+
+
+BenchmarkResult runPlanningCycles(const std::string& name, const std::string& planner_type,
+                                  const std::vector<PlanningSegment>& segments, int warmup, int repetitions)
+{
+  BenchmarkResult result;
+  result.name = name;
+  if (segments.empty())
+    return result;
+
+  // the planner refers to cfg, which is updated in place at the beginning of each segment
+  TebConfig cfg;
+  ObstContainer obstacles;
+  ViaPointContainer via_points;
+  PlannerInterfacePtr planner = createPlanner(planner_type, cfg, &obstacles, segments.front().robot_model, &via_points);
+  if (!planner)
+    return result;
+
+  for (int repetition = 0; repetition < warmup + repetitions; ++repetition)
+  {
+    // each repetition runs the complete sequence, starting without a warm start
+    planner->clearPlanner();
+    for (const PlanningSegment& segment : segments)
+    {
+      if (!segment.config.empty())
+        decodeConfig(segment.config.data(), segment.config.size(), cfg);
+      planner->updateRobotModel(segment.robot_model);
+      if (segment.costmap)
+        planner->setGlobalCostmap(*segment.costmap);
+
+      runCycles(planner, obstacles, via_points, segment.cycles, repetition >= warmup, result);
+    }
+  }
+  return result;
+}
+
+
+bool pinToCpu(int cpu)
+{
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+  if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0)
+  {
+    ROS_ERROR("Cannot pin the benchmark to cpu %d: %s", cpu, std::strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+
+double percentile(const std::vector<double>& sorted, double p)
+{
+  if (sorted.empty())
+    return 0;
+  std::size_t rank = static_cast<std::size_t>(std::ceil(p / 100. * sorted.size()));
+  return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+
+double mean(const std::vector<double>& values)
+{
+  double sum = 0;
+  for (double value : values)
+    sum += value;
+  return values.empty() ? 0 : sum / values.size();
+}
+
+
+void printResultHeader(int name_width)
+{
+  std::printf("%-*s %8s %8s %9s %9s %9s %9s %9s %9s %9s %9s\n", name_width, "", "cycles", "failed", "p50[ms]", "p95[ms]",
+              "p99[ms]", "max[ms]", "iter_avg", "iter_p50", "iter_p95", "iter_max");
+}
+
+
+void printResult(const BenchmarkResult& result, int name_width)
+{
+  std::vector<double> latencies = result.latencies;
+  std::vector<double> iterations = result.iterations;
+  std::sort(latencies.begin(), latencies.end());
+  std::sort(iterations.begin(), iterations.end());
+
+  std::printf("%-*s %8zu %8d %9.3f %9.3f %9.3f %9.3f %9.1f %9.0f %9.0f %9.0f\n", name_width, result.name.c_str(),
+              latencies.size(), result.failures, 1e3 * percentile(latencies, 50), 1e3 * percentile(latencies, 95),
+              1e3 * percentile(latencies, 99), latencies.empty() ? 0. : 1e3 * latencies.back(), mean(iterations),
+              percentile(iterations, 50), percentile(iterations, 95), iterations.empty() ? 0. : iterations.back());
+}
+
+
+bool writeResultsJson(const std::string& filename, const std::string& source, const std::vector<BenchmarkResult>& results)
+{
+  FILE* file = std::fopen(filename.c_str(), "w");
+  if (!file)
+  {
+    ROS_ERROR("Cannot write '%s'.", filename.c_str());
+    return false;
+  }
+
+  std::fprintf(file, "{\n  \"source\": \"%s\",\n  \"benchmarks\": {", escapeJson(source).c_str());
+  for (std::size_t i = 0; i < results.size(); ++i)
+  {
+    std::vector<double> latencies = results[i].latencies;
+    std::vector<double> iterations = results[i].iterations;
+    std::sort(latencies.begin(), latencies.end());
+    std::sort(iterations.begin(), iterations.end());
+
+    std::fprintf(file, "%s\n    \"%s\": {\n", i > 0 ? "," : "", escapeJson(results[i].name).c_str());
+    std::fprintf(file, "      \"cycles\": %zu,\n      \"failures\": %d,\n", latencies.size(), results[i].failures);
+    std::fprintf(file, "      \"latency_ms\": {\"mean\": %.6f, \"p50\": %.6f, \"p95\": %.6f, \"p99\": %.6f, \"max\": %.6f},\n",
+                 1e3 * mean(latencies), 1e3 * percentile(latencies, 50), 1e3 * percentile(latencies, 95),
+                 1e3 * percentile(latencies, 99), latencies.empty() ? 0. : 1e3 * latencies.back());
+    std::fprintf(file, "      \"iterations\": {\"mean\": %.3f, \"p50\": %.0f, \"p95\": %.0f, \"p99\": %.0f, \"max\": %.0f}\n    }",
+                 mean(iterations), percentile(iterations, 50), percentile(iterations, 95), percentile(iterations, 99),
+                 iterations.empty() ? 0. : iterations.back());
+  }
+  std::fprintf(file, "\n  }\n}\n");
+  std::fclose(file);
+  return true;
+}
+
+} // namespace teb_local_planner
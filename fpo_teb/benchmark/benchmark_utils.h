@@ -0,0 +1,152 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#ifndef BENCHMARK_UTILS_H_
+#define BENCHMARK_UTILS_H_
+
+#include <teb_local_planner/planning_record.h>
+#include <teb_local_planner/planner_interface.h>
+
+#include <nav_msgs/OccupancyGrid.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace teb_local_planner
+{
+
+//! Measurements of a single benchmark, e.g. a planner replaying a log
+struct BenchmarkResult
+{
+  std::string name; //!< Unique name of the benchmark, used as key in the json output
+  std::vector<double> latencies; //!< Duration of each measured plan() call [s]
+  std::vector<double> iterations; //!< Solver iterations of each measured plan() call
+  std::vector<double> poses; //!< Number of poses of the selected trajectory after each measured plan() call
+  int failures = 0; //!< Number of plan() calls that returned false
+};
+
+//! Consecutive planning cycles along with the config, footprint and global costmap in effect during these cycles
+struct PlanningSegment
+{
+  std::vector<std::uint8_t> config; //!< Encoded config of the planner (see encodeConfig()), empty for the default config
+  RobotFootprintModelPtr robot_model; //!< Footprint model of the robot
+  boost::shared_ptr<const nav_msgs::OccupancyGrid> costmap; //!< Global costmap passed to the planner (null if none)
+  std::vector<PlanningCycleInput> cycles; //!< Inputs of the planning cycles
+};
+
+/**
+ * @brief Create the planner \c planner_type ("teb" or "hcp") operating on the given containers
+ * @param planner_type "teb" for TebOptimalPlanner, "hcp" for HomotopyClassPlanner
+ * @param cfg Config of the planner, must outlive the planner
+ * @param obstacles Obstacle container, must outlive the planner
+ * @param robot_model Footprint model of the robot
+ * @param via_points Via-point container, must outlive the planner
+ * @return the planner, an empty pointer if \c planner_type is unknown
+ */
+PlannerInterfacePtr createPlanner(const std::string& planner_type, const TebConfig& cfg, ObstContainer* obstacles,
+                                  RobotFootprintModelPtr robot_model, ViaPointContainer* via_points);
+
+/**
+ * @brief Run the planner on a sequence of planning cycles and measure each plan() call
+ *
+ * Each repetition clears the planner and runs the complete sequence, hence the first cycle
+ * is always planned without a warm start. The first \c warmup repetitions are not measured.
+ * @param name Name of the result
+ * @param planner_type "teb" or "hcp", see createPlanner()
+ * @param cfg Config of the planner
+ * @param robot_model Footprint model of the robot
+ * @param costmap Global costmap passed to the planner, ignored if null
+ * @param cycles Inputs of the planning cycles
+ * @param warmup Number of repetitions that are not measured
+ * @param repetitions Number of measured repetitions
+ */
+BenchmarkResult runPlanningCycles(const std::string& name, const std::string& planner_type, const TebConfig& cfg,
+                                  RobotFootprintModelPtr robot_model, const nav_msgs::OccupancyGrid* costmap,
+                                  const std::vector<PlanningCycleInput>& cycles, int warmup, int repetitions);
+
+/**
+ * @brief Run the planner on a sequence of planning segments and measure each plan() call
+ *
+ * Like the node does on reconfiguration, config, footprint and global costmap of the planner are updated
+ * at the beginning of each segment (outside of the measurements) without resetting the planner.
+ * Each repetition clears the planner and runs all segments.
+ * @param name Name of the result
+ * @param planner_type "teb" or "hcp", see createPlanner()
+ * @param segments Planning segments in chronological order (must not be empty)
+ * @param warmup Number of repetitions that are not measured
+ * @param repetitions Number of measured repetitions
+ */
+BenchmarkResult runPlanningCycles(const std::string& name, const std::string& planner_type,
+                                  const std::vector<PlanningSegment>& segments, int warmup, int repetitions);
+
+/**
+ * @brief Pin the calling thread to a single CPU to reduce the variance of the measurements
+ *
+ * Threads created afterwards (e.g. by the HomotopyClassPlanner) inherit the affinity.
+ * @param cpu Index of the CPU
+ * @return false if the affinity cannot be set
+ */
+bool pinToCpu(int cpu);
+
+//! Nearest-rank percentile of a sorted sequence
+double percentile(const std::vector<double>& sorted, double p);
+
+//! Arithmetic mean, zero for an empty sequence
+double mean(const std::vector<double>& values);
+
+//! Print the column titles of printResult() to stdout
+void printResultHeader(int name_width);
+
+//! Print cycles, failures, latency percentiles [ms] and iteration statistics of \c result to stdout
+void printResult(const BenchmarkResult& result, int name_width);
+
+/**
+ * @brief Write the statistics of all results to a json file
+ *
+ * The file contains an object with the given \c source and an object \c benchmarks that maps
+ * the name of each result to its cycles, failures, latency [ms] and iteration statistics.
+ * @return false if the file cannot be written
+ */
+bool writeResultsJson(const std::string& filename, const std::string& source, const std::vector<BenchmarkResult>& results);
+
+} // namespace teb_local_planner
+
+#endif /* BENCHMARK_UTILS_H_ */
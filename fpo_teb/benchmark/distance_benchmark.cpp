@@ -0,0 +1,390 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+/*
+ * Micro benchmarks of the distance calculations (distance_calculations.h) and of
+ * BaseRobotFootprintModel::calculateDistance() for every combination of footprint model and
+ * obstacle type. These are the innermost loops of the obstacle association and of the
+ * evaluation of the obstacle edges. The batched variants (suffix batch64) evaluate 64 query
+ * points or poses per iteration. The footprintCost benchmarks measure the costmap check of a
+ * single pose in TebOptimalPlanner::isTrajectoryFeasible() (base_local_planner::CostmapModel
+ * compared to FootprintCostmapModel).
+ *
+ * Usage: distance_benchmark [--filter SUBSTRING] [--min-time SECONDS] [--repetitions N] [--cpu N] [--json FILE] [--list]
+ */
+
+#include "micro_benchmark.h"
+
+#include <teb_local_planner/distance_calculations.h>
+#include <teb_local_planner/robot_footprint_model.h>
+#include <teb_local_planner/obstacles.h>
+#include <teb_local_planner/footprint_costmap_model.h>
+
+#include <costmap_2d/costmap_2d.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+
+using namespace teb_local_planner;
+
+namespace
+{
+
+//! Number of precomputed inputs, the benchmarks cycle through them to avoid measuring a single branch pattern
+const std::size_t num_samples = 64;
+
+const std::vector<long> polygon_sizes = {3, 4, 8, 16, 32, 64};
+
+//! Footprint of a robot towing a cart (2 m x 0.6 m)
+Point2dContainer makeCart()
+{
+  Point2dContainer vertices;
+  vertices.push_back(Eigen::Vector2d(-1.6, -0.3));
+  vertices.push_back(Eigen::Vector2d(0.4, -0.3));
+  vertices.push_back(Eigen::Vector2d(0.4, 0.3));
+  vertices.push_back(Eigen::Vector2d(-1.6, 0.3));
+  return vertices;
+}
+
+//! Convex polygon with \c num_vertices vertices on a circle around \c center
+Point2dContainer makePolygon(long num_vertices, const Eigen::Vector2d& center, double radius, double rotation = 0.)
+{
+  Point2dContainer vertices;
+  for (long i = 0; i < num_vertices; ++i)
+  {
+    double angle = rotation + 2. * M_PI * i / num_vertices;
+    vertices.push_back(center + radius * Eigen::Vector2d(std::cos(angle), std::sin(angle)));
+  }
+  return vertices;
+}
+
+//! Points uniformly distributed within a square of half size \c extent around the origin
+Point2dContainer samplePoints(double extent, unsigned int seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> uniform(-extent, extent);
+  Point2dContainer points;
+  for (std::size_t i = 0; i < num_samples; ++i)
+    points.push_back(Eigen::Vector2d(uniform(rng), uniform(rng)));
+  return points;
+}
+
+//! Poses uniformly distributed within a square of half size \c extent around the origin
+std::vector<PoseSE2, Eigen::aligned_allocator<PoseSE2> > samplePoses(double extent, unsigned int seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> uniform(-extent, extent);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  std::vector<PoseSE2, Eigen::aligned_allocator<PoseSE2> > poses;
+  for (std::size_t i = 0; i < num_samples; ++i)
+    poses.push_back(PoseSE2(uniform(rng), uniform(rng), angle(rng)));
+  return poses;
+}
+
+//! Split points into arrays of x- and y-coordinates
+void toArrays(const Point2dContainer& points, Eigen::ArrayXd& x, Eigen::ArrayXd& y)
+{
+  x.resize(points.size());
+  y.resize(points.size());
+  for (std::size_t i = 0; i < points.size(); ++i)
+  {
+    x[i] = points[i].x();
+    y[i] = points[i].y();
+  }
+}
+
+void registerDistanceCalculations()
+{
+  for (long size : polygon_sizes)
+  {
+    registerMicroBenchmark("distance_point_to_polygon_2d", [](MicroBenchmarkState& state)
+    {
+      Point2dContainer polygon = makePolygon(state.argument(), Eigen::Vector2d::Zero(), 1.);
+      Point2dContainer points = samplePoints(2., 1);
+      while (state.keepRunning())
+        doNotOptimize(distance_point_to_polygon_2d(points[state.index() % num_samples], polygon));
+    }, size);
+
+    registerMicroBenchmark("distance_points_to_polygon_2d_batch64", [](MicroBenchmarkState& state)
+    {
+      Point2dContainer polygon = makePolygon(state.argument(), Eigen::Vector2d::Zero(), 1.);
+      PolygonEdgeArrays edges(polygon);
+      Eigen::ArrayXd points_x, points_y;
+      toArrays(samplePoints(2., 1), points_x, points_y);
+      Eigen::ArrayXd distances(num_samples);
+      while (state.keepRunning())
+      {
+        distance_points_to_polygon_2d(points_x, points_y, edges, distances);
+        doNotOptimize(distances.data());
+      }
+    }, size);
+
+    registerMicroBenchmark("distance_segment_to_polygon_2d", [](MicroBenchmarkState& state)
+    {
+      Point2dContainer polygon = makePolygon(state.argument(), Eigen::Vector2d::Zero(), 1.);
+      Point2dContainer starts = samplePoints(2., 1);
+      Point2dContainer ends = samplePoints(2., 2);
+      while (state.keepRunning())
+      {
+        std::size_t i = state.index() % num_samples;
+        doNotOptimize(distance_segment_to_polygon_2d(starts[i], ends[i], polygon));
+      }
+    }, size);
+
+    registerMicroBenchmark("distance_polygon_to_polygon_2d", [](MicroBenchmarkState& state)
+    {
+      Point2dContainer polygon = makePolygon(state.argument(), Eigen::Vector2d::Zero(), 1.);
+      Point2dContainer centers = samplePoints(3., 1);
+      std::vector<Point2dContainer> others;
+      for (const Eigen::Vector2d& center : centers)
+        others.push_back(makePolygon(state.argument(), center, 0.5, center.x()));
+      while (state.keepRunning())
+        doNotOptimize(distance_polygon_to_polygon_2d(polygon, others[state.index() % num_samples]));
+    }, size);
+
+    registerMicroBenchmark("distance_convex_polygons_2d", [](MicroBenchmarkState& state)
+    {
+      Point2dContainer polygon = makePolygon(state.argument(), Eigen::Vector2d::Zero(), 1.);
+      Point2dContainer centers = samplePoints(3., 1);
+      std::vector<Point2dContainer> others;
+      for (const Eigen::Vector2d& center : centers)
+        others.push_back(makePolygon(state.argument(), center, 0.5, center.x()));
+      while (state.keepRunning())
+        doNotOptimize(distance_convex_polygons_2d(polygon, others[state.index() % num_samples]));
+    }, size);
+  }
+
+  registerMicroBenchmark("check_line_segments_intersection_2d", [](MicroBenchmarkState& state)
+  {
+    Point2dContainer starts1 = samplePoints(1., 1), ends1 = samplePoints(1., 2);
+    Point2dContainer starts2 = samplePoints(1., 3), ends2 = samplePoints(1., 4);
+    while (state.keepRunning())
+    {
+      std::size_t i = state.index() % num_samples;
+      doNotOptimize(check_line_segments_intersection_2d(starts1[i], ends1[i], starts2[i], ends2[i]));
+    }
+  });
+
+  registerMicroBenchmark("distance_segment_to_segment_2d", [](MicroBenchmarkState& state)
+  {
+    Point2dContainer starts1 = samplePoints(1., 1), ends1 = samplePoints(1., 2);
+    Point2dContainer starts2 = samplePoints(1., 3), ends2 = samplePoints(1., 4);
+    while (state.keepRunning())
+    {
+      std::size_t i = state.index() % num_samples;
+      doNotOptimize(distance_segment_to_segment_2d(starts1[i], ends1[i], starts2[i], ends2[i]));
+    }
+  });
+
+  registerMicroBenchmark("calc_distance_segment_to_segment3D", [](MicroBenchmarkState& state)
+  {
+    // the third coordinate is the time, as used for the spatio-temporal distance to dynamic obstacles
+    Point2dContainer starts1 = samplePoints(1., 1), ends1 = samplePoints(1., 2);
+    Point2dContainer starts2 = samplePoints(1., 3), ends2 = samplePoints(1., 4);
+    std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> > segments;
+    for (std::size_t i = 0; i < num_samples; ++i)
+    {
+      segments.push_back(Eigen::Vector3d(starts1[i].x(), starts1[i].y(), 0.));
+      segments.push_back(Eigen::Vector3d(ends1[i].x(), ends1[i].y(), 1.));
+      segments.push_back(Eigen::Vector3d(starts2[i].x(), starts2[i].y(), 0.));
+      segments.push_back(Eigen::Vector3d(ends2[i].x(), ends2[i].y(), 1.));
+    }
+    while (state.keepRunning())
+    {
+      std::size_t i = 4 * (state.index() % num_samples);
+      Eigen::Ref<const Eigen::Vector3d> line1_end(segments[i + 1]);
+      Eigen::Ref<const Eigen::Vector3d> line2_end(segments[i + 3]);
+      doNotOptimize(calc_distance_segment_to_segment3D(segments[i], line1_end, segments[i + 2], line2_end));
+    }
+  });
+}
+
+//! Named factory of a footprint model or an obstacle
+template <typename T>
+struct NamedFactory
+{
+  std::string name;
+  std::function<T()> create;
+};
+
+void registerFootprintDistances()
+{
+  std::vector<NamedFactory<RobotFootprintModelPtr> > footprints = {
+    {"point", [] {return RobotFootprintModelPtr(new PointRobotFootprint());}},
+    {"circular", [] {return RobotFootprintModelPtr(new CircularRobotFootprint(0.3));}},
+    {"two_circles", [] {return RobotFootprintModelPtr(new TwoCirclesRobotFootprint(0.2, 0.25, 0.2, 0.25));}},
+    {"line", [] {return RobotFootprintModelPtr(new LineRobotFootprint(Eigen::Vector2d(-0.3, 0.), Eigen::Vector2d(0.3, 0.), 0.));}},
+    {"polygon4", [] {return RobotFootprintModelPtr(new PolygonRobotFootprint(makePolygon(4, Eigen::Vector2d::Zero(), 0.4, M_PI / 4.)));}},
+    {"polygon8", [] {return RobotFootprintModelPtr(new PolygonRobotFootprint(makePolygon(8, Eigen::Vector2d::Zero(), 0.4)));}},
+    {"polygon12", [] {return RobotFootprintModelPtr(new PolygonRobotFootprint(makePolygon(12, Eigen::Vector2d::Zero(), 0.4)));}},
+    {"polygon12_field", []
+    {
+      boost::shared_ptr<PolygonRobotFootprint> robot_model(new PolygonRobotFootprint(makePolygon(12, Eigen::Vector2d::Zero(), 0.4)));
+      robot_model->setDistanceField(0.02, 2.);
+      return robot_model;
+    }},
+    {"cart_polygon", [] {return RobotFootprintModelPtr(new PolygonRobotFootprint(makeCart()));}},
+    {"cart_circles", [] {return RobotFootprintModelPtr(MultiCircleRobotFootprint::approximatePolygon(makeCart(), 0.05));}}
+  };
+
+  std::vector<NamedFactory<ObstaclePtr> > obstacles = {
+    {"point", [] {return ObstaclePtr(new PointObstacle(0., 0.));}},
+    {"circular", [] {return ObstaclePtr(new CircularObstacle(0., 0., 0.3));}},
+    {"line", [] {return ObstaclePtr(new LineObstacle(Eigen::Vector2d(-0.5, 0.), Eigen::Vector2d(0.5, 0.)));}},
+    {"pill", [] {return ObstaclePtr(new PillObstacle(Eigen::Vector2d(-0.5, 0.), Eigen::Vector2d(0.5, 0.), 0.2));}}
+  };
+  for (long size : polygon_sizes)
+  {
+    obstacles.push_back({"polygon" + std::to_string(size), [size]
+    {
+      return ObstaclePtr(new PolygonObstacle(makePolygon(size, Eigen::Vector2d::Zero(), 0.5)));
+    }});
+  }
+
+  for (const NamedFactory<RobotFootprintModelPtr>& footprint : footprints)
+  {
+    for (const NamedFactory<ObstaclePtr>& obstacle : obstacles)
+    {
+      std::function<RobotFootprintModelPtr()> create_footprint = footprint.create;
+      std::function<ObstaclePtr()> create_obstacle = obstacle.create;
+      registerMicroBenchmark("calculateDistance/" + footprint.name + "/" + obstacle.name,
+                             [create_footprint, create_obstacle](MicroBenchmarkState& state)
+      {
+        RobotFootprintModelPtr robot_model = create_footprint();
+        ObstaclePtr obst = create_obstacle();
+        std::vector<PoseSE2, Eigen::aligned_allocator<PoseSE2> > poses = samplePoses(2., 1);
+        while (state.keepRunning())
+          doNotOptimize(robot_model->calculateDistance(poses[state.index() % num_samples], obst.get()));
+      });
+
+      registerMicroBenchmark("calculateDistances_batch64/" + footprint.name + "/" + obstacle.name,
+                             [create_footprint, create_obstacle](MicroBenchmarkState& state)
+      {
+        RobotFootprintModelPtr robot_model = create_footprint();
+        ObstaclePtr obst = create_obstacle();
+        std::vector<PoseSE2, Eigen::aligned_allocator<PoseSE2> > poses = samplePoses(2., 1);
+        Eigen::ArrayXd poses_x(num_samples), poses_y(num_samples), poses_theta(num_samples), distances(num_samples);
+        for (std::size_t i = 0; i < num_samples; ++i)
+        {
+          poses_x[i] = poses[i].x();
+          poses_y[i] = poses[i].y();
+          poses_theta[i] = poses[i].theta();
+        }
+        while (state.keepRunning())
+        {
+          robot_model->calculateDistances(poses_x, poses_y, poses_theta, obst.get(), distances);
+          doNotOptimize(distances.data());
+        }
+      });
+    }
+  }
+}
+
+//! Convert a footprint to the representation of the navigation stack
+std::vector<geometry_msgs::Point> toFootprintSpec(const Point2dContainer& vertices)
+{
+  std::vector<geometry_msgs::Point> footprint_spec(vertices.size());
+  for (std::size_t i = 0; i < vertices.size(); ++i)
+  {
+    footprint_spec[i].x = vertices[i].x();
+    footprint_spec[i].y = vertices[i].y();
+  }
+  return footprint_spec;
+}
+
+//! Footprints of the costmap checks
+std::vector<NamedFactory<std::vector<geometry_msgs::Point> > > makeFootprintSpecs()
+{
+  return {
+    {"polygon4", [] {return toFootprintSpec(makePolygon(4, Eigen::Vector2d::Zero(), 0.4, M_PI / 4.));}},
+    {"polygon12", [] {return toFootprintSpec(makePolygon(12, Eigen::Vector2d::Zero(), 0.4));}},
+    {"cart", [] {return toFootprintSpec(makeCart());}}
+  };
+}
+
+void registerFootprintCosts()
+{
+  for (const NamedFactory<std::vector<geometry_msgs::Point> >& footprint : makeFootprintSpecs())
+  {
+    std::function<std::vector<geometry_msgs::Point>()> create_footprint = footprint.create;
+    // 0: base_local_planner::CostmapModel, otherwise FootprintCostmapModel with the given number of heading bins
+    for (long num_headings : {0L, 72L, 360L})
+    {
+      std::string model_name = num_headings > 0 ? "footprint_costmap_model" + std::to_string(num_headings) : "costmap_model";
+      registerMicroBenchmark("footprintCost/" + model_name + "/" + footprint.name, [create_footprint](MicroBenchmarkState& state)
+      {
+        // free 10 m x 10 m costmap (5 cm resolution), hence every outline cell is visited
+        costmap_2d::Costmap2D costmap(200, 200, 0.05, -5., -5., 0);
+        boost::shared_ptr<base_local_planner::CostmapModel> costmap_model;
+        if (state.argument() > 0)
+          costmap_model.reset(new FootprintCostmapModel(costmap, state.argument()));
+        else
+          costmap_model.reset(new base_local_planner::CostmapModel(costmap));
+        FootprintCostmapModel* cached_model = dynamic_cast<FootprintCostmapModel*>(costmap_model.get());
+        std::vector<geometry_msgs::Point> footprint_spec = create_footprint();
+        std::vector<PoseSE2, Eigen::aligned_allocator<PoseSE2> > poses = samplePoses(2., 1);
+        if (cached_model) // build the cache outside of the measurement
+          cached_model->setFootprint(footprint_spec);
+        while (state.keepRunning())
+        {
+          const PoseSE2& pose = poses[state.index() % num_samples];
+          if (cached_model)
+            doNotOptimize(cached_model->cachedFootprintCost(pose.x(), pose.y(), pose.theta(), footprint_spec));
+          else
+            doNotOptimize(costmap_model->footprintCost(pose.x(), pose.y(), pose.theta(), footprint_spec));
+        }
+      }, num_headings);
+    }
+  }
+}
+
+} // anonymous namespace
+
+
+int main(int argc, char** argv)
+{
+  registerDistanceCalculations();
+  registerFootprintDistances();
+  registerFootprintCosts();
+  return runMicroBenchmarks(argc, argv);
+}
@@ -0,0 +1,212 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#include "micro_benchmark.h"
+#include "benchmark_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+
+namespace teb_local_planner
+{
+
+namespace
+{
+
+struct MicroBenchmark
+{
+  std::string name;
+  MicroBenchmarkFunction function;
+  long argument;
+};
+
+//! Measurements of a micro benchmark
+struct MicroBenchmarkResult
+{
+  std::string name;
+  std::size_t iterations; //!< Iterations per repetition
+  std::vector<double> times; //!< Time per iteration of each repetition [ns], sorted
+};
+
+std::vector<MicroBenchmark>& registry()
+{
+  static std::vector<MicroBenchmark> benchmarks;
+  return benchmarks;
+}
+
+double runOnce(const MicroBenchmark& benchmark, std::size_t iterations)
+{
+  MicroBenchmarkState state(iterations, benchmark.argument);
+  benchmark.function(state);
+  return state.elapsed();
+}
+
+MicroBenchmarkResult run(const MicroBenchmark& benchmark, double min_time, int repetitions)
+{
+  // increase the number of iterations until a single run takes at least min_time
+  std::size_t iterations = 1;
+  for (;;)
+  {
+    double elapsed = runOnce(benchmark, iterations);
+    if (elapsed >= min_time || iterations >= 1000000000)
+      break;
+    double scale = elapsed > 1e-9 ? 1.2 * min_time / elapsed : 10.;
+    iterations = std::min<std::size_t>(1000000000, static_cast<std::size_t>(std::ceil(iterations * std::min(10., std::max(1.5, scale)))));
+  }
+
+  MicroBenchmarkResult result;
+  result.name = benchmark.name;
+  result.iterations = iterations;
+  for (int repetition = 0; repetition < repetitions; ++repetition)
+    result.times.push_back(1e9 * runOnce(benchmark, iterations) / iterations);
+  std::sort(result.times.begin(), result.times.end());
+  return result;
+}
+
+bool writeJson(const std::string& filename, const std::string& source, const std::vector<MicroBenchmarkResult>& results)
+{
+  FILE* file = std::fopen(filename.c_str(), "w");
+  if (!file)
+  {
+    ROS_ERROR("Cannot write '%s'.", filename.c_str());
+    return false;
+  }
+
+  std::fprintf(file, "{\n  \"source\": \"%s\",\n  \"benchmarks\": {", source.c_str());
+  for (std::size_t i = 0; i < results.size(); ++i)
+  {
+    const std::vector<double>& times = results[i].times;
+    std::fprintf(file, "%s\n    \"%s\": {\n", i > 0 ? "," : "", results[i].name.c_str());
+    std::fprintf(file, "      \"iterations\": %zu,\n      \"repetitions\": %zu,\n", results[i].iterations, times.size());
+    std::fprintf(file, "      \"time_ns\": {\"mean\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f}\n    }",
+                 mean(times), percentile(times, 50), percentile(times, 95), percentile(times, 99),
+                 times.empty() ? 0. : times.back());
+  }
+  std::fprintf(file, "\n  }\n}\n");
+  std::fclose(file);
+  return true;
+}
+
+void printUsage(const char* program)
+{
+  std::printf("Usage: %s [--filter SUBSTRING] [--min-time SECONDS] [--repetitions N] [--cpu N] [--json FILE] [--list]\n", program);
+}
+
+} // anonymous namespace
+
+
+void registerMicroBenchmark(const std::string& name, const MicroBenchmarkFunction& function, long argument)
+{
+  MicroBenchmark benchmark;
+  benchmark.name = argument >= 0 ? name + "/" + std::to_string(argument) : name;
+  benchmark.function = function;
+  benchmark.argument = argument;
+  registry().push_back(benchmark);
+}
+
+
+int runMicroBenchmarks(int argc, char** argv)
+{
+  std::string filter;
+  std::string json_filename;
+  double min_time = 0.05;
+  int repetitions = 10;
+  int cpu = -1;
+  bool list = false;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--filter" && i + 1 < argc)
+      filter = argv[++i];
+    else if (arg == "--min-time" && i + 1 < argc)
+      min_time = std::max(1e-4, std::atof(argv[++i]));
+    else if (arg == "--repetitions" && i + 1 < argc)
+      repetitions = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--cpu" && i + 1 < argc)
+      cpu = std::atoi(argv[++i]);
+    else if (arg == "--json" && i + 1 < argc)
+      json_filename = argv[++i];
+    else if (arg == "--list")
+      list = true;
+    else
+    {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (cpu >= 0 && !pinToCpu(cpu))
+    return EXIT_FAILURE;
+
+  std::size_t name_width = 10;
+  for (const MicroBenchmark& benchmark : registry())
+    name_width = std::max(name_width, benchmark.name.size());
+
+  if (!list)
+    std::printf("%-*s %12s %10s %10s %10s %10s\n", static_cast<int>(name_width), "benchmark", "iterations", "mean[ns]",
+                "p50[ns]", "min[ns]", "max[ns]");
+
+  std::vector<MicroBenchmarkResult> results;
+  for (const MicroBenchmark& benchmark : registry())
+  {
+    if (!filter.empty() && benchmark.name.find(filter) == std::string::npos)
+      continue;
+    if (list)
+    {
+      std::printf("%s\n", benchmark.name.c_str());
+      continue;
+    }
+
+    MicroBenchmarkResult result = run(benchmark, min_time, repetitions);
+    std::printf("%-*s %12zu %10.2f %10.2f %10.2f %10.2f\n", static_cast<int>(name_width), result.name.c_str(),
+                result.iterations, mean(result.times), percentile(result.times, 50), result.times.front(),
+                result.times.back());
+    std::fflush(stdout);
+    results.push_back(result);
+  }
+
+  if (!json_filename.empty() && !writeJson(json_filename, argv[0], results))
+    return EXIT_FAILURE;
+  return EXIT_SUCCESS;
+}
+
+} // namespace teb_local_planner
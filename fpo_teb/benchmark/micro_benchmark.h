@@ -0,0 +1,132 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#ifndef MICRO_BENCHMARK_H_
+#define MICRO_BENCHMARK_H_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+
+
+namespace teb_local_planner
+{
+
+/**
+ * @class MicroBenchmarkState
+ * @brief Controls the timed loop of a micro benchmark
+ *
+ * The benchmark function performs its setup, then runs the code under test in
+ * @code
+ * while (state.keepRunning())
+ *   doNotOptimize(function_under_test(...));
+ * @endcode
+ * Only the loop is timed.
+ */
+class MicroBenchmarkState
+{
+public:
+  MicroBenchmarkState(std::size_t iterations, long argument) : iterations_(iterations), argument_(argument) {}
+
+  //! Returns true as long as the loop has to be continued, starts and stops the timer
+  bool keepRunning()
+  {
+    if (count_ == 0)
+      start_ = std::chrono::steady_clock::now();
+    if (count_ < iterations_)
+    {
+      ++count_;
+      return true;
+    }
+    stop_ = std::chrono::steady_clock::now();
+    return false;
+  }
+
+  //! Index of the current iteration, e.g. for cycling through a set of inputs
+  std::size_t index() const {return count_ - 1;}
+
+  //! Argument the benchmark has been registered with, e.g. the number of polygon vertices
+  long argument() const {return argument_;}
+
+  //! Number of iterations of the timed loop
+  std::size_t iterations() const {return iterations_;}
+
+  //! Duration of the timed loop [s]
+  double elapsed() const {return std::chrono::duration<double>(stop_ - start_).count();}
+
+private:
+  std::size_t iterations_;
+  long argument_;
+  std::size_t count_ = 0;
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::time_point stop_;
+};
+
+//! Function of a micro benchmark, see MicroBenchmarkState
+typedef std::function<void(MicroBenchmarkState&)> MicroBenchmarkFunction;
+
+/**
+ * @brief Prevent the compiler from optimizing away the computation of \c value
+ */
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief Register a micro benchmark
+ * @param name Name of the benchmark, the argument is appended as "/argument" if it is not negative
+ * @param function Benchmark function
+ * @param argument Argument passed to the function via MicroBenchmarkState::argument()
+ */
+void registerMicroBenchmark(const std::string& name, const MicroBenchmarkFunction& function, long argument = -1);
+
+/**
+ * @brief Run all registered micro benchmarks and print the time per iteration
+ *
+ * The number of iterations of each benchmark is calibrated such that a repetition takes at least
+ * the minimum time. Statistics are computed over the time per iteration of all repetitions.
+ * Command line options: [--filter SUBSTRING] [--min-time SECONDS] [--repetitions N] [--cpu N] [--json FILE] [--list]
+ * @return exit code of the benchmark executable
+ */
+int runMicroBenchmarks(int argc, char** argv);
+
+} // namespace teb_local_planner
+
+#endif /* MICRO_BENCHMARK_H_ */
@@ -0,0 +1,219 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+/*
+ * Replays a planning log (see planning_record.h) with TebOptimalPlanner and/or HomotopyClassPlanner
+ * and reports the latency and the number of solver iterations of the plan() calls.
+ * Neither a ROS master nor a costmap is required, hence results of different releases or
+ * configurations can be compared on identical inputs. Config, footprint and global costmap records
+ * take effect at the cycle following them, as during recording.
+ *
+ * Usage: replay_benchmark <log> [--planner teb|hcp|both] [--repetitions N] [--warmup N] [--cpu N] [--json FILE]
+ */
+
+#include "benchmark_utils.h"
+
+#include <ros/time.h>
+
+#include <boost/make_shared.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+
+using namespace teb_local_planner;
+
+namespace
+{
+
+//! Content of a planning log
+struct ReplayLog
+{
+  std::vector<PlanningSegment> segments; //!< Cycles grouped by the config, footprint and costmap in effect
+  std::size_t num_cycles = 0; //!< Total number of cycles
+};
+
+bool loadLog(const std::string& filename, ReplayLog& log)
+{
+  PlanningRecordReader reader;
+  if (!reader.open(filename))
+    return false;
+
+  // config, footprint and costmap in effect, records apply to all subsequent cycles (in stream order)
+  PlanningSegment current;
+  std::uint64_t config_hash = 0;
+  bool changed = true;
+  std::size_t hash_mismatches = 0;
+
+  PlanningRecordView record;
+  while (reader.next(record))
+  {
+    switch (record.type)
+    {
+      case PlanningRecordType::Config:
+      {
+        // the config is stored encoded, since TebConfig cannot be copied, but rejected early if corrupted
+        TebConfig cfg;
+        if (!decodeConfig(record.data, record.size, cfg))
+          return false;
+        current.config.assign(record.data, record.data + record.size);
+        config_hash = computeConfigHash(record.data, record.size);
+        changed = true;
+        break;
+      }
+      case PlanningRecordType::Footprint:
+        current.robot_model = decodeFootprint(record.data, record.size);
+        if (!current.robot_model)
+          return false;
+        changed = true;
+        break;
+      case PlanningRecordType::GlobalCostmap:
+      {
+        boost::shared_ptr<nav_msgs::OccupancyGrid> costmap = boost::make_shared<nav_msgs::OccupancyGrid>();
+        if (!decodeGlobalCostmap(record.data, record.size, *costmap))
+          return false;
+        current.costmap = costmap;
+        changed = true;
+        break;
+      }
+      case PlanningRecordType::CycleInput:
+        if (changed)
+        {
+          if (!current.robot_model)
+          {
+            ROS_WARN("The log does not contain a footprint model before cycle %zu, using a point robot.", log.num_cycles);
+            current.robot_model = RobotFootprintModelPtr(new PointRobotFootprint());
+          }
+          log.segments.push_back(current);
+          changed = false;
+        }
+        log.segments.back().cycles.emplace_back();
+        if (!decodeCycleInput(record.data, record.size, log.segments.back().cycles.back()))
+          return false;
+        if (log.segments.back().cycles.back().config_hash != config_hash)
+          ++hash_mismatches;
+        ++log.num_cycles;
+        break;
+      default:
+        break; // records not required for replaying
+    }
+  }
+
+  if (hash_mismatches > 0)
+    ROS_WARN("%zu of %zu cycles were planned with a config that has not been recorded before them (e.g. dropped records). "
+             "These cycles are replayed with the most recent config in the log and might not be reproduced.", hash_mismatches, log.num_cycles);
+  return true;
+}
+
+void printUsage(const char* program)
+{
+  std::printf("Usage: %s <log> [--planner teb|hcp|both] [--repetitions N] [--warmup N] [--cpu N] [--json FILE]\n", program);
+}
+
+} // anonymous namespace
+
+
+int main(int argc, char** argv)
+{
+  std::string log_filename;
+  std::string planner = "both";
+  std::string json_filename;
+  int repetitions = 10;
+  int warmup = 1;
+  int cpu = -1;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--planner" && i + 1 < argc)
+      planner = argv[++i];
+    else if (arg == "--repetitions" && i + 1 < argc)
+      repetitions = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--warmup" && i + 1 < argc)
+      warmup = std::max(0, std::atoi(argv[++i]));
+    else if (arg == "--cpu" && i + 1 < argc)
+      cpu = std::atoi(argv[++i]);
+    else if (arg == "--json" && i + 1 < argc)
+      json_filename = argv[++i];
+    else if (arg[0] != '-' && log_filename.empty())
+      log_filename = arg;
+    else
+    {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (log_filename.empty() || (planner != "teb" && planner != "hcp" && planner != "both"))
+  {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (cpu >= 0 && !pinToCpu(cpu))
+    return EXIT_FAILURE;
+
+  // the planners query ros::Time::now(), which works without ros::init() after initializing the wall clock
+  ros::Time::init();
+
+  ReplayLog log;
+  if (!loadLog(log_filename, log))
+    return EXIT_FAILURE;
+  if (log.num_cycles == 0)
+  {
+    ROS_ERROR("The log '%s' does not contain any planning cycle.", log_filename.c_str());
+    return EXIT_FAILURE;
+  }
+  std::printf("Replaying %zu cycles (%zu config/footprint/costmap changes), %d warmup and %d measured repetitions\n\n",
+              log.num_cycles, log.segments.size() - 1, warmup, repetitions);
+
+  std::vector<BenchmarkResult> results;
+  if (planner == "teb" || planner == "both")
+    results.push_back(runPlanningCycles("teb", "teb", log.segments, warmup, repetitions));
+  if (planner == "hcp" || planner == "both")
+    results.push_back(runPlanningCycles("hcp", "hcp", log.segments, warmup, repetitions));
+
+  printResultHeader(6);
+  for (const BenchmarkResult& result : results)
+    printResult(result, 6);
+
+  if (!json_filename.empty() && !writeResultsJson(json_filename, log_filename, results))
+    return EXIT_FAILURE;
+  return EXIT_SUCCESS;
+}
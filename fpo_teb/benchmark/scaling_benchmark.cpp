@@ -0,0 +1,303 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+/*
+ * Runs TebOptimalPlanner and/or HomotopyClassPlanner on synthetic scenarios (see scenario_generator.h)
+ * and reports how the latency scales with the number of static and dynamic obstacles, the length of
+ * the global plan (which determines the number of poses) and the number of candidate trajectories.
+ * Each sweep varies a single quantity while all others keep the values of the base scenario.
+ *
+ * Usage: scaling_benchmark [--sweep obstacles|dynamic|path_length|candidates|all] [--layout open|corridor|crowd]
+ *                          [--planner teb|hcp|both] [--seed N] [--cycles N] [--repetitions N] [--warmup N] [--cpu N]
+ *                          [--json FILE] [--csv FILE] [--write-log FILE]
+ *
+ * --write-log stores the base scenario as planning log, which can be replayed by replay_benchmark.
+ */
+
+#include "benchmark_utils.h"
+#include "scenario_generator.h"
+
+#include <ros/time.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+
+using namespace teb_local_planner;
+
+namespace
+{
+
+//! Single point of a sweep
+struct SweepPoint
+{
+  std::string sweep; //!< Name of the sweep
+  double value; //!< Value of the varied quantity
+  std::string planner; //!< "teb" or "hcp"
+  BenchmarkResult result;
+};
+
+struct Options
+{
+  std::string sweep = "all";
+  std::string planner = "both";
+  int repetitions = 5;
+  int warmup = 1;
+  int cpu = -1;
+  std::string json_filename;
+  std::string csv_filename;
+  std::string log_filename;
+};
+
+const std::vector<double> obstacle_counts = {4, 8, 16, 32, 64, 128};
+const std::vector<double> dynamic_counts = {0, 1, 2, 4, 8, 16};
+const std::vector<double> path_lengths = {2, 4, 8, 16, 32};
+const std::vector<double> candidate_counts = {1, 2, 4, 8, 16};
+
+//! Distribute \c count static obstacles among points, lines and polygons in the ratio 2:1:1
+void setStaticObstacles(ScenarioParameters& params, int count)
+{
+  params.num_line_obstacles = count / 4;
+  params.num_polygon_obstacles = count / 4;
+  params.num_point_obstacles = count - params.num_line_obstacles - params.num_polygon_obstacles;
+}
+
+//! Set the parameters of the benchmark config that differ from the defaults (TebConfig cannot be copied)
+void initConfig(TebConfig& cfg)
+{
+  cfg.map_frame = "map";
+}
+
+void runSweep(const std::string& sweep, const std::vector<double>& values, const ScenarioParameters& base_params,
+              RobotFootprintModelPtr robot_model, const Options& options, std::vector<SweepPoint>& points)
+{
+  std::printf("\nlatency vs %s (%s layout)\n", sweep.c_str(), scenarioLayoutName(base_params.layout));
+  std::printf("%-12s %8s %8s %8s %9s %9s %9s %9s %9s\n", sweep.c_str(), "planner", "failed", "poses", "mean[ms]", "p50[ms]",
+              "p95[ms]", "p99[ms]", "iter_avg");
+
+  for (double value : values)
+  {
+    ScenarioParameters params = base_params;
+    TebConfig cfg;
+    initConfig(cfg);
+    if (sweep == "obstacles")
+      setStaticObstacles(params, static_cast<int>(value));
+    else if (sweep == "dynamic")
+      params.num_dynamic_obstacles = static_cast<int>(value);
+    else if (sweep == "path_length")
+      params.path_length = value;
+    else if (sweep == "candidates")
+      cfg.hcp.max_number_classes = static_cast<int>(value);
+
+    Scenario scenario = generateScenario(params);
+    for (const char* planner : {"teb", "hcp"})
+    {
+      if (options.planner != "both" && options.planner != planner)
+        continue;
+      if (sweep == "candidates" && std::string(planner) == "teb")
+        continue; // a single trajectory is optimized regardless of the number of candidates
+
+      SweepPoint point;
+      point.sweep = sweep;
+      point.value = value;
+      point.planner = planner;
+      char name[128];
+      std::snprintf(name, sizeof(name), "scaling/%s/%s=%g/%s", scenarioLayoutName(params.layout), sweep.c_str(), value, planner);
+      point.result = runPlanningCycles(name, planner, cfg, robot_model, &scenario.costmap, scenario.cycles, options.warmup,
+                                       options.repetitions);
+
+      std::vector<double> latencies = point.result.latencies;
+      std::sort(latencies.begin(), latencies.end());
+      std::printf("%-12g %8s %8d %8.1f %9.3f %9.3f %9.3f %9.3f %9.1f\n", value, planner, point.result.failures,
+                  mean(point.result.poses), 1e3 * mean(latencies), 1e3 * percentile(latencies, 50),
+                  1e3 * percentile(latencies, 95), 1e3 * percentile(latencies, 99), mean(point.result.iterations));
+      points.push_back(point);
+    }
+  }
+}
+
+//! Write one line per sweep point, suitable for plotting the scaling curves
+bool writeCsv(const std::string& filename, const std::vector<SweepPoint>& points)
+{
+  FILE* file = std::fopen(filename.c_str(), "w");
+  if (!file)
+  {
+    ROS_ERROR("Cannot write '%s'.", filename.c_str());
+    return false;
+  }
+
+  std::fprintf(file, "sweep,value,planner,cycles,failures,poses,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,iterations\n");
+  for (const SweepPoint& point : points)
+  {
+    std::vector<double> latencies = point.result.latencies;
+    std::sort(latencies.begin(), latencies.end());
+    std::fprintf(file, "%s,%g,%s,%zu,%d,%.1f,%.6f,%.6f,%.6f,%.6f,%.6f,%.3f\n", point.sweep.c_str(), point.value,
+                 point.planner.c_str(), latencies.size(), point.result.failures, mean(point.result.poses),
+                 1e3 * mean(latencies), 1e3 * percentile(latencies, 50), 1e3 * percentile(latencies, 95),
+                 1e3 * percentile(latencies, 99), latencies.empty() ? 0. : 1e3 * latencies.back(),
+                 mean(point.result.iterations));
+  }
+  std::fclose(file);
+  return true;
+}
+
+//! Store the scenario as planning log that can be replayed by replay_benchmark
+bool writeLog(const std::string& filename, const Scenario& scenario, const TebConfig& cfg, const BaseRobotFootprintModel& robot_model)
+{
+  PlanningRecordWriter writer;
+  if (!writer.open(filename))
+    return false;
+
+  std::vector<std::uint8_t> payload;
+  encodeConfig(cfg, payload);
+  bool success = writer.write(PlanningRecordType::Config, payload);
+  payload.clear();
+  encodeFootprint(robot_model, payload);
+  success = success && writer.write(PlanningRecordType::Footprint, payload);
+  payload.clear();
+  encodeGlobalCostmap(scenario.costmap, payload);
+  success = success && writer.write(PlanningRecordType::GlobalCostmap, payload);
+
+  std::uint64_t config_hash = computeConfigHash(cfg);
+  for (PlanningCycleInput cycle : scenario.cycles)
+  {
+    cycle.config_hash = config_hash;
+    payload.clear();
+    encodeCycleInput(cycle, payload);
+    success = success && writer.write(PlanningRecordType::CycleInput, payload);
+  }
+  writer.close();
+  if (!success)
+    ROS_ERROR("Cannot write the scenario to '%s'.", filename.c_str());
+  return success;
+}
+
+void printUsage(const char* program)
+{
+  std::printf("Usage: %s [--sweep obstacles|dynamic|path_length|candidates|all] [--layout open|corridor|crowd]\n"
+              "       [--planner teb|hcp|both] [--seed N] [--cycles N] [--repetitions N] [--warmup N] [--cpu N]\n"
+              "       [--json FILE] [--csv FILE] [--write-log FILE]\n", program);
+}
+
+} // anonymous namespace
+
+
+int main(int argc, char** argv)
+{
+  Options options;
+  ScenarioParameters params;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "--sweep" && i + 1 < argc)
+      options.sweep = argv[++i];
+    else if (arg == "--layout" && i + 1 < argc && parseScenarioLayout(argv[i + 1], params.layout))
+      ++i;
+    else if (arg == "--planner" && i + 1 < argc)
+      options.planner = argv[++i];
+    else if (arg == "--seed" && i + 1 < argc)
+      params.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+    else if (arg == "--cycles" && i + 1 < argc)
+      params.num_cycles = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--repetitions" && i + 1 < argc)
+      options.repetitions = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--warmup" && i + 1 < argc)
+      options.warmup = std::max(0, std::atoi(argv[++i]));
+    else if (arg == "--cpu" && i + 1 < argc)
+      options.cpu = std::atoi(argv[++i]);
+    else if (arg == "--json" && i + 1 < argc)
+      options.json_filename = argv[++i];
+    else if (arg == "--csv" && i + 1 < argc)
+      options.csv_filename = argv[++i];
+    else if (arg == "--write-log" && i + 1 < argc)
+      options.log_filename = argv[++i];
+    else
+    {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  const std::vector<std::string> sweeps = {"obstacles", "dynamic", "path_length", "candidates"};
+  if ((options.sweep != "all" && std::find(sweeps.begin(), sweeps.end(), options.sweep) == sweeps.end()) ||
+      (options.planner != "teb" && options.planner != "hcp" && options.planner != "both"))
+  {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (options.cpu >= 0 && !pinToCpu(options.cpu))
+    return EXIT_FAILURE;
+
+  // the planners query ros::Time::now(), which works without ros::init() after initializing the wall clock
+  ros::Time::init();
+
+  TebConfig cfg;
+  initConfig(cfg);
+  RobotFootprintModelPtr robot_model(new PointRobotFootprint());
+
+  if (!options.log_filename.empty() && !writeLog(options.log_filename, generateScenario(params), cfg, *robot_model))
+    return EXIT_FAILURE;
+
+  std::printf("%d cycles per scenario, %d warmup and %d measured repetitions, seed %u\n", params.num_cycles, options.warmup,
+              options.repetitions, params.seed);
+
+  std::vector<SweepPoint> points;
+  if (options.sweep == "all" || options.sweep == "obstacles")
+    runSweep("obstacles", obstacle_counts, params, robot_model, options, points);
+  if (options.sweep == "all" || options.sweep == "dynamic")
+    runSweep("dynamic", dynamic_counts, params, robot_model, options, points);
+  if (options.sweep == "all" || options.sweep == "path_length")
+    runSweep("path_length", path_lengths, params, robot_model, options, points);
+  if (options.sweep == "all" || options.sweep == "candidates")
+    runSweep("candidates", candidate_counts, params, robot_model, options, points);
+
+  if (!options.csv_filename.empty() && !writeCsv(options.csv_filename, points))
+    return EXIT_FAILURE;
+  if (!options.json_filename.empty())
+  {
+    std::vector<BenchmarkResult> results;
+    for (const SweepPoint& point : points)
+      results.push_back(point.result);
+    if (!writeResultsJson(options.json_filename, "synthetic scenarios", results))
+      return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
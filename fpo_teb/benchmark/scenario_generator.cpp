@@ -0,0 +1,345 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#include "scenario_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+
+namespace teb_local_planner
+{
+
+namespace
+{
+
+//! Static obstacle together with a bounding circle used for rasterizing it into the costmap
+struct StaticObstacle
+{
+  ObstaclePtr obstacle;
+  Eigen::Vector2d center;
+  double extent; //!< Radius of the bounding circle around the center [m]
+};
+
+//! Obstacle moving with constant velocity
+struct DynamicObstacle
+{
+  Eigen::Vector2d position;
+  Eigen::Vector2d velocity;
+};
+
+//! Rectangular area of a scenario
+struct ScenarioArea
+{
+  double x_min, x_max, y_min, y_max;
+};
+
+class ScenarioBuilder
+{
+public:
+  ScenarioBuilder(const ScenarioParameters& params) : params_(params), rng_(params.seed)
+  {
+    double half_width = 0.5 * (params.layout == ScenarioLayout::Corridor ? params.corridor_width : params.area_width);
+    area_.x_min = -1.;
+    area_.x_max = params.path_length + 1.;
+    area_.y_min = -half_width;
+    area_.y_max = half_width;
+    start_ = Eigen::Vector2d::Zero();
+    goal_ = Eigen::Vector2d(params.path_length, 0.);
+  }
+
+  Scenario build()
+  {
+    if (params_.layout == ScenarioLayout::Corridor)
+      addCorridorWalls();
+    for (int i = 0; i < params_.num_point_obstacles; ++i)
+      addPointObstacle();
+    for (int i = 0; i < params_.num_line_obstacles; ++i)
+      addLineObstacle();
+    for (int i = 0; i < params_.num_polygon_obstacles; ++i)
+      addPolygonObstacle();
+    for (int i = 0; i < params_.num_dynamic_obstacles; ++i)
+      addDynamicObstacle();
+
+    Scenario scenario;
+    buildCostmap(scenario.costmap);
+    for (int k = 0; k < std::max(1, params_.num_cycles); ++k)
+      scenario.cycles.push_back(buildCycle(k * params_.cycle_period));
+    return scenario;
+  }
+
+private:
+  double uniform(double min, double max)
+  {
+    return std::uniform_real_distribution<double>(min, max)(rng_);
+  }
+
+  //! Sample a position within the area (shrunk by \c margin) that keeps the clearance to start and goal
+  Eigen::Vector2d samplePosition(double margin)
+  {
+    Eigen::Vector2d position;
+    double y_margin = std::min(margin, 0.5 * (area_.y_max - area_.y_min));
+    for (int attempt = 0; attempt < 100; ++attempt)
+    {
+      position = Eigen::Vector2d(uniform(area_.x_min, area_.x_max), uniform(area_.y_min + y_margin, area_.y_max - y_margin));
+      if ((position - start_).norm() > params_.clearance + margin && (position - goal_).norm() > params_.clearance + margin)
+        break;
+    }
+    return position;
+  }
+
+  void addStaticObstacle(Obstacle* obstacle, const Eigen::Vector2d& center, double extent)
+  {
+    StaticObstacle entry;
+    entry.obstacle = ObstaclePtr(obstacle);
+    entry.center = center;
+    entry.extent = extent;
+    static_obstacles_.push_back(entry);
+  }
+
+  void addCorridorWalls()
+  {
+    // the walls are split into segments of about one meter, similar to the output of the costmap converter
+    int segments = std::max(1, static_cast<int>(std::ceil(area_.x_max - area_.x_min)));
+    double length = (area_.x_max - area_.x_min) / segments;
+    for (double y : {area_.y_min, area_.y_max})
+    {
+      for (int i = 0; i < segments; ++i)
+      {
+        Eigen::Vector2d line_start(area_.x_min + i * length, y);
+        Eigen::Vector2d line_end(area_.x_min + (i + 1) * length, y);
+        addStaticObstacle(new LineObstacle(line_start, line_end), 0.5 * (line_start + line_end), 0.5 * length);
+      }
+    }
+  }
+
+  void addPointObstacle()
+  {
+    Eigen::Vector2d position = samplePosition(0.);
+    addStaticObstacle(new PointObstacle(position), position, 0.);
+  }
+
+  void addLineObstacle()
+  {
+    double half_length = 0.5 * params_.obstacle_size;
+    Eigen::Vector2d center = samplePosition(half_length);
+    double angle = uniform(-M_PI, M_PI);
+    Eigen::Vector2d direction(half_length * std::cos(angle), half_length * std::sin(angle));
+    addStaticObstacle(new LineObstacle(center - direction, center + direction), center, half_length);
+  }
+
+  void addPolygonObstacle()
+  {
+    double radius = 0.5 * params_.obstacle_size * uniform(0.5, 1.);
+    Eigen::Vector2d center = samplePosition(radius);
+    double rotation = uniform(-M_PI, M_PI);
+    int num_vertices = std::max(3, params_.polygon_vertices);
+
+    // regular polygons are convex, which corresponds to the polygons obtained from the costmap converter
+    PolygonObstacle* polygon = new PolygonObstacle();
+    for (int i = 0; i < num_vertices; ++i)
+    {
+      double angle = rotation + 2. * M_PI * i / num_vertices;
+      polygon->pushBackVertex(center + radius * Eigen::Vector2d(std::cos(angle), std::sin(angle)));
+    }
+    polygon->finalizePolygon();
+    addStaticObstacle(polygon, center, radius);
+  }
+
+  void addDynamicObstacle()
+  {
+    DynamicObstacle obstacle;
+    obstacle.position = samplePosition(params_.dynamic_obstacle_radius);
+    double speed = params_.max_obstacle_speed * uniform(0.2, 1.);
+    double heading;
+    switch (params_.layout)
+    {
+      case ScenarioLayout::Corridor:
+        heading = uniform(0., 1.) < 0.5 ? 0. : M_PI; // oncoming or overtaken
+        break;
+      case ScenarioLayout::Crowd:
+        heading = (uniform(0., 1.) < 0.5 ? 0.5 * M_PI : -0.5 * M_PI) + uniform(-M_PI / 6., M_PI / 6.); // crossing the plan
+        break;
+      default:
+        heading = uniform(-M_PI, M_PI);
+        break;
+    }
+    obstacle.velocity = speed * Eigen::Vector2d(std::cos(heading), std::sin(heading));
+    dynamic_obstacles_.push_back(obstacle);
+  }
+
+  //! Position of a dynamic obstacle at time \c t, wrapped into the area
+  Eigen::Vector2d dynamicPosition(const DynamicObstacle& obstacle, double t) const
+  {
+    Eigen::Vector2d position = obstacle.position + t * obstacle.velocity;
+    double width = area_.x_max - area_.x_min;
+    double height = area_.y_max - area_.y_min;
+    position.x() = area_.x_min + (position.x() - area_.x_min) - width * std::floor((position.x() - area_.x_min) / width);
+    position.y() = area_.y_min + (position.y() - area_.y_min) - height * std::floor((position.y() - area_.y_min) / height);
+    return position;
+  }
+
+  void buildCostmap(nav_msgs::OccupancyGrid& costmap) const
+  {
+    // the planner inspects up to five cells around obstacle centroids, hence keep a margin around the area
+    double resolution = params_.costmap_resolution;
+    double margin = std::max(0.5, 6. * resolution);
+    costmap.header.frame_id = "map";
+    costmap.info.resolution = resolution;
+    costmap.info.origin.position.x = area_.x_min - margin;
+    costmap.info.origin.position.y = area_.y_min - margin;
+    costmap.info.origin.orientation.w = 1.;
+    costmap.info.width = static_cast<unsigned int>(std::ceil((area_.x_max - area_.x_min + 2. * margin) / resolution));
+    costmap.info.height = static_cast<unsigned int>(std::ceil((area_.y_max - area_.y_min + 2. * margin) / resolution));
+    costmap.data.assign(costmap.info.width * costmap.info.height, 0);
+
+    // only cells within the bounding circle of an obstacle are tested
+    for (const StaticObstacle& entry : static_obstacles_)
+    {
+      double extent = entry.extent + resolution;
+      int mx_min = std::max(0, static_cast<int>((entry.center.x() - extent - costmap.info.origin.position.x) / resolution));
+      int my_min = std::max(0, static_cast<int>((entry.center.y() - extent - costmap.info.origin.position.y) / resolution));
+      int mx_max = std::min<int>(costmap.info.width - 1, (entry.center.x() + extent - costmap.info.origin.position.x) / resolution);
+      int my_max = std::min<int>(costmap.info.height - 1, (entry.center.y() + extent - costmap.info.origin.position.y) / resolution);
+      for (int my = my_min; my <= my_max; ++my)
+      {
+        for (int mx = mx_min; mx <= mx_max; ++mx)
+        {
+          Eigen::Vector2d cell(costmap.info.origin.position.x + (mx + 0.5) * resolution,
+                               costmap.info.origin.position.y + (my + 0.5) * resolution);
+          if (entry.obstacle->getMinimumDistance(cell) <= 0.5 * resolution)
+            costmap.data[my * costmap.info.width + mx] = 100;
+        }
+      }
+    }
+  }
+
+  PlanningCycleInput buildCycle(double t) const
+  {
+    PlanningCycleInput cycle;
+    cycle.stamp = t;
+
+    int num_poses = std::max(2, static_cast<int>(std::ceil(params_.path_length / params_.path_resolution)) + 1);
+    for (int i = 0; i < num_poses; ++i)
+    {
+      geometry_msgs::PoseStamped pose;
+      pose.header.frame_id = "map";
+      pose.header.stamp = ros::Time(t);
+      pose.pose.position.x = params_.path_length * i / (num_poses - 1);
+      pose.pose.orientation.w = 1.;
+      cycle.plan.push_back(pose);
+    }
+
+    for (const StaticObstacle& entry : static_obstacles_)
+      cycle.obstacles.push_back(entry.obstacle);
+
+    cycle.predictions.header.frame_id = "map";
+    cycle.predictions.header.stamp = ros::Time(t);
+    for (const DynamicObstacle& obstacle : dynamic_obstacles_)
+    {
+      Eigen::Vector2d position = dynamicPosition(obstacle, t);
+
+      obstacle_prediction::Obstacle prediction;
+      prediction.position.x = position.x();
+      prediction.position.y = position.y();
+      prediction.linear.x = obstacle.velocity.x();
+      prediction.linear.y = obstacle.velocity.y();
+      prediction.width = 2. * params_.dynamic_obstacle_radius;
+      prediction.length = 2. * params_.dynamic_obstacle_radius;
+      cycle.predictions.obstacles.push_back(prediction);
+
+      if (params_.dynamic_obstacles_in_container)
+      {
+        CircularObstacle* circle = new CircularObstacle(position, params_.dynamic_obstacle_radius);
+        circle->setCentroidVelocity(obstacle.velocity);
+        cycle.obstacles.push_back(ObstaclePtr(circle));
+      }
+    }
+    return cycle;
+  }
+
+  const ScenarioParameters& params_;
+  std::mt19937 rng_;
+  ScenarioArea area_;
+  Eigen::Vector2d start_;
+  Eigen::Vector2d goal_;
+  std::vector<StaticObstacle, Eigen::aligned_allocator<StaticObstacle> > static_obstacles_;
+  std::vector<DynamicObstacle, Eigen::aligned_allocator<DynamicObstacle> > dynamic_obstacles_;
+
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+} // anonymous namespace
+
+
+Scenario generateScenario(const ScenarioParameters& params)
+{
+  ScenarioBuilder builder(params);
+  return builder.build();
+}
+
+
+bool parseScenarioLayout(const std::string& name, ScenarioLayout& layout)
+{
+  if (name == "open")
+    layout = ScenarioLayout::Open;
+  else if (name == "corridor")
+    layout = ScenarioLayout::Corridor;
+  else if (name == "crowd")
+    layout = ScenarioLayout::Crowd;
+  else
+    return false;
+  return true;
+}
+
+
+const char* scenarioLayoutName(ScenarioLayout layout)
+{
+  switch (layout)
+  {
+    case ScenarioLayout::Corridor:
+      return "corridor";
+    case ScenarioLayout::Crowd:
+      return "crowd";
+    default:
+      return "open";
+  }
+}
+
+} // namespace teb_local_planner
@@ -0,0 +1,117 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#ifndef SCENARIO_GENERATOR_H_
+#define SCENARIO_GENERATOR_H_
+
+#include <teb_local_planner/planning_record.h>
+
+#include <nav_msgs/OccupancyGrid.h>
+
+#include <string>
+#include <vector>
+
+
+namespace teb_local_planner
+{
+
+//! Arrangement of the obstacles around the global plan
+enum class ScenarioLayout
+{
+  Open, //!< Static obstacles spread over a wide area, dynamic obstacles move in arbitrary directions
+  Corridor, //!< Narrow corridor bounded by two walls, dynamic obstacles move along the corridor
+  Crowd //!< Wide area in which dynamic obstacles cross the global plan
+};
+
+//! Parameters of a synthetic scenario, see generateScenario()
+struct ScenarioParameters
+{
+  ScenarioLayout layout = ScenarioLayout::Open; //!< Arrangement of the obstacles
+  int num_point_obstacles = 10; //!< Number of static point obstacles
+  int num_line_obstacles = 5; //!< Number of static line obstacles
+  int num_polygon_obstacles = 5; //!< Number of static convex polygon obstacles
+  int polygon_vertices = 5; //!< Number of vertices of each polygon obstacle
+  int num_dynamic_obstacles = 2; //!< Number of circular obstacles moving with constant velocity
+  bool dynamic_obstacles_in_container = true; //!< Add dynamic obstacles to the obstacle container in addition to the predictions
+  double path_length = 6.; //!< Length of the straight global plan along the x-axis [m]
+  double path_resolution = 0.1; //!< Distance between consecutive poses of the global plan [m]
+  double area_width = 6.; //!< Width of the area of the open and crowd layouts [m]
+  double corridor_width = 2.; //!< Width of the corridor layout [m]
+  double obstacle_size = 0.4; //!< Length of line obstacles and diameter of polygon obstacles [m]
+  double dynamic_obstacle_radius = 0.3; //!< Radius of dynamic obstacles [m]
+  double max_obstacle_speed = 1.; //!< Maximum speed of dynamic obstacles [m/s]
+  double clearance = 0.6; //!< Minimum distance of obstacles to the start and the goal of the plan [m]
+  int num_cycles = 10; //!< Number of planning cycles
+  double cycle_period = 0.1; //!< Time between two planning cycles [s]
+  double costmap_resolution = 0.05; //!< Resolution of the global costmap [m/cell]
+  unsigned int seed = 1; //!< Seed of the random number generator
+};
+
+//! Inputs of the planner generated for a synthetic scenario
+struct Scenario
+{
+  std::vector<PlanningCycleInput> cycles; //!< Planning cycles in chronological order
+  nav_msgs::OccupancyGrid costmap; //!< Global costmap in which the static obstacles are occupied
+};
+
+/**
+ * @brief Generate a synthetic scenario from the given parameters
+ *
+ * The robot rests at the start of a straight global plan, the goal is located \c path_length meters ahead.
+ * Static obstacles are placed randomly within the area of the layout but keep the clearance to the start
+ * and the goal. Dynamic obstacles move with constant velocity; those leaving the area re-enter on the
+ * opposite side so that the obstacle density remains constant over all cycles. The predictions of each
+ * cycle contain the current position and velocity of every dynamic obstacle.
+ *
+ * The same parameters (including the seed) always produce the same scenario.
+ * @param params Parameters of the scenario
+ * @return the planning cycles and the global costmap of the scenario
+ */
+Scenario generateScenario(const ScenarioParameters& params);
+
+/**
+ * @brief Parse the name of a layout ("open", "corridor" or "crowd")
+ * @return false if \c name does not denote a layout
+ */
+bool parseScenarioLayout(const std::string& name, ScenarioLayout& layout);
+
+//! Name of the layout as accepted by parseScenarioLayout()
+const char* scenarioLayoutName(ScenarioLayout layout);
+
+} // namespace teb_local_planner
+
+#endif /* SCENARIO_GENERATOR_H_ */
@@ -0,0 +1,166 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#ifndef FOOTPRINT_COSTMAP_MODEL_H_
+#define FOOTPRINT_COSTMAP_MODEL_H_
+
+#include <vector>
+
+#include <base_local_planner/costmap_model.h>
+#include <costmap_2d/costmap_2d.h>
+#include <geometry_msgs/Point.h>
+
+#include <Eigen/Core>
+
+
+namespace teb_local_planner
+{
+
+/**
+ * @class FootprintCostmapModel
+ * @brief Costmap model that rasterizes the footprint outline once per discretized heading.
+ *
+ * base_local_planner::CostmapModel transforms the footprint and traces its outline with a line iterator
+ * for each queried pose. This model precomputes the outline cells relative to the center cell for
+ * a fixed number of heading bins (and for the position of the robot inside its cell), hence a query only
+ * picks the bin of the pose and scans the cached offsets in the raw costmap array (stopping at the first lethal cell).
+ * The cache is built by setFootprint(), which takes tens of milliseconds for large footprints and hence must be called
+ * outside of the control loop (at initialization and whenever the footprint or the geometry of the costmap changes).
+ * Queries for another footprint or costmap geometry fall back to base_local_planner::CostmapModel. \n
+ * The check is conservative: the cells of a bin are a superset of the cells traced by base_local_planner::CostmapModel
+ * for any pose of the bin, hence a pose is never reported free if footprintCost() reports a lethal cell.
+ * To this end, the outline of the pose at the center of the bin is widened to a band of
+ * \f$ 2 \cdot (1.21 + 0.71 / n_{subcells} + \pi \cdot r_{circumscribed} / (res \cdot n_{headings})) \f$ cells.
+ * Poses close to lethal cells might be rejected although footprintCost() accepts them. \n
+ * The number of cached cells grows with the perimeter of the footprint, whereas base_local_planner::CostmapModel
+ * traces the outline only once. The cache thus pays off for footprints with many vertices rather than for
+ * elongated footprints with few vertices (see distance_benchmark, footprintCost/...).
+ * @remarks The model is used by TebOptimalPlanner::isTrajectoryFeasible() if it is passed as costmap model.
+ *          setFootprint() must not be called concurrently with queries.
+ */
+class FootprintCostmapModel : public base_local_planner::CostmapModel
+{
+public:
+
+  /**
+   * @brief Construct the model
+   * @param costmap costmap the footprint is checked against
+   * @param num_headings number of heading bins (at least 1)
+   * @param num_subcells number of bins per axis for the position of the robot inside its cell (at least 1)
+   */
+  FootprintCostmapModel(const costmap_2d::Costmap2D& costmap, int num_headings, int num_subcells = 4);
+
+  /**
+   * @brief Virtual destructor.
+   */
+  virtual ~FootprintCostmapModel() {}
+
+  /**
+   * @brief Rasterize the outline cells of all heading bins for the given footprint
+   *
+   * Nothing is done if the cache already matches the footprint and the resolution and width of the costmap.
+   * @param footprint_spec footprint of the robot (robot frame)
+   */
+  void setFootprint(const std::vector<geometry_msgs::Point>& footprint_spec);
+
+  /**
+   * @brief Check the footprint at a given pose using the cached outline cells
+   *
+   * Counterpart of base_local_planner::WorldModel::footprintCost(x, y, theta, footprint_spec).
+   * Footprints with less than three vertices, footprints or costmap geometries that differ from the last setFootprint() call
+   * and poses whose cached cells exceed the map are delegated to the base class.
+   * @param x x-coordinate of the robot
+   * @param y y-coordinate of the robot
+   * @param theta orientation of the robot
+   * @param footprint_spec footprint of the robot (robot frame)
+   * @return -1 if the (widened) outline covers a lethal cell, -2 if it covers a cell without information,
+   *         -3 if it is (partially) outside of the map, otherwise the maximum cost of the outline cells
+   */
+  double cachedFootprintCost(double x, double y, double theta, const std::vector<geometry_msgs::Point>& footprint_spec);
+
+  /**
+   * @brief Get the number of heading bins
+   */
+  int numHeadings() const {return num_headings_;}
+
+private:
+
+  //! Range of the cached cells of a heading bin and the bounding box of their offsets
+  struct HeadingBin
+  {
+    int begin; //!< Index of the first cell in cell_offsets_
+    int end; //!< Index behind the last cell in cell_offsets_
+    int min_x; //!< Minimum x-offset of the cells
+    int max_x; //!< Maximum x-offset of the cells
+    int min_y; //!< Minimum y-offset of the cells
+    int max_y; //!< Maximum y-offset of the cells
+  };
+
+  /**
+   * @brief Intersect a row with the set of points within a radius of a line segment (capsule)
+   * @param start start of the segment
+   * @param end end of the segment
+   * @param radius radius of the capsule
+   * @param y y-coordinate of the row
+   * @param[out] min_x lower bound of the intersection
+   * @param[out] max_x upper bound of the intersection
+   * @return \c true if the row intersects the capsule
+   */
+  static bool capsuleRowInterval(const Eigen::Vector2d& start, const Eigen::Vector2d& end, double radius, double y,
+                                 double& min_x, double& max_x);
+
+  /**
+   * @brief Check whether the cache was built for the given footprint and the current costmap geometry
+   * @param footprint_spec footprint of the robot (robot frame)
+   */
+  bool isCached(const std::vector<geometry_msgs::Point>& footprint_spec) const;
+
+  const costmap_2d::Costmap2D& costmap_; //!< Costmap the footprint is checked against
+  int num_headings_; //!< Number of heading bins, bin k is centered at the orientation k * 2 pi / num_headings_
+  int num_subcells_; //!< Number of bins per axis for the position inside the center cell
+
+  std::vector<HeadingBin> bins_; //!< Bins ordered by heading, subcell y and subcell x
+  std::vector<int> cell_offsets_; //!< Offsets of the outline cells w.r.t. the center cell in the costmap array
+
+  std::vector<geometry_msgs::Point> footprint_; //!< Footprint the cache was built for
+  double resolution_; //!< Costmap resolution the cache was built for
+  unsigned int size_x_; //!< Costmap width (number of cells) the cache was built for
+};
+
+} // namespace teb_local_planner
+
+#endif /* FOOTPRINT_COSTMAP_MODEL_H_ */
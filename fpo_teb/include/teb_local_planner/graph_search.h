@@ -50,16 +50,21 @@
   #undef BOOST_NO_CXX11_DEFAULTED_FUNCTIONS
 #endif
 
+#include <atomic>
+#include <unordered_set>
+
 #include <boost/graph/graph_traits.hpp>
 #include <boost/graph/depth_first_search.hpp>
 #include <boost/utility.hpp>
 #include <boost/random.hpp>
 
 #include <Eigen/Core>
+#include <Eigen/Geometry>
 
 #include <geometry_msgs/Twist.h>
 
 #include <teb_local_planner/equivalence_relations.h>
+#include <teb_local_planner/obstacle_grid.h>
 #include <teb_local_planner/pose_se2.h>
 #include <teb_local_planner/teb_config.h>
 
@@ -101,6 +106,40 @@ inline const Eigen::Vector2d& getVector2dFromHcGraph(HcGraphVertexType vert_desc
   return graph[vert_descriptor].pos;
 }
 
+/**
+ * @brief Input and output of a graph search that runs decoupled from the HomotopyClassPlanner (e.g. in a background thread)
+ *
+ * The graph search operates on the obstacle snapshots stored here and collects the paths found
+ * instead of initializing new trajectories in the HomotopyClassPlanner.
+ */
+struct ExplorationJob
+{
+  //! Abbrev. for a path (sequence of 2D positions) from start to goal
+  typedef std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > Path;
+
+  ExplorationJob() : start(0, 0, 0), goal(0, 0, 0), dist_to_obst(0), obstacle_heading_threshold(0), max_seeds(0), generation(0) {}
+
+  PoseSE2 start; //!< Start pose of the exploration
+  PoseSE2 goal; //!< Goal pose of the exploration
+  double dist_to_obst; //!< Allowed distance to obstacles (see GraphSearchInterface::createGraph())
+  double obstacle_heading_threshold; //!< Heading threshold (see GraphSearchInterface::createGraph())
+  ObstContainer obstacles; //!< Snapshot of the obstacles
+  ObstContainer hsignature_obstacles; //!< Snapshot of the obstacles that distinguish equivalence classes
+  int max_seeds; //!< The search stops after this number of paths is found
+  TebConfig::HomotopyClasses hcp; //!< Snapshot of the homotopy class parameters (the config might be reconfigured during the exploration)
+  TebConfig::GoalTolerance goal_tolerance; //!< Snapshot of the goal tolerance parameters
+  unsigned int generation; //!< Id used by the planner to discard outdated results
+
+  std::vector<Path> seeds; //!< [out] Paths of distinct homotopy classes (shortest first)
+  HcGraph graph; //!< [out] Copy of the search graph (only for visualization, might be empty)
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+//! Abbrev. for shared pointers of an ExplorationJob
+typedef boost::shared_ptr<ExplorationJob> ExplorationJobPtr;
+
+
 /**
  * @brief Base class for graph based path planning / homotopy class sampling
  */
@@ -115,6 +154,23 @@ public:
    */
   void clearGraph() {graph_.clear();}
 
+  /**
+   * @brief Let subsequent createGraph() calls operate on a decoupled exploration job
+   *
+   * If a job is set, obstacles are taken from the job and paths found are appended to ExplorationJob::seeds,
+   * the HomotopyClassPlanner is not accessed at all. Pass \c NULL to operate on the HomotopyClassPlanner again.
+   * @param job exploration job (must outlive subsequent createGraph() calls)
+   */
+  void setExplorationJob(ExplorationJob* job) {job_ = job;}
+
+  /**
+   * @brief Discard all data kept across planning cycles (e.g. persistent keypoints and cached edge checks)
+   *
+   * The data is dropped at the beginning of the next createGraph() call, hence this method might be called
+   * while an exploration is running on another thread.
+   */
+  virtual void clearCache() {}
+
   // HcGraph graph() const {return graph_;}
   // Workaround. graph_ is public for now, beacuse otherwise the compilation fails with the same boost bug mentioned above.
   HcGraph graph_; //!< Store the graph that is utilized to find alternative homotopy classes.
@@ -123,27 +179,101 @@ protected:
   /**
    * @brief Protected constructor that should be called by subclasses
    */
-  GraphSearchInterface(const TebConfig& cfg, HomotopyClassPlanner* hcp) : cfg_(&cfg), hcp_(hcp){}
+  GraphSearchInterface(const TebConfig& cfg, HomotopyClassPlanner* hcp) : cfg_(&cfg), hcp_(hcp), job_(NULL){}
 
   /**
-   * @brief Depth First Search implementation to find all paths between the start and the specified goal vertex.
+   * @brief Search the shortest paths between start and goal that belong to distinct homotopy classes.
    *
-   * Complete paths are stored to the internal path container.
-   * @sa http://www.technical-recipes.com/2011/a-recursive-algorithm-to-find-all-paths-between-two-given-nodes/
-   * @param g Graph on which the depth first should be performed
-   * @param visited A container that stores visited vertices (pass an empty container, it will be filled inside during recursion).
+   * Best-first (A*) enumeration of simple paths in the graph. Each partial path keeps the winding angles around all obstacles
+   * that are relevant for the equivalence classes (HomotopyClassPlanner::hSignatureObstacles()), updated incrementally per edge.
+   * Two partial paths that reach the same vertex with the same winding angles are homotopic, hence only the first (shortest) one is expanded further. \n
+   * Each path that reaches the goal therefore belongs to a new homotopy class and is passed to HomotopyClassPlanner::addAndInitNewTeb().
+   * The search stops if hcp.max_number_classes trajectories exist or if hcp.graph_search_max_expansions partial paths are expanded.
+   * @remarks If dynamic obstacles are included, the winding angles refer to the current obstacle positions, such that pruning is approximate.
+   * @param start Start vertex
    * @param goal Desired goal vertex
    * @param start_orientation Orientation of the first trajectory pose, required to initialize the trajectory/TEB
    * @param goal_orientation Orientation of the goal trajectory pose, required to initialize the trajectory/TEB
    * @param start_velocity start velocity (optional)
    * @param free_goal_vel if \c true, a nonzero final velocity at the goal pose is allowed, otherwise the final velocity will be zero (default: false)
    */
-  void DepthFirst(HcGraph& g, std::vector<HcGraphVertexType>& visited, const HcGraphVertexType& goal, double start_orientation, double goal_orientation, const geometry_msgs::Twist* start_velocity, bool free_goal_vel = false);
+  void findDistinctPaths(HcGraphVertexType start, HcGraphVertexType goal, double start_orientation, double goal_orientation, const geometry_msgs::Twist* start_velocity, bool free_goal_vel = false);
+
+  /**
+   * @brief Insert all admissible forward edges between the vertices of the graph
+   *
+   * An edge from vertex i to vertex j is inserted, if the normalized scalar product between the edge direction and \c direction
+   * exceeds \c obstacle_heading_threshold, if the edge is not longer than \c max_edge_length and if the edge does not intersect any obstacle. \n
+   * Vertices are sorted along \c direction beforehand, such that backward pairs and pairs that are too far apart are skipped without
+   * any further computation. Collision checks are performed with the help of obstacle_grid_ (which is rebuilt here).
+   * The resulting graph is identical to testing all vertex pairs.
+   * @param direction Normalized direction from start to goal
+   * @param obstacle_heading_threshold Lower bound on the normalized scalar product between edge direction and \c direction
+   * @param max_edge_length Maximum length of an edge (0: unbounded)
+   * @param dist_to_obst Minimum distance between edges and obstacles
+   * @param goal Goal vertex (edges are not started from the goal)
+   * @param excluded_edges Edges that must not be inserted (e.g. due to the start orientation)
+   */
+  void insertForwardEdges(const Eigen::Vector2d& direction, double obstacle_heading_threshold, double max_edge_length, double dist_to_obst,
+                          HcGraphVertexType goal, const std::vector< std::pair<HcGraphVertexType, HcGraphVertexType> >& excluded_edges =
+                          std::vector< std::pair<HcGraphVertexType, HcGraphVertexType> >());
+
+  /**
+   * @brief Get the obstacles the graph is created for (either from the current exploration job or from the HomotopyClassPlanner)
+   * @return obstacle container (might be NULL)
+   */
+  const ObstContainer* obstacles() const;
+
+  /**
+   * @brief Get the obstacles that distinguish equivalence classes (either from the current exploration job or from the HomotopyClassPlanner)
+   * @return obstacle container
+   */
+  const ObstContainer& hSignatureObstacles() const;
+
+  /**
+   * @brief Check if the search has found enough candidates
+   * @return \c true if the maximum number of classes (or seeds of the exploration job) is reached
+   */
+  bool enoughCandidates() const;
+
+  /**
+   * @brief Get the homotopy class parameters of the search (either the snapshot of the current exploration job or the config)
+   */
+  const TebConfig::HomotopyClasses& hcpConfig() const {return job_ ? job_->hcp : cfg_->hcp;}
+
+  /**
+   * @brief Get the goal tolerance parameters of the search (either the snapshot of the current exploration job or the config)
+   */
+  const TebConfig::GoalTolerance& goalToleranceConfig() const {return job_ ? job_->goal_tolerance : cfg_->goal_tolerance;}
+
+  /**
+   * @brief Pass a path of a new homotopy class either to the HomotopyClassPlanner or to the current exploration job
+   * @param path Vertices of the path from start to goal
+   * @param start_orientation Orientation of the first trajectory pose
+   * @param goal_orientation Orientation of the goal trajectory pose
+   * @param start_velocity start velocity (optional)
+   * @param free_goal_vel if \c true, a nonzero final velocity at the goal pose is allowed
+   */
+  void addCandidate(const std::vector<HcGraphVertexType>& path, double start_orientation, double goal_orientation,
+                    const geometry_msgs::Twist* start_velocity, bool free_goal_vel);
+
+  /**
+   * @brief Check if the edge between two vertices collides with an obstacle (called by insertForwardEdges())
+   *
+   * The default implementation queries obstacle_grid_. Subclasses might override this method in order to cache results.
+   * @param from First vertex of the edge
+   * @param to Second vertex of the edge
+   * @param dist_to_obst Minimum distance between the edge and obstacles
+   * @return \c true if the edge collides, \c false otherwise
+   */
+  virtual bool checkEdgeCollision(HcGraphVertexType from, HcGraphVertexType to, double dist_to_obst);
 
 
 protected:
     const TebConfig* cfg_; //!< Config class that stores and manages all related parameters
     HomotopyClassPlanner* const hcp_; //!< Raw pointer to the HomotopyClassPlanner. The HomotopyClassPlanner itself is guaranteed to outlive the graph search class it is holding.
+    ObstacleGrid obstacle_grid_; //!< Spatial index of the obstacles for collision checking edges during graph creation
+    ExplorationJob* job_; //!< Decoupled exploration job (if not NULL, the HomotopyClassPlanner is not accessed)
 
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -183,7 +313,7 @@ public:
 class ProbRoadmapGraph : public GraphSearchInterface
 {
 public:
-  ProbRoadmapGraph(const TebConfig& cfg, HomotopyClassPlanner* hcp) : GraphSearchInterface(cfg, hcp){}
+  ProbRoadmapGraph(const TebConfig& cfg, HomotopyClassPlanner* hcp) : GraphSearchInterface(cfg, hcp), halton_index_(0), roadmap_dist_to_obst_(-1), cycle_(0), clear_cache_(false){}
 
   virtual ~ProbRoadmapGraph(){}
 
@@ -192,6 +322,9 @@ public:
    * @brief Create a graph and sample points in the global frame that can be used to explore new possible paths between start and goal.
    *
    * This version of the graph samples keypoints in a predefined area (config) in the current frame between start and goal. \n
+   * If hcp.roadmap_graph_reuse is enabled, keypoints are taken from a Halton sequence and kept as long as they remain inside the area.
+   * Collision checks of edges between persistent keypoints are cached and only repeated if an obstacle appeared (or the blocking obstacle disappeared).
+   * Free edges that were not checked in the previous cycle are checked again against all obstacles. \n
    * Afterwards all feasible paths between start and goal point are extracted using a Depth First Search. \n
    * Use the sampling method for complex, non-point or huge obstacles. \n
    * You may call createGraph() instead.
@@ -207,8 +340,73 @@ public:
    */
   virtual void createGraph(const PoseSE2& start, const PoseSE2& goal, double dist_to_obst, double obstacle_heading_threshold, const geometry_msgs::Twist* start_velocity, bool free_goal_vel = false);
 
+  // overrides clearCache() of the base class (persistent keypoints and edge cache are dropped in the next createGraph() call)
+  virtual void clearCache() {clear_cache_ = true;}
+
+protected:
+
+  // overrides checkEdgeCollision() of the base class (consults the edge cache for persistent keypoints)
+  virtual bool checkEdgeCollision(HcGraphVertexType from, HcGraphVertexType to, double dist_to_obst);
+
 private:
+
+  /**
+   * @brief Keep all persistent keypoints inside the sampling area and replace the remaining ones by new points of the Halton sequence
+   * @param area_origin Bottom left corner of the sampling area
+   * @param rot_phi Orientation of the sampling area
+   * @param area_length Length of the sampling area (along the start-goal direction)
+   * @param area_width Width of the sampling area
+   */
+  void updateSamples(const Eigen::Vector2d& area_origin, const Eigen::Rotation2D<double>& rot_phi, double area_length, double area_width);
+
+  /**
+   * @brief Compare the current obstacles with the ones of the previous cycle and collect obstacles that appeared
+   * @param dist_to_obst Minimum distance between edges and obstacles (the edge cache is reset if it changes)
+   */
+  void updateObstacleSnapshot(double dist_to_obst);
+
+  /**
+   * @brief Compute a key that identifies an obstacle between planning cycles (based on its bounding box)
+   * @param obst obstacle
+   * @return key (0 if the extent of the obstacle is unknown)
+   */
+  static std::size_t obstacleKey(const Obstacle& obst);
+
+  /**
+   * @brief Radical inverse of an integer (element of the van der Corput sequence)
+   * @param index index of the element
+   * @param base base of the sequence (prime)
+   * @return element in [0,1)
+   */
+  static double radicalInverse(unsigned int index, unsigned int base);
+
+  //! Cached collision state of an edge between two persistent keypoints
+  struct EdgeState
+  {
+    enum State {Unknown, Free, Blocked};
+    State state; //!< Result of the last collision check
+    std::size_t blocker; //!< Key of the blocking obstacle if state == Blocked
+    unsigned int cycle; //!< Planning cycle (see cycle_) the state was determined or confirmed in
+  };
+
     boost::random::mt19937 rnd_generator_; //!< Random number generator used by createProbRoadmapGraph to sample graph keypoints.
+
+    std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > samples_; //!< Persistent keypoints (global frame) if hcp.roadmap_graph_reuse is enabled
+    unsigned int halton_index_; //!< Index of the next element of the Halton sequence
+    std::vector<EdgeState> edge_cache_; //!< Collision state of the edges between persistent keypoints (samples_.size() x samples_.size(), upper triangle)
+    double roadmap_dist_to_obst_; //!< Distance to obstacles the edge cache refers to
+
+    std::vector<std::size_t> obstacle_keys_; //!< Key of each obstacle of the current cycle
+    std::unordered_set<std::size_t> current_obstacle_keys_; //!< Keys of all obstacles of the current cycle
+    std::unordered_set<std::size_t> previous_obstacle_keys_; //!< Keys of all obstacles of the previous cycle
+    ObstContainer added_obstacles_; //!< Obstacles that appeared since the previous cycle
+    std::vector<std::size_t> added_obstacle_keys_; //!< Keys of added_obstacles_
+    ObstacleGrid added_obstacle_grid_; //!< Spatial index of added_obstacles_
+    unsigned int cycle_; //!< Counts the calls of updateObstacleSnapshot(), added_obstacles_ refers to the changes since cycle_-1
+    std::atomic<bool> clear_cache_; //!< Set by clearCache() in order to drop the persistent data in the next createGraph() call
+
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
 } // end namespace
 
@@ -46,16 +46,174 @@
 #include <teb_local_planner/timed_elastic_band.h>
 
 #include <ros/ros.h>
+#include <boost/optional.hpp>
 #include <math.h>
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <vector>
 #include <iterator>
+#include <limits>
+#include <unordered_map>
+#include <utility>
 
 
 namespace teb_local_planner
 {
 
+//! Abbrev. for a path (polyline) in x-y-t used for caching h-signatures (t=0 for the 2d h-signature)
+typedef std::vector< Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> > HSignaturePath;
+
+/**
+ * @brief Contribution of a single obstacle to an h-signature
+ *
+ * Contributions are stored along with the obstacle configuration and the distance to the path at the time they were computed.
+ * They can be reused for the same trajectory in the next planning cycle as long as neither the obstacle nor the trajectory
+ * moved significantly compared to their distance (see hcp.h_signature_cache_tolerance).
+ * @tparam ValueType type of the contribution value
+ */
+template <typename ValueType>
+struct HSignatureContribution
+{
+  Eigen::Vector2d obst_start; //!< Obstacle centroid when the contribution was computed
+  Eigen::Vector2d obst_end; //!< Predicted obstacle centroid at the end of the time horizon (equals obst_start for the 2d h-signature)
+  ValueType value; //!< Contribution to the h-signature
+  double min_dist; //!< Minimum distance between obstacle and path when the contribution was computed
+  double path_drift; //!< Accumulated displacement of the path since the contribution was computed
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/**
+ * @brief Compute the (symmetric) Hausdorff distance between two polylines based on their vertices
+ * @param path1 first polyline
+ * @param path2 second polyline
+ * @return Hausdorff distance (infinity if one of the paths is empty)
+ */
+inline double polylineHausdorffDistance(const HSignaturePath& path1, const HSignaturePath& path2)
+{
+  if (path1.empty() || path2.empty())
+    return std::numeric_limits<double>::infinity();
+
+  auto directed = [](const HSignaturePath& from, const HSignaturePath& to)
+  {
+    double max_dist = 0;
+    for (const Eigen::Vector3d& point : from)
+    {
+      double dist = (point - to.front()).norm();
+      for (std::size_t i = 1; i < to.size(); ++i)
+        dist = std::min(dist, calc_distance_point_to_segment(point, to[i-1], to[i]));
+      max_dist = std::max(max_dist, dist);
+    }
+    return max_dist;
+  };
+  return std::max(directed(path1, path2), directed(path2, path1));
+}
+
+/**
+ * @class HSignatureContributionIndex
+ * @brief Spatial hash of the contributions computed in the previous planning cycle
+ *
+ * The contributions are bucketed by the grid cell of their obstacle centroid, so a lookup only inspects
+ * the cached contributions of the 3x3 neighboring cells instead of all of them.
+ * Contributions of obstacles that moved by more than the cell size are not found and hence recomputed.
+ * @tparam ValueType type of the contribution value
+ */
+template <typename ValueType>
+class HSignatureContributionIndex
+{
+public:
+  //! Abbrev. for the cached contributions
+  typedef std::vector< HSignatureContribution<ValueType>, Eigen::aligned_allocator< HSignatureContribution<ValueType> > > Contributions;
+
+  /**
+   * @brief Build the index
+   * @param cache contributions computed in the previous planning cycle (must outlive the index)
+   * @param cell_size edge length of the grid cells [m]
+   */
+  HSignatureContributionIndex(const Contributions& cache, double cell_size = 0.25) : cache_(cache), cell_size_(cell_size)
+  {
+    std::vector< std::pair<std::uint64_t, int> > keys;
+    keys.reserve(cache.size());
+    for (int i = 0; i < (int)cache.size(); ++i)
+    {
+      if (cache[i].obst_start.allFinite())
+        keys.push_back(std::make_pair(cellKey(cellCoord(cache[i].obst_start.x()), cellCoord(cache[i].obst_start.y())), i));
+    }
+    std::sort(keys.begin(), keys.end());
+
+    indices_.resize(keys.size());
+    cells_.reserve(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+      indices_[i] = keys[i].second;
+      std::pair<int, int>& range = cells_.insert(std::make_pair(keys[i].first, std::make_pair((int)i, (int)i))).first->second;
+      range.second = (int)i + 1;
+    }
+  }
+
+  /**
+   * @brief Find a cached contribution that can be reused for an obstacle
+   * @param obst_start current obstacle centroid
+   * @param obst_end current predicted obstacle centroid at the end of the time horizon
+   * @param path_drift displacement of the path since the previous planning cycle
+   * @param tolerance relative tolerance: the accumulated displacement of obstacle and path must not exceed tolerance * min_dist
+   * @return index of the contribution in the cache or -1 if none can be reused
+   */
+  int find(const Eigen::Vector2d& obst_start, const Eigen::Vector2d& obst_end, double path_drift, double tolerance) const
+  {
+    if (!obst_start.allFinite())
+      return -1;
+
+    int best_idx = -1;
+    double best_change = std::numeric_limits<double>::infinity();
+    std::int32_t cx = cellCoord(obst_start.x());
+    std::int32_t cy = cellCoord(obst_start.y());
+    for (std::int32_t dx = -1; dx <= 1; ++dx)
+    {
+      for (std::int32_t dy = -1; dy <= 1; ++dy)
+      {
+        auto cell = cells_.find(cellKey(cx + dx, cy + dy));
+        if (cell == cells_.end())
+          continue;
+
+        for (int k = cell->second.first; k < cell->second.second; ++k)
+        {
+          int i = indices_[k];
+          double change = std::max((cache_[i].obst_start - obst_start).norm(), (cache_[i].obst_end - obst_end).norm()) + cache_[i].path_drift + path_drift;
+          // ties are resolved by the index in order to be independent of the hash order
+          if (std::isfinite(change) && (change < best_change || (change == best_change && i < best_idx)) && change <= tolerance * cache_[i].min_dist)
+          {
+            best_change = change;
+            best_idx = i;
+          }
+        }
+      }
+    }
+    return best_idx;
+  }
+
+private:
+
+  //! Grid coordinate of a position (clamped in order to keep the conversion defined)
+  std::int32_t cellCoord(double pos) const
+  {
+    return (std::int32_t) std::max(-1e9, std::min(1e9, std::floor(pos / cell_size_)));
+  }
+
+  //! Hash key of a grid cell
+  static std::uint64_t cellKey(std::int32_t cx, std::int32_t cy)
+  {
+    return ((std::uint64_t)(std::uint32_t)cx << 32) | (std::uint64_t)(std::uint32_t)cy;
+  }
+
+  const Contributions& cache_; //!< Contributions of the previous cycle
+  double cell_size_; //!< Edge length of the grid cells [m]
+  std::vector<int> indices_; //!< Indices into cache_ sorted by cell
+  std::unordered_map< std::uint64_t, std::pair<int, int> > cells_; //!< Range in indices_ per occupied cell
+};
+
+
 /**
  * @brief The H-signature defines an equivalence relation based on homology in terms of complex calculus.
  *
@@ -90,12 +248,16 @@ public:
     * @param path_end Iterator to the last element in the path
     * @param obstacles obstacle container
     * @param fun_cplx_point function accepting the dereference iterator type and that returns the position as complex number.
+    * @param previous h-signature of the same trajectory in the previous planning cycle (optional): obstacle contributions are reused if possible
     * @tparam BidirIter Bidirectional iterator type
     * @tparam Fun function of the form std::complex< long double > (const T& point_type)
     */
     template<typename BidirIter, typename Fun>
-    void calculateHSignature(BidirIter path_start, BidirIter path_end, Fun fun_cplx_point, const ObstContainer* obstacles)
+    void calculateHSignature(BidirIter path_start, BidirIter path_end, Fun fun_cplx_point, const ObstContainer* obstacles, const HSignature* previous = NULL)
     {
+        contributions_.clear();
+        path_.clear();
+
         if (obstacles->empty())
         {
             hsignature_ = std::complex<double>(0,0);
@@ -135,36 +297,52 @@ public:
             map_top_right = start + delta + normal;
         }
 
-        hsignature_ = 0; // reset local signature
+        // collect path points
+        for (BidirIter path_iter = path_start; path_iter != path_end; ++path_iter)
+        {
+            cplx z = fun_cplx_point(*path_iter);
+            path_.push_back(Eigen::Vector3d(z.real(), z.imag(), 0));
+        }
+        path_.push_back(Eigen::Vector3d(end.real(), end.imag(), 0));
+
+        // reuse contributions of the previous cycle if neither the obstacle nor the path changed significantly
+        double tolerance = cfg_->hcp.h_signature_cache_tolerance;
+        double path_drift = (previous && tolerance > 0) ? polylineHausdorffDistance(path_, previous->path_) : 0;
 
+        contributions_.resize(obstacles->size());
         std::vector<double> imag_proposals(5);
 
-        // iterate path
-        while(path_start != path_end)
+        boost::optional< HSignatureContributionIndex<cplx> > cache_index;
+        if (previous && tolerance > 0)
+            cache_index.emplace(previous->contributions_);
+
+        for (std::size_t l=0; l<obstacles->size(); ++l) // iterate all obstacles
         {
-            cplx z1 = fun_cplx_point(*path_start);
-            cplx z2 = fun_cplx_point(*std::next(path_start));
+            const Eigen::Vector2d& obst_pos = obstacles->at(l)->getCentroid();
+            HSignatureContribution<cplx>& contribution = contributions_[l];
+
+            int cache_idx = cache_index ? cache_index->find(obst_pos, obst_pos, path_drift, tolerance) : -1;
+            if (cache_idx >= 0)
+            {
+                contribution = previous->contributions_[cache_idx];
+                contribution.path_drift += path_drift;
+                continue;
+            }
+
+            cplx obst_l(obst_pos.x(), obst_pos.y());
+            contribution.obst_start = obst_pos;
+            contribution.obst_end = obst_pos;
+            contribution.value = 0;
+            contribution.min_dist = std::numeric_limits<double>::infinity();
+            contribution.path_drift = 0;
 
-            for (std::size_t l=0; l<obstacles->size(); ++l) // iterate all obstacles
+            // iterate path
+            for (std::size_t k=0; k+1<path_.size(); ++k)
             {
-                cplx obst_l = obstacles->at(l)->getCentroidCplx();
-                //cplx f0 = (long double) prescaler * std::pow(obst_l-map_bottom_left,a) * std::pow(obst_l-map_top_right,b);
-                cplx f0 = (long double) cfg_->hcp.h_signature_prescaler * (long double)a*(obst_l-map_bottom_left) * (long double)b*(obst_l-map_top_right);
-
-                // denum contains product with all obstacles exepct j==l
-                cplx Al = f0;
-                for (std::size_t j=0; j<obstacles->size(); ++j)
-                {
-                    if (j==l)
-                        continue;
-                    cplx obst_j = obstacles->at(j)->getCentroidCplx();
-                    cplx diff = obst_l - obst_j;
-                    //if (diff.real()!=0 || diff.imag()!=0)
-                    if (std::abs(diff)<0.05) // skip really close obstacles
-                        continue;
-                     else
-                        Al /= diff;
-                }
+                cplx z1(path_[k].x(), path_[k].y());
+                cplx z2(path_[k+1].x(), path_[k+1].y());
+                contribution.min_dist = std::min(contribution.min_dist, distance_point_to_segment_2d(obst_pos, path_[k].head<2>(), path_[k+1].head<2>()));
+
                 // compute log value
                 double diff2 = std::abs(z2-obst_l);
                 double diff1 = std::abs(z1-obst_l);
@@ -181,9 +359,34 @@ public:
                 double log_imag = *std::min_element(imag_proposals.begin(),imag_proposals.end(),smaller_than_abs);
                 cplx log_value(log_real,log_imag);
                 //cplx log_value = std::log(z2-obst_l)-std::log(z1-obst_l); // the principal solution doesn't seem to work
-                hsignature_ += Al*log_value;
+                contribution.value += log_value;
             }
-            ++path_start;
+        }
+
+        hsignature_ = 0; // reset local signature
+
+        // weight the contributions (depends on the complete obstacle configuration)
+        for (std::size_t l=0; l<obstacles->size(); ++l) // iterate all obstacles
+        {
+            cplx obst_l = obstacles->at(l)->getCentroidCplx();
+            //cplx f0 = (long double) prescaler * std::pow(obst_l-map_bottom_left,a) * std::pow(obst_l-map_top_right,b);
+            cplx f0 = (long double) cfg_->hcp.h_signature_prescaler * (long double)a*(obst_l-map_bottom_left) * (long double)b*(obst_l-map_top_right);
+
+            // denum contains product with all obstacles exepct j==l
+            cplx Al = f0;
+            for (std::size_t j=0; j<obstacles->size(); ++j)
+            {
+                if (j==l)
+                    continue;
+                cplx obst_j = obstacles->at(j)->getCentroidCplx();
+                cplx diff = obst_l - obst_j;
+                //if (diff.real()!=0 || diff.imag()!=0)
+                if (std::abs(diff)<0.05) // skip really close obstacles
+                    continue;
+                 else
+                    Al /= diff;
+            }
+            hsignature_ += Al*contributions_[l].value;
         }
     }
 
@@ -237,6 +440,9 @@ private:
 
     const TebConfig* cfg_;
     std::complex<long double> hsignature_;
+
+    HSignaturePath path_; //!< Path the h-signature was computed for
+    std::vector< HSignatureContribution< std::complex<long double> >, Eigen::aligned_allocator< HSignatureContribution< std::complex<long double> > > > contributions_; //!< Path integral per obstacle (before weighting)
 };
 
 
@@ -275,75 +481,92 @@ public:
     * @param path_end Iterator to the last element in the path
     * @param obstacles obstacle container
     * @param fun_cplx_point function accepting the dereference iterator type and that returns the position as complex number.
+    * @param timediff_start Iterator to the first time difference of the path (optional, otherwise the time is approximated using max_vel_x)
+    * @param timediff_end Iterator to the last time difference of the path (optional)
+    * @param previous h-signature of the same trajectory in the previous planning cycle (optional): obstacle contributions are reused if possible
     * @tparam BidirIter Bidirectional iterator type
     * @tparam Fun function of the form std::complex< long double > (const T& point_type)
     */
     template<typename BidirIter, typename Fun>
     void calculateHSignature(BidirIter path_start, BidirIter path_end, Fun fun_cplx_point, const ObstContainer* obstacles,
-                             boost::optional<TimeDiffSequence::iterator> timediff_start, boost::optional<TimeDiffSequence::iterator> timediff_end)
+                             boost::optional<TimeDiffSequence::iterator> timediff_start, boost::optional<TimeDiffSequence::iterator> timediff_end,
+                             const HSignature3d* previous = NULL)
     {
       hsignature3d_.resize(obstacles->size());
+      contributions_.resize(obstacles->size());
+      path_.clear();
 
       std::advance(path_end, -1); // reduce path_end by 1 (since we check line segments between those path points)
 
-      constexpr int num_int_steps_per_segment = 10;
+      bool time_available = timediff_start != boost::none && timediff_end != boost::none;
+      if (time_available && std::distance(path_start, path_end) != std::distance(timediff_start.get(), timediff_end.get()))
+        ROS_ERROR("Size of poses and timediff vectors does not match. This is a bug.");
+
+      // Collect the path segments (x-y-t) once, they are shared by all obstacles
+      Segments segments;
+      double transition_time = 0;
+      double next_transition_time = 0;
+      TimeDiffSequence::iterator timediff_iter;
+      if (time_available)
+        timediff_iter = timediff_start.get();
+      for (BidirIter path_iter = path_start; path_iter != path_end; ++path_iter)
+      {
+        std::complex<long double> z1 = fun_cplx_point(*path_iter);
+        std::complex<long double> z2 = fun_cplx_point(*std::next(path_iter));
+
+        transition_time = next_transition_time;
+        if (!time_available) // if no time information is provided yet, approximate transition time
+          next_transition_time += std::abs(z2 - z1) / cfg_->robot.max_vel_x; // Approximate the time, if no time is known
+        else // otherwise use the time information from the teb trajectory
+          next_transition_time += (*timediff_iter++)->dt();
 
-      for (std::size_t l = 0; l < obstacles->size(); ++l) // iterate all obstacles
+        Eigen::Vector3d direction_vec(z2.real() - z1.real(), z2.imag() - z1.imag(), next_transition_time - transition_time);
+        if(direction_vec.norm() < 1e-15)  // Coincident poses
+          continue;
+
+        segments.start.push_back(Eigen::Vector3d(z1.real(), z1.imag(), transition_time));
+        segments.direction.push_back(direction_vec);
+      }
+
+      if (!segments.start.empty())
       {
-        double H = 0;
-        double transition_time = 0;
-        double next_transition_time = 0;
-        BidirIter path_iter;
-        TimeDiffSequence::iterator timediff_iter;
-
-        Eigen::Vector3d s1 (obstacles->at(l)->getCentroid()(0), obstacles->at(l)->getCentroid()(1), 0);
-        double t = 120; // some large value for defining the end point of the obstacle/"conductor" model
-        Eigen::Vector3d s2;
-        obstacles->at(l)->predictCentroidConstantVelocity(t, s2.head(2));
-        s2[2] = t;
-        Eigen::Vector3d ds = s2 - s1;
-        double ds_sq_norm = ds.squaredNorm(); // by definition not zero as t > 0 (3rd component)
-
-        // iterate path
-        for (path_iter = path_start, timediff_iter = timediff_start.get(); path_iter != path_end; ++path_iter, ++timediff_iter)
-        {
-          std::complex<long double> z1 = fun_cplx_point(*path_iter);
-          std::complex<long double> z2 = fun_cplx_point(*std::next(path_iter));
+        path_.assign(segments.start.begin(), segments.start.end());
+        path_.push_back(segments.start.back() + segments.direction.back());
+      }
 
-          transition_time = next_transition_time;
-          if (timediff_start == boost::none || timediff_end == boost::none) // if no time information is provided yet, approximate transition time
-            next_transition_time += std::abs(z2 - z1) / cfg_->robot.max_vel_x; // Approximate the time, if no time is known
-          else // otherwise use the time information from the teb trajectory
-          {
-            if (std::distance(path_iter, path_end) != std::distance(timediff_iter, timediff_end.get()))
-              ROS_ERROR("Size of poses and timediff vectors does not match. This is a bug.");
-            next_transition_time += (*timediff_iter)->dt();
-          }
+      // reuse contributions of the previous cycle if neither the obstacle nor the path changed significantly
+      const double t_end = 120; // some large value for defining the end point of the obstacle/"conductor" model
+      double tolerance = cfg_->hcp.h_signature_cache_tolerance;
+      double path_drift = (previous && tolerance > 0) ? polylineHausdorffDistance(path_, previous->path_) : 0;
 
-          Eigen::Vector3d direction_vec;
-          direction_vec[0] = z2.real() - z1.real();
-          direction_vec[1] = z2.imag() - z1.imag();
-          direction_vec[2] = next_transition_time - transition_time;
+      boost::optional< HSignatureContributionIndex<double> > cache_index;
+      if (previous && tolerance > 0)
+        cache_index.emplace(previous->contributions_);
 
-          if(direction_vec.norm() < 1e-15)  // Coincident poses
-            continue;
+      std::vector<int> recompute;
+      recompute.reserve(obstacles->size());
+      for (std::size_t l = 0; l < obstacles->size(); ++l)
+      {
+        Eigen::Vector2d obst_start = obstacles->at(l)->getCentroid();
+        Eigen::Vector2d obst_end;
+        obstacles->at(l)->predictCentroidConstantVelocity(t_end, obst_end);
 
-          Eigen::Vector3d r(z1.real(), z1.imag(), transition_time);
-          Eigen::Vector3d dl = 1.0/static_cast<double>(num_int_steps_per_segment) * direction_vec; // Integrate with multiple steps between each pose
-          Eigen::Vector3d p1, p2, d, phi;
-          for (int i = 0; i < num_int_steps_per_segment; ++i, r += dl)
-          {
-            p1 = s1 - r;
-            p2 = s2 - r;
-            d = (ds.cross(p1.cross(p2))) / ds_sq_norm;
-            phi = 1.0 / d.squaredNorm() * ((d.cross(p2) / p2.norm()) - (d.cross(p1) / p1.norm()));
-            H += phi.dot(dl);
-          }
+        int cache_idx = cache_index ? cache_index->find(obst_start, obst_end, path_drift, tolerance) : -1;
+        if (cache_idx >= 0)
+        {
+          contributions_[l] = previous->contributions_[cache_idx];
+          contributions_[l].path_drift += path_drift;
+          hsignature3d_[l] = contributions_[l].value;
+          continue;
         }
 
-        // normalize to 1
-        hsignature3d_.at(l) = H/(4.0*M_PI);
+        contributions_[l].obst_start = obst_start;
+        contributions_[l].obst_end = obst_end;
+        contributions_[l].path_drift = 0;
+        recompute.push_back((int)l);
       }
+
+      integrate(segments, recompute, t_end);
     }
 
     /**
@@ -417,8 +640,122 @@ public:
      const std::vector<double>& values() const {return hsignature3d_;}
 
 private:
+
+    //! Path segments in x-y-t
+    struct Segments
+    {
+      std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> > start; //!< Start point of each segment
+      std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> > direction; //!< Vector from the start to the end point of each segment
+    };
+
+   /**
+    * @brief Integrate the Biot-Savart like field of the selected obstacles along the path
+    *
+    * Each obstacle is modeled as a straight "conductor" from its current centroid to its predicted centroid at a large time.
+    * The integrand is evaluated for all selected obstacles at once (structure of arrays, vectorized by Eigen).
+    * Each segment is integrated with hcp.h_signature_int_steps steps. If hcp.h_signature_adaptive_int_steps is enabled,
+    * segments that are far away from every obstacle (compared to their length) are integrated with fewer steps.
+    * The results are written to hsignature3d_ and contributions_ (obst_start and obst_end must be set already).
+    * @param segments path segments
+    * @param indices indices of the obstacles to be integrated
+    * @param t_end time of the end point of the "conductor" model
+    */
+    void integrate(const Segments& segments, const std::vector<int>& indices, double t_end)
+    {
+      const int num_obst = (int)indices.size();
+      if (num_obst == 0)
+        return;
+
+      const int max_int_steps = std::max(1, cfg_->hcp.h_signature_int_steps);
+
+      // obstacle model in structure of arrays layout: s1 = (s1x, s1y, 0), s2 = (s2x, s2y, t_end)
+      Eigen::ArrayXd s1x(num_obst), s1y(num_obst), s2x(num_obst), s2y(num_obst);
+      for (int i = 0; i < num_obst; ++i)
+      {
+        const HSignatureContribution<double>& contribution = contributions_[indices[i]];
+        s1x[i] = contribution.obst_start.x();
+        s1y[i] = contribution.obst_start.y();
+        s2x[i] = contribution.obst_end.x();
+        s2y[i] = contribution.obst_end.y();
+      }
+      const Eigen::ArrayXd dsx = s2x - s1x;
+      const Eigen::ArrayXd dsy = s2y - s1y;
+      const double dsz = t_end;
+      const Eigen::ArrayXd inv_ds_sq_norm = (dsx.square() + dsy.square() + dsz*dsz).inverse(); // by definition not zero as t_end > 0
+
+      Eigen::ArrayXd H = Eigen::ArrayXd::Zero(num_obst);
+      Eigen::ArrayXd min_d_sq_norm = Eigen::ArrayXd::Constant(num_obst, std::numeric_limits<double>::infinity());
+      Eigen::ArrayXd p1x(num_obst), p1y(num_obst), p2x(num_obst), p2y(num_obst), inv_p1_norm(num_obst), inv_p2_norm(num_obst);
+      Eigen::ArrayXd cx(num_obst), cy(num_obst), cz(num_obst), dx(num_obst), dy(num_obst), dz(num_obst), d_sq_norm(num_obst);
+      Eigen::ArrayXd qx(num_obst), qy(num_obst), qz(num_obst);
+
+      // evaluate the integrand at r for all obstacles (q/|d|^2 is the field, d the orthogonal vector from the conductor to r)
+      auto evaluate = [&](const Eigen::Vector3d& r)
+      {
+        const double p1z = -r.z();
+        const double p2z = t_end - r.z();
+        p1x = s1x - r.x();
+        p1y = s1y - r.y();
+        p2x = s2x - r.x();
+        p2y = s2y - r.y();
+        inv_p1_norm = (p1x.square() + p1y.square() + p1z*p1z).sqrt().inverse();
+        inv_p2_norm = (p2x.square() + p2y.square() + p2z*p2z).sqrt().inverse();
+        // c = p1 x p2
+        cx = p1y*p2z - p1z*p2y;
+        cy = p1z*p2x - p1x*p2z;
+        cz = p1x*p2y - p1y*p2x;
+        // d = (ds x c) / |ds|^2
+        dx = (dsy*cz - dsz*cy) * inv_ds_sq_norm;
+        dy = (dsz*cx - dsx*cz) * inv_ds_sq_norm;
+        dz = (dsx*cy - dsy*cx) * inv_ds_sq_norm;
+        d_sq_norm = dx.square() + dy.square() + dz.square();
+        // q = d x p2 / |p2| - d x p1 / |p1|
+        qx = (dy*p2z - dz*p2y) * inv_p2_norm - (dy*p1z - dz*p1y) * inv_p1_norm;
+        qy = (dz*p2x - dx*p2z) * inv_p2_norm - (dz*p1x - dx*p1z) * inv_p1_norm;
+        qz = (dx*p2y - dy*p2x) * inv_p2_norm - (dx*p1y - dy*p1x) * inv_p1_norm;
+      };
+
+      for (std::size_t k = 0; k < segments.start.size(); ++k)
+      {
+        Eigen::Vector3d r = segments.start[k];
+        evaluate(r);
+
+        int num_int_steps = max_int_steps;
+        if (cfg_->hcp.h_signature_adaptive_int_steps)
+        {
+          // step length should not exceed half of the distance to the closest obstacle
+          double min_dist = std::sqrt(d_sq_norm.minCoeff());
+          double length = segments.direction[k].norm();
+          if (min_dist > 0)
+            num_int_steps = std::max(1, std::min(max_int_steps, (int)std::ceil(2.0 * length / min_dist)));
+        }
+
+        Eigen::Vector3d dl = 1.0/static_cast<double>(num_int_steps) * segments.direction[k]; // Integrate with multiple steps between each pose
+        for (int i = 0; i < num_int_steps; ++i)
+        {
+          if (i > 0)
+            evaluate(r);
+          H += (qx*dl.x() + qy*dl.y() + qz*dl.z()) / d_sq_norm;
+          min_d_sq_norm = min_d_sq_norm.min(d_sq_norm);
+          r += dl;
+        }
+      }
+
+      // normalize to 1
+      for (int i = 0; i < num_obst; ++i)
+      {
+        HSignatureContribution<double>& contribution = contributions_[indices[i]];
+        contribution.value = H[i]/(4.0*M_PI);
+        contribution.min_dist = std::sqrt(min_d_sq_norm[i]);
+        hsignature3d_[indices[i]] = contribution.value;
+      }
+    }
+
     const TebConfig* cfg_;
     std::vector<double> hsignature3d_;
+
+    HSignaturePath path_; //!< Path (x-y-t) the h-signature was computed for
+    std::vector< HSignatureContribution<double>, Eigen::aligned_allocator< HSignatureContribution<double> > > contributions_; //!< Contribution per obstacle (equals hsignature3d_)
 };
 
 
@@ -45,6 +45,7 @@
 #include <vector>
 #include <iterator>
 #include <random>
+#include <unordered_map>
 
 #include <boost/shared_ptr.hpp>
 
@@ -63,6 +64,7 @@
 #include <teb_local_planner/robot_footprint_model.h>
 #include <teb_local_planner/equivalence_relations.h>
 #include <teb_local_planner/graph_search.h>
+#include <teb_local_planner/worker_pool.h>
 
 
 namespace teb_local_planner
@@ -81,6 +83,12 @@ inline std::complex<long double> getCplxFromMsgPoseStamped(const geometry_msgs::
   return std::complex<long double>(pose.pose.position.x, pose.pose.position.y);
 };
 
+//!< Inline function used for initializing the TEB in combination with paths of an ExplorationJob
+inline const Eigen::Vector2d& getVector2dFromPoint(const Eigen::Vector2d& point)
+{
+  return point;
+};
+
 /**
  * @class HomotopyClassPlanner
  * @brief Local planner that explores alternative homotopy classes, create a plan for each alternative
@@ -335,11 +343,42 @@ public:
    * @brief Optimize all available trajectories by invoking the optimizer on each one.
    *
    * Depending on the configuration parameters, the optimization is performed either single or multi threaded.
+   * In the multi threaded case, each candidate is submitted to a persistent WorkerPool (see hcp.worker_pool_size and hcp.worker_cpu_affinity).
+   * The outer iterations are distributed among the candidates according to hcp.optimization_budget_policy:
+   * - \c uniform: each candidate receives \c iter_outerloop outer iterations.
+   * - \c successive_halving: the optimization proceeds in rounds, after each round only the better half of the candidates
+   *   is optimized further. The overall number of outer iterations does not exceed the uniform allocation.
+   *
+   * The resulting number of outer iterations per candidate can be accessed by getOuterIterations().
    * @param iter_innerloop Number of inner iterations (see TebOptimalPlanner::optimizeTEB())
    * @param iter_outerloop Number of outer iterations (see TebOptimalPlanner::optimizeTEB())
    */
   void optimizeAllTEBs(int iter_innerloop, int iter_outerloop);
 
+  /**
+   * @brief Continue the optimization of the candidates with the given number of outer iterations (a single round of optimizeAllTEBs()).
+   *
+   * The weight schedule continues from the outer iterations each candidate already received (stored in outer_iterations_), and the
+   * obstacle cost is rescaled such that the cost of candidates optimized with different numbers of outer iterations remain comparable.
+   * @param iter_innerloop Number of inner iterations (see TebOptimalPlanner::optimizeTEB())
+   * @param iter_outerloop Number of outer iterations of the uniform allocation (reference for the obstacle cost scaling)
+   * @param iterations Number of outer iterations for each element of tebs_ (0: skip)
+   */
+  void optimizeCandidates(int iter_innerloop, int iter_outerloop, const std::vector<int>& iterations);
+
+  /**
+   * @brief Determine the number of outer iterations of each candidate trajectory in the current cycle.
+   *
+   * If hcp.selection_lower_bound_pruning is enabled, the incumbents (the currently selected trajectory and the one related to the initial plan)
+   * are optimized first with \c iter_outerloop iterations. Candidates whose estimated cost lower bound (see TebOptimalPlanner::computeCostLowerBound())
+   * cannot beat the resulting costs (taking selection_cost_hysteresis and selection_prefer_initial_plan into account)
+   * receive only hcp.selection_pruned_outer_iterations outer iterations. All other candidates receive \c iter_outerloop iterations.
+   * @param iter_innerloop Number of inner iterations (see TebOptimalPlanner::optimizeTEB())
+   * @param iter_outerloop Number of outer iterations (see TebOptimalPlanner::optimizeTEB())
+   * @param[out] outer_iterations number of outer iterations for each element of tebs_ (including the ones already performed, see outer_iterations_)
+   */
+  void computeOuterIterations(int iter_innerloop, int iter_outerloop, std::vector<int>& outer_iterations);
+
   /**
    * @brief Returns a shared pointer to the TEB related to the initial plan
    * @return A non-empty shared ptr is returned if a match was found; Otherwise the shared ptr is empty.
@@ -362,7 +401,7 @@ public:
     *
     * Clear all previously found H-signatures, paths, tebs and the hcgraph.
     */
-  virtual void clearPlanner() {clearGraph(); equivalence_classes_.clear(); tebs_.clear(); initial_plan_ = NULL;}
+  virtual void clearPlanner() {clearGraph(); clearGraphCache(); equivalence_classes_.clear(); teb_eq_class_cache_.clear(); tebs_.clear(); initial_plan_ = NULL; ++exploration_generation_;}
 
 
   /**
@@ -384,13 +423,17 @@ public:
    * @param path_end Iterator to the last element in the path
    * @param obstacles obstacle container
    * @param fun_cplx_point function accepting the dereference iterator type and that returns the position as complex number.
+   * @param timediff_start Iterator to the first time difference of the path (optional)
+   * @param timediff_end Iterator to the last time difference of the path (optional)
+   * @param previous equivalence class of the same path in the previous planning cycle (optional): unchanged parts are reused (see hcp.h_signature_cache_tolerance)
    * @tparam BidirIter Bidirectional iterator type
    * @tparam Fun function of the form std::complex< long double > (const T& point_type)
    * @return pointer to the equivalence class base type
    */
   template<typename BidirIter, typename Fun>
   EquivalenceClassPtr calculateEquivalenceClass(BidirIter path_start, BidirIter path_end, Fun fun_cplx_point, const ObstContainer* obstacles = NULL,
-                                                boost::optional<TimeDiffSequence::iterator> timediff_start = boost::none, boost::optional<TimeDiffSequence::iterator> timediff_end = boost::none);
+                                                boost::optional<TimeDiffSequence::iterator> timediff_start = boost::none, boost::optional<TimeDiffSequence::iterator> timediff_end = boost::none,
+                                                const EquivalenceClassPtr& previous = EquivalenceClassPtr());
 
   /**
    * @brief Read-only access to the internal trajectory container.
@@ -398,8 +441,32 @@ public:
    */
   const TebOptPlannerContainer& getTrajectoryContainer() const {return tebs_;}
 
+  /**
+   * @brief Number of outer iterations each trajectory of the container received during the last optimization (see optimizeAllTEBs()).
+   * @return read-only reference to the iteration counts (same order as getTrajectoryContainer())
+   */
+  const std::vector<int>& getOuterIterations() const {return outer_iterations_;}
+
   bool hasDiverged() const override;
 
+  /**
+   * @brief Assign the predicted motion of dynamic obstacles to all (current and future) trajectory planners
+   * @param predictions obstacle predictions
+   */
+  virtual void setObstaclePredictions(const obstacle_prediction::ObstacleArray& predictions);
+
+  /**
+   * @brief Assign the global costmap to all (current and future) trajectory planners
+   * @param costmap global occupancy grid
+   */
+  virtual void setGlobalCostmap(const nav_msgs::OccupancyGrid& costmap);
+
+  /**
+   * @brief Total number of solver iterations of all trajectory planners created so far.
+   * @return accumulated solver iterations
+   */
+  virtual unsigned long getSolverIterations() const;
+
   /**
    * Compute and return the cost of the current optimization graph (supports multiple trajectories)
    * @param[out] cost current cost value for each trajectory
@@ -456,6 +523,13 @@ public:
    */
   const ObstContainer* obstacles() const {return obstacles_;}
 
+  /**
+   * @brief Access the obstacles that are considered for computing equivalence classes in the current planning cycle (read-only)
+   * @see updateHSignatureObstacles
+   * @return const reference to the reduced obstacle container
+   */
+  const ObstContainer& hSignatureObstacles() const {return hsignature_obstacles_;}
+
   /**
    * @brief Returns true if the planner is initialized
    */
@@ -466,6 +540,11 @@ public:
    */
   void clearGraph() {if(graph_search_) graph_search_->clearGraph();}
 
+  /**
+   * @brief Drop the data the graph searches keep across planning cycles (e.g. the roadmap edge cache)
+   */
+  void clearGraphCache() {if(graph_search_) graph_search_->clearCache(); if(async_graph_search_) async_graph_search_->clearCache();}
+
   /**
    * @brief find the index of the currently best TEB in the container
    * @remarks bestTeb() should be preferred whenever possible
@@ -531,6 +610,20 @@ protected:
    */
   void renewAndAnalyzeOldTebs(bool delete_detours);
 
+  /**
+   * @brief Update the set of obstacles that is relevant for distinguishing equivalence classes in the current planning cycle.
+   *
+   * Computing h-signatures scales with the number of obstacles (quadratically for HSignature), but most obstacles
+   * (e.g. the point obstacles obtained from the costmap) are irrelevant for distinguishing alternative trajectories. \n
+   * If hcp.h_signature_filter_obstacles is enabled, only obstacles within hcp.h_signature_corridor_width around the straight line
+   * from start to goal are kept and static point obstacles closer than hcp.h_signature_cluster_dist to each other are merged
+   * into a single representative point (the member closest to the cluster centroid). Dynamic obstacles are always kept. \n
+   * The result is shared by all equivalence class computations until the next call.
+   * @param start Current start pose
+   * @param goal Current goal pose
+   */
+  void updateHSignatureObstacles(const PoseSE2& start, const PoseSE2& goal);
+
   /**
    * @brief Associate trajectories with via-points
    *
@@ -541,6 +634,48 @@ protected:
    */
   void updateReferenceTrajectoryViaPoints(bool all_trajectories);
 
+  /**
+   * @brief Obtain a fresh TebOptimalPlanner for a new candidate.
+   *
+   * Constructing a TebOptimalPlanner is expensive (g2o optimizer, solver and ros subscribers).
+   * Therefore, all planners created by this class are kept in an internal pool: a pooled planner
+   * that is not referenced anymore by anyone else (e.g. after removing it from tebs_) is reset and reused.
+   * A new planner is only constructed if no pooled one is available.
+   * @param visualization Visualization instance passed to the planner
+   * @return Shared pointer to a planner with an empty trajectory
+   */
+  TebOptimalPlannerPtr acquireTeb(TebVisualizationPtr visualization);
+
+  /**
+   * @brief Initialize new TEBs from the paths found by asynchronous explorations that finished in the meantime.
+   *
+   * The first and last point of each path are replaced by the current start and goal.
+   * Paths that belong to known equivalence classes are rejected by addAndInitNewTeb().
+   * If no TEB exists afterwards, a straight line from start to goal is initialized.
+   * @param start Current start pose
+   * @param goal Current goal pose
+   * @param start_velocity start velocity (optional)
+   * @param free_goal_vel if \c true, a nonzero final velocity at the goal pose is allowed
+   */
+  void addExploredTebs(const PoseSE2& start, const PoseSE2& goal, const geometry_msgs::Twist* start_velocity, bool free_goal_vel);
+
+  /**
+   * @brief Start a new exploration on a snapshot of the current obstacles in the background (if none is pending).
+   *
+   * The exploration is performed by a single background thread using its own graph search instance (hcp.async_exploration).
+   * Results are collected by addExploredTebs() in a subsequent planning cycle.
+   * @param start Current start pose
+   * @param goal Current goal pose
+   * @param dist_to_obst Allowed distance to obstacles
+   */
+  void startAsyncExploration(const PoseSE2& start, const PoseSE2& goal, double dist_to_obst);
+
+  /**
+   * @brief Perform an exploration job (executed by the background thread)
+   * @param job exploration job
+   */
+  void runExploration(ExplorationJobPtr job);
+
   //@}
 
 
@@ -560,11 +695,27 @@ protected:
   TebOptimalPlannerPtr initial_plan_teb_; //!< Store pointer to the TEB related to the initial plan (use method getInitialPlanTEB() since it checks if initial_plan_teb_ is still included in tebs_.)
 
   TebOptPlannerContainer tebs_; //!< Container that stores multiple local teb planners (for alternative equivalence classes) and their corresponding costs
+  TebOptPlannerContainer teb_pool_; //!< All planners created so far; those that are not referenced elsewhere are recycled by acquireTeb()
+  boost::shared_ptr<const obstacle_prediction::ObstacleArray> obstacle_predictions_; //!< Explicitly assigned predictions passed to new planners (see setObstaclePredictions())
+  boost::shared_ptr<const nav_msgs::OccupancyGrid> global_costmap_; //!< Explicitly assigned costmap passed to new planners (see setGlobalCostmap())
+
+  std::unordered_map<const TebOptimalPlanner*, EquivalenceClassPtr> teb_eq_class_cache_; //!< Equivalence class of each teb computed most recently (reused partially in the next cycle)
+  ObstContainer hsignature_obstacles_; //!< Reduced obstacle set used for computing equivalence classes in the current cycle (see updateHSignatureObstacles())
 
   EquivalenceClassContainer equivalence_classes_; //!< Store all known quivalence classes (e.g. h-signatures) to allow checking for duplicates after finding and adding new ones.
                                                                             //   The second parameter denotes whether to exclude the class from detour deletion or not (true: force keeping).
 
   boost::shared_ptr<GraphSearchInterface> graph_search_;
+  WorkerPoolPtr worker_pool_; //!< Persistent worker threads for optimizing all candidates in parallel (created on first use)
+  std::vector<int> outer_iterations_; //!< Outer iterations each element of tebs_ received in the last call of optimizeAllTEBs()
+
+  boost::shared_ptr<GraphSearchInterface> async_graph_search_; //!< Graph search instance exclusively used by asynchronous explorations
+  std::vector<ExplorationJobPtr> finished_explorations_; //!< Finished explorations whose seeds are not yet processed (protected by exploration_mutex_)
+  bool exploration_running_; //!< True while an asynchronous exploration is pending (protected by exploration_mutex_)
+  unsigned int exploration_generation_; //!< Incremented by clearPlanner() in order to discard results of outdated explorations
+  HcGraph async_graph_; //!< Graph of the most recent asynchronous exploration (only stored if visualize_hc_graph is enabled)
+  boost::mutex exploration_mutex_; //!< Protects finished_explorations_ and exploration_running_
+  WorkerPoolPtr exploration_worker_; //!< Background thread for asynchronous explorations (created on first use)
 
   ros::Time last_eq_class_switching_time_; //!< Store the time at which the equivalence class changed recently
 
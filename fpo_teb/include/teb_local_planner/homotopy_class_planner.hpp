@@ -45,18 +45,19 @@ namespace teb_local_planner
   
 template<typename BidirIter, typename Fun>
 EquivalenceClassPtr HomotopyClassPlanner::calculateEquivalenceClass(BidirIter path_start, BidirIter path_end, Fun fun_cplx_point, const ObstContainer* obstacles,
-                                                                    boost::optional<TimeDiffSequence::iterator> timediff_start, boost::optional<TimeDiffSequence::iterator> timediff_end)
+                                                                    boost::optional<TimeDiffSequence::iterator> timediff_start, boost::optional<TimeDiffSequence::iterator> timediff_end,
+                                                                    const EquivalenceClassPtr& previous)
 {
   if(cfg_->obstacles.include_dynamic_obstacles)
   {
     HSignature3d* H = new HSignature3d(*cfg_);
-    H->calculateHSignature(path_start, path_end, fun_cplx_point, obstacles, timediff_start, timediff_end);
+    H->calculateHSignature(path_start, path_end, fun_cplx_point, obstacles, timediff_start, timediff_end, dynamic_cast<const HSignature3d*>(previous.get()));
     return EquivalenceClassPtr(H);
   }
   else
   {
     HSignature* H = new HSignature(*cfg_);
-    H->calculateHSignature(path_start, path_end, fun_cplx_point, obstacles);
+    H->calculateHSignature(path_start, path_end, fun_cplx_point, obstacles, dynamic_cast<const HSignature*>(previous.get()));
     return EquivalenceClassPtr(H);
   }
 }
@@ -65,7 +66,7 @@ EquivalenceClassPtr HomotopyClassPlanner::calculateEquivalenceClass(BidirIter pa
 template<typename BidirIter, typename Fun>
 TebOptimalPlannerPtr HomotopyClassPlanner::addAndInitNewTeb(BidirIter path_start, BidirIter path_end, Fun fun_position, double start_orientation, double goal_orientation, const geometry_msgs::Twist* start_velocity, bool free_goal_vel)
 {
-  TebOptimalPlannerPtr candidate = TebOptimalPlannerPtr( new TebOptimalPlanner(*cfg_, obstacles_, robot_model_));
+  TebOptimalPlannerPtr candidate = acquireTeb(TebVisualizationPtr());
 
   candidate->teb().initTrajectoryToGoal(path_start, path_end, fun_position, cfg_->robot.max_vel_x, cfg_->robot.max_vel_theta,
                                  cfg_->robot.acc_lim_x, cfg_->robot.acc_lim_theta, start_orientation, goal_orientation, cfg_->trajectory.min_samples,
@@ -74,7 +75,7 @@ TebOptimalPlannerPtr HomotopyClassPlanner::addAndInitNewTeb(BidirIter path_start
   if (start_velocity)
     candidate->setVelocityStart(*start_velocity);
 
-  EquivalenceClassPtr H = calculateEquivalenceClass(candidate->teb().poses().begin(), candidate->teb().poses().end(), getCplxFromVertexPosePtr, obstacles_,
+  EquivalenceClassPtr H = calculateEquivalenceClass(candidate->teb().poses().begin(), candidate->teb().poses().end(), getCplxFromVertexPosePtr, &hsignature_obstacles_,
                                                     candidate->teb().timediffs().begin(), candidate->teb().timediffs().end());
 
   
@@ -84,6 +85,7 @@ TebOptimalPlannerPtr HomotopyClassPlanner::addAndInitNewTeb(BidirIter path_start
   if(addEquivalenceClassIfNew(H))
   {
     tebs_.push_back(candidate);
+    teb_eq_class_cache_[candidate.get()] = H;
     return tebs_.back();
   }
 
@@ -0,0 +1,223 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#ifndef LATENCY_PROFILER_H_
+#define LATENCY_PROFILER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+
+namespace teb_local_planner
+{
+
+//! Stages of a planning cycle whose latency is recorded by the LatencyProfiler
+enum class LatencyStage
+{
+  Cycle, //!< Complete computeVelocityCommands() call
+  PrunePlan, //!< Pruning of the global plan
+  TransformPlan, //!< Transformation of the global plan to the planning frame
+  UpdateViaPoints, //!< Generation of via-points
+  UpdateObstacles, //!< Extraction of obstacles from the costmap/costmap_converter and custom obstacles
+  Plan, //!< Complete plan() call of the planner
+  Exploration, //!< Exploration of new homotopy classes
+  BuildGraphVertices, //!< Adding the trajectory vertices to the hyper-graph
+  BuildGraphObstacles, //!< Adding (dynamic) obstacle edges
+  BuildGraphViaPoints, //!< Adding via-point edges
+  BuildGraphVelocity, //!< Adding velocity edges
+  BuildGraphAcceleration, //!< Adding acceleration edges
+  BuildGraphTimeOptimal, //!< Adding time optimal edges
+  BuildGraphShortestPath, //!< Adding shortest path edges
+  BuildGraphKinematics, //!< Adding kinematic edges (diff-drive or carlike)
+  BuildGraphPreferRotDir, //!< Adding edges for the preferred rotation direction
+  BuildGraphVelocityObstacleRatio, //!< Adding velocity-obstacle-ratio edges
+  OptimizeGraph, //!< Solver iterations (inner loop)
+  ComputeCost, //!< Cost computation of a trajectory
+  FeasibilityCheck, //!< Feasibility check of the selected trajectory
+  Visualization, //!< Publishing of visualization and feedback messages
+  NumStages
+};
+
+//! Latency statistics of a single stage within an aggregation period
+struct StageStatistics
+{
+  LatencyStage stage; //!< Recorded stage
+  std::uint64_t count; //!< Number of samples
+  double mean; //!< Mean duration [s]
+  double median; //!< Median duration [s] (upper bound of the histogram bin)
+  double p90; //!< 90th percentile [s] (upper bound of the histogram bin)
+  double p99; //!< 99th percentile [s] (upper bound of the histogram bin)
+  double max; //!< Maximum duration [s]
+};
+
+
+/**
+ * @class LatencyProfiler
+ * @brief Collects the durations of the planning stages in per-thread histograms.
+ *
+ * Each thread records into its own set of log-scaled histograms (two bins per power of two, 1ns to ~4s),
+ * hence recording requires neither locks nor contended atomics. The histograms are registered once per thread
+ * and aggregated by getStatistics(), which reports the samples recorded since its previous call. \n
+ * Stages are usually recorded with the TEB_PROFILE_STAGE macro, which compiles to nothing if
+ * TEB_DISABLE_LATENCY_PROFILING is defined (cmake option TEB_LATENCY_PROFILING).
+ */
+class LatencyProfiler
+{
+public:
+
+  static const int NumBins = 64; //!< Number of histogram bins per stage
+
+  /**
+   * @brief Access the process-wide profiler instance
+   * @return profiler instance
+   */
+  static LatencyProfiler& instance();
+
+  /**
+   * @brief Record a duration for the calling thread
+   * @param stage recorded stage
+   * @param nanoseconds duration [ns]
+   */
+  void record(LatencyStage stage, std::uint64_t nanoseconds);
+
+  /**
+   * @brief Aggregate the histograms of all threads
+   *
+   * Only samples recorded since the previous call are taken into account. Stages without samples are omitted.
+   * @param[out] statistics statistics of each recorded stage
+   */
+  void getStatistics(std::vector<StageStatistics>& statistics);
+
+  /**
+   * @brief Get a printable name of a stage
+   * @param stage stage
+   * @return name of the stage
+   */
+  static const char* stageName(LatencyStage stage);
+
+  /**
+   * @brief Get the histogram bin of a duration
+   * @param nanoseconds duration [ns]
+   * @return bin index in [0, NumBins)
+   */
+  static int binIndex(std::uint64_t nanoseconds);
+
+  /**
+   * @brief Get the upper bound of a histogram bin
+   * @param bin bin index
+   * @return largest duration [ns] of the bin
+   */
+  static double binUpperBound(int bin);
+
+private:
+
+  static const int NumStages = static_cast<int>(LatencyStage::NumStages);
+
+  //! Histograms written by a single thread (the atomics only prevent torn reads by getStatistics())
+  struct ThreadHistograms
+  {
+    ThreadHistograms();
+
+    std::atomic<std::uint64_t> bins[NumStages][NumBins];
+    std::atomic<std::uint64_t> sum[NumStages]; //!< Sum of durations [ns]
+    std::atomic<std::uint64_t> max[NumStages]; //!< Maximum duration since the last getStatistics() call [ns]
+  };
+
+  LatencyProfiler() {}
+
+  /**
+   * @brief Get (and register on first use) the histograms of the calling thread
+   * @return histograms of the calling thread
+   */
+  ThreadHistograms& localHistograms();
+
+  boost::mutex mutex_; //!< Locks the registry and the previous totals (not used for recording)
+  std::vector<boost::shared_ptr<ThreadHistograms> > threads_; //!< Histograms of all threads (kept after a thread terminated)
+  std::vector<std::uint64_t> last_bins_; //!< Aggregated bin counts at the previous getStatistics() call
+  std::vector<std::uint64_t> last_sum_; //!< Aggregated sums at the previous getStatistics() call
+};
+
+
+/**
+ * @class ScopedStageTimer
+ * @brief Measures the lifetime of the object with a monotonic clock and records it in the LatencyProfiler.
+ */
+class ScopedStageTimer
+{
+public:
+  /**
+   * @brief Start the timer
+   * @param stage stage the measured duration is recorded for
+   */
+  explicit ScopedStageTimer(LatencyStage stage) : stage_(stage), start_(std::chrono::steady_clock::now()) {}
+
+  /**
+   * @brief Stop the timer and record the duration
+   */
+  ~ScopedStageTimer()
+  {
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start_;
+    LatencyProfiler::instance().record(stage_, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  }
+
+private:
+  LatencyStage stage_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace teb_local_planner
+
+
+#define TEB_PROFILE_CONCAT_IMPL(a, b) a##b
+#define TEB_PROFILE_CONCAT(a, b) TEB_PROFILE_CONCAT_IMPL(a, b)
+
+/**
+ * @brief Record the duration of the enclosing scope for the given stage (see LatencyProfiler)
+ */
+#ifndef TEB_DISABLE_LATENCY_PROFILING
+#define TEB_PROFILE_STAGE(stage) teb_local_planner::ScopedStageTimer TEB_PROFILE_CONCAT(teb_stage_timer_, __LINE__)(teb_local_planner::LatencyStage::stage)
+#else
+#define TEB_PROFILE_STAGE(stage) do {} while (0)
+#endif
+
+#endif /* LATENCY_PROFILER_H_ */
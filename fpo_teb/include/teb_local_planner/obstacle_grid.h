@@ -0,0 +1,142 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#ifndef OBSTACLE_GRID_H_
+#define OBSTACLE_GRID_H_
+
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <teb_local_planner/obstacles.h>
+
+
+namespace teb_local_planner
+{
+
+/**
+ * @class ObstacleGrid
+ * @brief Uniform grid over the bounding boxes of a set of obstacles for fast segment-vs-obstacle queries.
+ *
+ * The graph based exploration of homotopy classes tests each candidate edge against all obstacles.
+ * This index stores each obstacle (its bounding box inflated by a safety distance) in all grid cells it overlaps.
+ * A segment query only visits the cells traversed by the segment and performs the exact
+ * Obstacle::checkLineIntersection() test just for obstacles registered in those cells. \n
+ * Obstacle types with unknown extent are tested for each query.
+ * @remarks The index stores a pointer to the obstacle container, rebuild it whenever the container changes.
+ *          Queries are not thread-safe (they share an internal visitation buffer).
+ */
+class ObstacleGrid
+{
+public:
+
+  /**
+   * @brief Default constructor (empty index)
+   */
+  ObstacleGrid();
+
+  /**
+   * @brief (Re-)build the index for a set of obstacles
+   * @param obstacles obstacle container (might be NULL)
+   * @param inflation bounding boxes are inflated by this distance, queries with a larger \c min_dist fall back to testing all obstacles
+   * @param max_cells upper bound on the number of grid cells
+   */
+  void build(const ObstContainer* obstacles, double inflation, int max_cells = 4096);
+
+  /**
+   * @brief Clear the index
+   */
+  void clear();
+
+  /**
+   * @brief Check if a given line segment intersects with any obstacle (or violates the distance \c min_dist)
+   *
+   * Equivalent to calling Obstacle::checkLineIntersection() for all obstacles in the container.
+   * @param line_start start of the line segment
+   * @param line_end end of the line segment
+   * @param min_dist minimum distance allowed to the obstacles
+   * @param[out] obstacle_idx index of the (first found) colliding obstacle in the container (optional)
+   * @return \c true if the segment collides with at least one obstacle, \c false otherwise
+   */
+  bool checkLineIntersection(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, double min_dist, int* obstacle_idx = NULL) const;
+
+  /**
+   * @brief Compute the axis aligned bounding box of an obstacle
+   * @param obst obstacle
+   * @param[out] min lower left corner
+   * @param[out] max upper right corner
+   * @return \c false if the extent of the obstacle type is not known
+   */
+  static bool boundingBox(const Obstacle& obst, Eigen::Vector2d& min, Eigen::Vector2d& max);
+
+private:
+
+  /**
+   * @brief Test a single obstacle (each obstacle is tested at most once per query)
+   * @return \c true if the segment collides with the obstacle
+   */
+  bool testObstacle(int idx, const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, double min_dist) const;
+
+  /**
+   * @brief Clip a segment to the (closed) box [min, max] (Liang-Barsky)
+   * @return \c false if the segment does not touch the box
+   */
+  static bool clipSegment(const Eigen::Vector2d& min, const Eigen::Vector2d& max, Eigen::Vector2d& line_start, Eigen::Vector2d& line_end);
+
+  const ObstContainer* obstacles_; //!< Indexed obstacles
+  double inflation_; //!< Safety distance the bounding boxes are inflated with
+
+  Eigen::Vector2d origin_; //!< Lower left corner of the grid
+  double cell_size_; //!< Edge length of a (square) grid cell
+  int cols_; //!< Number of cells in x-direction
+  int rows_; //!< Number of cells in y-direction
+
+  std::vector<int> cell_start_; //!< Obstacles of cell i are stored in cell_items_[cell_start_[i]] ... cell_items_[cell_start_[i+1]-1]
+  std::vector<int> cell_items_; //!< Obstacle indices of all cells
+  std::vector<int> unbounded_; //!< Obstacles with unknown extent (tested for each query)
+  std::vector<Eigen::Vector4d, Eigen::aligned_allocator<Eigen::Vector4d> > boxes_; //!< Inflated bounding box (min_x, min_y, max_x, max_y) of each obstacle
+
+  mutable std::vector<unsigned int> visited_; //!< Query id of the last query that tested the obstacle
+  mutable unsigned int query_id_; //!< Id of the current query
+
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+} // namespace teb_local_planner
+
+#endif /* OBSTACLE_GRID_H_ */
@@ -135,6 +135,20 @@ public:
     */
   void initialize(const TebConfig& cfg, ObstContainer* obstacles = NULL, RobotFootprintModelPtr robot_model = boost::make_shared<PointRobotFootprint>(),
                   TebVisualizationPtr visual = TebVisualizationPtr(), const ViaPointContainer* via_points = NULL);
+
+  /**
+    * @brief Reset the planner for a new trajectory while keeping the optimizer and all allocated memory.
+    *
+    * The trajectory, the optimization graph, the cost and the start/goal velocities are cleared,
+    * the config and the g2o solver (see initOptimizer()) are kept. Use this method in order to recycle
+    * planner instances instead of constructing new ones (e.g. in the HomotopyClassPlanner).
+    * @param obstacles Container storing all relevant obstacles (see Obstacle)
+    * @param robot_model Shared pointer to the robot shape model used for optimization (optional)
+    * @param visual Shared pointer to the TebVisualization class (optional)
+    * @param via_points Container storing via-points (optional)
+    */
+  void reset(ObstContainer* obstacles = NULL, RobotFootprintModelPtr robot_model = boost::make_shared<PointRobotFootprint>(),
+             TebVisualizationPtr visual = TebVisualizationPtr(), const ViaPointContainer* via_points = NULL);
   
   /**
     * @param robot_model Shared pointer to the robot shape model used for optimization (optional)
@@ -236,10 +250,13 @@ public:
    * @param viapoint_cost_scale Specify extra scaling for via-point costs (only used if \c compute_cost_afterwards is true)
    * @param alternative_time_cost Replace the cost for the time optimal objective by the actual (weighted) transition time 
    *          (only used if \c compute_cost_afterwards is true).
+   * @param initial_weight_multiplier Scaling of the adapted weights (see weight_adapt_factor) in the first outer iteration.
+   *          Allows to continue the weight schedule of a previous call, e.g. if the outer loop is split into multiple calls.
    * @return \c true if the optimization terminates successfully, \c false otherwise
    */	  
   bool optimizeTEB(int iterations_innerloop, int iterations_outerloop, bool compute_cost_afterwards = false,
-                   double obst_cost_scale=1.0, double viapoint_cost_scale=1.0, bool alternative_time_cost=false);
+                   double obst_cost_scale=1.0, double viapoint_cost_scale=1.0, bool alternative_time_cost=false,
+                   double initial_weight_multiplier=1.0);
   
   //@}
   
@@ -289,6 +306,18 @@ public:
    */
   const ObstContainer& getObstVector() const {return *obstacles_;}
 
+  /**
+   * @brief Assign the predicted motion of dynamic obstacles (overrides the last /obst_arr message)
+   * @param predictions obstacle predictions
+   */
+  virtual void setObstaclePredictions(const obstacle_prediction::ObstacleArray& predictions) {obst_arr = predictions;}
+
+  /**
+   * @brief Assign the global costmap used for classifying static obstacles (overrides the last costmap message)
+   * @param costmap global occupancy grid
+   */
+  virtual void setGlobalCostmap(const nav_msgs::OccupancyGrid& costmap) {global_costmap = costmap;}
+
   //@}
   
   /** @name Take via-points into account */
@@ -399,6 +428,44 @@ public:
    * @brief Returns true if the planner has diverged.
    */
   bool hasDiverged() const override;
+
+  /**
+   * @brief Estimate the (relative) computational effort of the next optimizeTEB() call.
+   *
+   * The dominating part of the hyper-graph are the obstacle edges, hence the effort is approximated by
+   * the number of poses times the number of obstacles associated with each pose during the previous optimization.
+   * If the trajectory has not been optimized yet (or since the last reset()), two obstacles (left and right) are assumed per pose.
+   * The value is only intended for scheduling multiple planners (see HomotopyClassPlanner::optimizeAllTEBs()).
+   * @return estimated effort (arbitrary unit)
+   */
+  double estimateOptimizationEffort() const;
+
+  /**
+   * @brief Cheaply estimate a lower bound of the cost that the next optimizeTEB() call can achieve (see computeCurrentCost()).
+   *
+   * The time cost is estimated by driving the current path at maximum velocity. Poses that currently collide
+   * with a static obstacle contribute their obstacle penalty. Only the obstacles associated with each pose
+   * during the previous optimization are checked (none after reset()). All remaining cost terms are non-negative and omitted.
+   * @warning This is a heuristic, not a guaranteed bound: the optimization might shorten the path and push poses out of
+   *          collision, hence the achieved cost can fall below the estimate. It is only intended for reducing the effort spent on
+   *          candidates that are unlikely to beat the currently selected trajectory (see HomotopyClassPlanner::computeOuterIterations()).
+   * @param obst_cost_scale Specify extra scaling for obstacle costs
+   * @param alternative_time_cost Replace the cost for the time optimal objective by the actual (weighted) transition time
+   * @return estimated lower bound of the cost
+   */
+  double computeCostLowerBound(double obst_cost_scale=1.0, bool alternative_time_cost=false) const;
+
+  /**
+   * @brief Assign a cost value without optimizing the trajectory (e.g. infinity for a skipped candidate)
+   * @param cost cost value returned by getCurrentCost()
+   */
+  void setCurrentCost(double cost) {cost_ = cost;}
+
+  /**
+   * @brief Total number of solver iterations of all optimizeGraph() calls since construction.
+   * @return accumulated solver iterations
+   */
+  virtual unsigned long getSolverIterations() const {return solver_iterations_;}
 	
   /**
    * @brief Compute the cost vector of a given optimization problen (hyper-graph must exist).
@@ -639,6 +706,18 @@ protected:
    */
   void AddEdgesDynamicObstacles(double weight_multiplier=1.0);
 
+  /**
+   * @brief Calculate the distances between the robot model at the poses [first_pose, last_pose) and all obstacles
+   *
+   * The distances are evaluated per obstacle for all poses at once (see BaseRobotFootprintModel::calculateDistances()).
+   * @param first_pose Index of the first pose
+   * @param last_pose Index behind the last pose
+   * @param skip_dynamic Skip dynamic obstacles, their columns are set to infinity
+   * @return Distance of pose \c first_pose+i to obstacle \c j stored in row \c i and column \c j
+   *         (refers to a buffer that is reused by the next call)
+   */
+  Eigen::Map<Eigen::ArrayXXd> calculateObstacleDistances(int first_pose, int last_pose, bool skip_dynamic);
+
   /**
    * @brief Add all edges (local cost functions) for satisfying kinematic constraints of a differential drive robot
    * @warning do not combine with AddEdgesKinematicsCarlike()
@@ -693,6 +772,7 @@ protected:
   ObstContainer* obstacles_; //!< Store obstacles that are relevant for planning
   const ViaPointContainer* via_points_; //!< Store via points for planning
   std::vector<ObstContainer> obstacles_per_vertex_; //!< Store the obstacles associated with the n-1 initial vertices
+  std::vector<double> obstacle_distances_; //!< Buffer of calculateObstacleDistances() (keeps its capacity across buildGraph() calls)
   
   double cost_; //!< Store cost value of the current hyper-graph
   RotType prefer_rotdir_; //!< Store whether to prefer a specific initial rotation in optimization (might be activated in case the robot oscillates)
@@ -707,6 +787,7 @@ protected:
 
   bool initialized_; //!< Keeps track about the correct initialization of this class
   bool optimized_; //!< This variable is \c true as long as the last optimization has been completed successful
+  unsigned long solver_iterations_; //!< Accumulated number of solver iterations (see getSolverIterations())
   
   ros::Subscriber sub_obst;
   ros::Subscriber sub_costmap;
@@ -54,6 +54,8 @@
 #include <geometry_msgs/PoseArray.h>
 #include <geometry_msgs/PoseStamped.h>
 #include <geometry_msgs/TwistStamped.h>
+#include <nav_msgs/OccupancyGrid.h>
+#include <obstacle_prediction/ObstacleArray.h>
 
 
 namespace teb_local_planner
@@ -196,6 +198,34 @@ public:
    * @brief Returns true if the planner has diverged.
    */
   virtual bool hasDiverged() const = 0;
+
+  /**
+   * @brief Assign the predicted motion of dynamic obstacles.
+   *
+   * The predictions are usually received via the /obst_arr topic. Overwrite this method to
+   * provide them explicitly, e.g. if the planner is used without a ROS master (offline replay).
+   * @param predictions obstacle predictions
+   */
+  virtual void setObstaclePredictions(const obstacle_prediction::ObstacleArray& predictions)
+  {
+  }
+
+  /**
+   * @brief Assign the global costmap used for classifying static obstacles.
+   *
+   * The costmap is usually received via the global costmap topic. Overwrite this method to
+   * provide it explicitly, e.g. if the planner is used without a ROS master (offline replay).
+   * @param costmap global occupancy grid
+   */
+  virtual void setGlobalCostmap(const nav_msgs::OccupancyGrid& costmap)
+  {
+  }
+
+  /**
+   * @brief Total number of solver iterations performed by this planner since its construction.
+   * @return accumulated solver iterations (0 if not supported by the planner)
+   */
+  virtual unsigned long getSolverIterations() const {return 0;}
                 
 };
 
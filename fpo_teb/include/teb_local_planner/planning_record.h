@@ -0,0 +1,279 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#ifndef PLANNING_RECORD_H_
+#define PLANNING_RECORD_H_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// this package
+#include <teb_local_planner/teb_config.h>
+#include <teb_local_planner/obstacles.h>
+#include <teb_local_planner/robot_footprint_model.h>
+#include <teb_local_planner/optimal_planner.h>
+
+// messages
+#include <geometry_msgs/PoseStamped.h>
+#include <geometry_msgs/Twist.h>
+#include <nav_msgs/OccupancyGrid.h>
+#include <obstacle_prediction/ObstacleArray.h>
+
+
+namespace teb_local_planner
+{
+
+/**
+ * @brief Types of the records stored in a planning log.
+ *
+ * A planning log starts with the magic string "TEBLOG" and the format version (uint32),
+ * followed by an arbitrary sequence of records. Each record consists of its type (uint32), the size of
+ * the payload in bytes (uint32) and the payload itself. Numbers are stored in the byte order of the
+ * recording machine (little endian on all supported platforms). Readers skip records of unknown type,
+ * fields added to a record type later on are appended to its payload and are optional when decoding.
+ */
+enum class PlanningRecordType : std::uint32_t
+{
+  Config = 1, //!< TebConfig parameters as name/value pairs
+  Footprint = 2, //!< Robot footprint model
+  GlobalCostmap = 3, //!< Global occupancy grid that is used for classifying static obstacles
+  CycleInput = 4, //!< Inputs of a single planning cycle
+  CycleOutput = 5 //!< Results of a single planning cycle (follows the corresponding CycleInput record)
+};
+
+//! Inputs of the planner within a single planning cycle
+struct PlanningCycleInput
+{
+  double stamp = 0; //!< Time of the planning cycle [s]
+  std::vector<geometry_msgs::PoseStamped> plan; //!< Transformed global plan passed to the planner
+  geometry_msgs::Twist robot_vel; //!< Current velocity of the robot
+  bool free_goal_vel = false; //!< Whether the goal velocity was left undetermined
+  ObstContainer obstacles; //!< Obstacle container (static and dynamic obstacles)
+  ViaPointContainer via_points; //!< Via-points of the cycle
+  obstacle_prediction::ObstacleArray predictions; //!< Predicted motion of dynamic obstacles
+  std::uint64_t config_hash = 0; //!< Hash of the config used for planning (see computeConfigHash())
+};
+
+//! Results of the planner within a single planning cycle
+struct PlanningCycleOutput
+{
+  //! Pose of the planned trajectory
+  struct TrajectoryPose
+  {
+    double x; //!< x-coordinate [m]
+    double y; //!< y-coordinate [m]
+    double theta; //!< Orientation [rad]
+    double time_from_start; //!< Time at which the pose is reached [s]
+  };
+
+  double stamp = 0; //!< Time of the planning cycle [s], identical to the one of the inputs
+  bool success = false; //!< Return value of plan()
+  double cost = 0; //!< Cost of the selected trajectory
+  std::uint64_t solver_iterations = 0; //!< Solver iterations performed within the cycle
+  double prepare_time = 0; //!< Duration of the input preparation (pruning, transformation, obstacles) [s]
+  double plan_time = 0; //!< Duration of plan() [s]
+  std::vector<TrajectoryPose> trajectory; //!< Selected trajectory
+};
+
+
+/** @name Encode and decode record payloads */
+//@{
+
+//! Encode all parameters of the config. Decoding starts from the given config, parameters unknown to this version are skipped.
+void encodeConfig(const TebConfig& cfg, std::vector<std::uint8_t>& payload);
+bool decodeConfig(const std::uint8_t* data, std::size_t size, TebConfig& cfg); //!< @see encodeConfig
+
+//! Encode the footprint model. Decoding returns a null pointer for unknown or corrupted models.
+void encodeFootprint(const BaseRobotFootprintModel& robot_model, std::vector<std::uint8_t>& payload);
+RobotFootprintModelPtr decodeFootprint(const std::uint8_t* data, std::size_t size); //!< @see encodeFootprint
+
+//! Encode the global occupancy grid (ROS message serialization).
+void encodeGlobalCostmap(const nav_msgs::OccupancyGrid& costmap, std::vector<std::uint8_t>& payload);
+bool decodeGlobalCostmap(const std::uint8_t* data, std::size_t size, nav_msgs::OccupancyGrid& costmap); //!< @see encodeGlobalCostmap
+
+//! Encode the inputs of a planning cycle, obstacles are stored with their geometry and centroid velocity.
+void encodeCycleInput(const PlanningCycleInput& input, std::vector<std::uint8_t>& payload);
+bool decodeCycleInput(const std::uint8_t* data, std::size_t size, PlanningCycleInput& input); //!< @see encodeCycleInput
+
+//! Encode the results of a planning cycle.
+void encodeCycleOutput(const PlanningCycleOutput& output, std::vector<std::uint8_t>& payload);
+bool decodeCycleOutput(const std::uint8_t* data, std::size_t size, PlanningCycleOutput& output); //!< @see encodeCycleOutput
+
+/**
+ * @brief Append a record (header and payload) to a buffer, e.g. in order to write several records at once
+ * @param type type of the record
+ * @param payload encoded payload
+ * @param[in,out] buffer the record is appended to the end of the buffer
+ */
+void appendRecord(PlanningRecordType type, const std::vector<std::uint8_t>& payload, std::vector<std::uint8_t>& buffer);
+
+/**
+ * @brief Compute a hash of all config parameters that are stored by encodeConfig() (64 bit FNV-1a)
+ * @param cfg config
+ * @return hash value
+ */
+std::uint64_t computeConfigHash(const TebConfig& cfg);
+
+/**
+ * @brief Compute the hash of an encoded config, e.g. the payload of a Config record
+ *
+ * The result equals computeConfigHash(cfg) for the payload of encodeConfig(cfg), regardless of the
+ * parameters known to the version that decodes the payload.
+ * @param data encoded config
+ * @param size size of the encoded config in bytes
+ * @return hash value
+ */
+std::uint64_t computeConfigHash(const std::uint8_t* data, std::size_t size);
+
+//@}
+
+
+/**
+ * @class PlanningRecordWriter
+ * @brief Appends records to a planning log file.
+ */
+class PlanningRecordWriter
+{
+public:
+
+  /**
+   * @brief Create a new log file (an existing file is truncated) and write the file header
+   * @param filename path of the log file
+   * @return \c true if the file could be created
+   */
+  bool open(const std::string& filename);
+
+  /**
+   * @brief Check whether a log file is opened
+   */
+  bool isOpen() const {return file_.is_open();}
+
+  /**
+   * @brief Flush and close the log file
+   */
+  void close();
+
+  /**
+   * @brief Append a record
+   * @param type type of the record
+   * @param payload encoded payload (see encodeConfig(), encodeCycleInput(), ...)
+   * @return \c false if writing failed
+   */
+  bool write(PlanningRecordType type, const std::vector<std::uint8_t>& payload);
+
+  /**
+   * @brief Append records that are already framed by appendRecord()
+   * @param records sequence of records
+   * @return \c false if writing failed
+   */
+  bool writeRecords(const std::vector<std::uint8_t>& records);
+
+  /**
+   * @brief Flush buffered records to the file
+   */
+  void flush();
+
+private:
+  std::ofstream file_; //!< Opened log file
+};
+
+
+//! Single record of a planning log, the payload points into the memory of the reader
+struct PlanningRecordView
+{
+  PlanningRecordType type; //!< Type of the record
+  const std::uint8_t* data; //!< Payload
+  std::size_t size; //!< Size of the payload in bytes
+};
+
+/**
+ * @class PlanningRecordReader
+ * @brief Iterates the records of a planning log file.
+ *
+ * The file is memory mapped, hence opening is cheap even for large logs and records are decoded
+ * directly from the page cache. Logs that are still being recorded can be read up to the last complete record.
+ */
+class PlanningRecordReader
+{
+public:
+
+  PlanningRecordReader() = default;
+
+  /**
+   * @brief Destructor (unmaps the file)
+   */
+  ~PlanningRecordReader();
+
+  PlanningRecordReader(const PlanningRecordReader&) = delete;
+  PlanningRecordReader& operator=(const PlanningRecordReader&) = delete;
+
+  /**
+   * @brief Map a log file and check its header
+   * @param filename path of the log file
+   * @return \c true if the file is a planning log of a supported version
+   */
+  bool open(const std::string& filename);
+
+  /**
+   * @brief Get the next record
+   * @remarks A truncated record at the end of the file (e.g. recording was interrupted) is ignored.
+   * @param[out] record next record (valid as long as the reader is not re-opened, closed or destroyed)
+   * @return \c false if all records have been read
+   */
+  bool next(PlanningRecordView& record);
+
+  /**
+   * @brief Restart reading with the first record
+   */
+  void rewind();
+
+  /**
+   * @brief Unmap the log file (invalidates all records)
+   */
+  void close();
+
+private:
+  const std::uint8_t* data_ = nullptr; //!< Mapped content of the log file
+  std::size_t size_ = 0; //!< Size of the mapping in bytes
+  std::size_t offset_ = 0; //!< Read position in data_
+};
+
+} // namespace teb_local_planner
+
+#endif /* PLANNING_RECORD_H_ */
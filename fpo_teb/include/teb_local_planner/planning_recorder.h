@@ -0,0 +1,156 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#ifndef PLANNING_RECORDER_H_
+#define PLANNING_RECORDER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/lockfree/spsc_queue.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <teb_local_planner/planning_record.h>
+
+
+namespace teb_local_planner
+{
+
+/**
+ * @class PlanningRecorder
+ * @brief Appends planning records to a log file without blocking the control thread.
+ *
+ * The records are encoded by the caller into preallocated buffers, which are handed over to a writer thread
+ * through a lock-free single-producer/single-consumer queue. The writer thread appends them to the log
+ * and returns the buffers through a second queue, hence no allocation takes place once the buffers have grown to their
+ * working size. Global costmaps are large and immutable, hence only the message pointer is queued and the writer thread
+ * encodes them. If the writer cannot keep up and all buffers are in flight, records are dropped instead of waiting. \n
+ * All record*() methods must be called by the same thread (the producer).
+ */
+class PlanningRecorder
+{
+public:
+
+  /**
+   * @brief Default constructor (not recording)
+   */
+  PlanningRecorder();
+
+  /**
+   * @brief Destructor, writes all pending records
+   */
+  ~PlanningRecorder();
+
+  /**
+   * @brief Create the log file and start the writer thread
+   * @param filename path of the log file (an existing file is truncated)
+   * @param queue_size maximum number of records in flight
+   * @return \c true if the log file could be created
+   */
+  bool start(const std::string& filename, int queue_size);
+
+  /**
+   * @brief Write all pending records, stop the writer thread and close the log file
+   */
+  void stop();
+
+  /**
+   * @brief Check whether the recorder has been started
+   */
+  bool isRecording() const {return static_cast<bool>(writer_thread_);}
+
+  /** @name Queue records (return \c false if the record is dropped) */
+  //@{
+
+  bool recordConfig(const TebConfig& cfg);
+  bool recordFootprint(const BaseRobotFootprintModel& robot_model);
+  bool recordGlobalCostmap(const nav_msgs::OccupancyGrid::ConstPtr& costmap); //!< The message must not be modified afterwards
+  bool recordCycle(const PlanningCycleInput& input, const PlanningCycleOutput& output); //!< Both records are queued as a unit
+
+  //@}
+
+  /**
+   * @brief Number of records dropped since start() due to a full queue
+   */
+  std::uint64_t droppedRecords() const {return dropped_.load(std::memory_order_relaxed);}
+
+private:
+
+  typedef std::vector<std::uint8_t> Buffer;
+
+  //! Element of the queue to the writer thread
+  struct PendingRecord
+  {
+    Buffer* buffer; //!< Encoded records
+    nav_msgs::OccupancyGrid::ConstPtr costmap; //!< Global costmap to be encoded by the writer thread (written before the buffer)
+  };
+
+  /**
+   * @brief Get an empty buffer for the next record(s)
+   * @return buffer, or \c NULL if all buffers are in flight (record dropped)
+   */
+  Buffer* acquire();
+
+  /**
+   * @brief Hand a filled buffer over to the writer thread
+   * @param buffer buffer obtained from acquire()
+   * @param costmap optional global costmap that is encoded by the writer thread
+   */
+  void commit(Buffer* buffer, const nav_msgs::OccupancyGrid::ConstPtr& costmap = nav_msgs::OccupancyGrid::ConstPtr());
+
+  //! Main loop of the writer thread
+  void writeLoop();
+
+  std::vector<Buffer> buffers_; //!< Buffers owned by the recorder (queue_size elements)
+  boost::scoped_ptr< boost::lockfree::spsc_queue<PendingRecord> > pending_; //!< Filled buffers (producer -> writer thread)
+  boost::scoped_ptr< boost::lockfree::spsc_queue<Buffer*> > free_; //!< Written buffers (writer thread -> producer)
+  Buffer payload_; //!< Scratch buffer for encoding a single payload (producer only)
+
+  PlanningRecordWriter writer_; //!< Log file (writer thread only)
+  Buffer costmap_payload_; //!< Scratch buffer for encoding a costmap (writer thread only)
+  Buffer costmap_record_; //!< Scratch buffer for framing a costmap record (writer thread only)
+  boost::scoped_ptr<boost::thread> writer_thread_; //!< Writer thread
+  std::atomic<bool> stop_requested_; //!< Tells the writer thread to finish after writing all pending buffers
+  std::atomic<std::uint64_t> dropped_; //!< Number of dropped records
+};
+
+} // namespace teb_local_planner
+
+#endif /* PLANNING_RECORDER_H_ */
@@ -54,10 +54,14 @@
 #include <teb_local_planner/homotopy_class_planner.h>
 #include <teb_local_planner/visualization.h>
 #include <teb_local_planner/recovery_behaviors.h>
+#include <teb_local_planner/worker_pool.h>
+#include <teb_local_planner/planning_recorder.h>
 
 // message types
 #include <nav_msgs/Path.h>
 #include <nav_msgs/Odometry.h>
+#include <nav_msgs/OccupancyGrid.h>
+#include <obstacle_prediction/ObstacleArray.h>
 #include <geometry_msgs/PoseStamped.h>
 #include <visualization_msgs/MarkerArray.h>
 #include <visualization_msgs/Marker.h>
@@ -77,6 +81,7 @@
 #include <dynamic_reconfigure/server.h>
 
 // boost classes
+#include <chrono>
 #include <boost/bind.hpp>
 #include <boost/shared_ptr.hpp>
 
@@ -225,39 +230,75 @@ public:
   
 protected:
 
+  //! Inputs of a planning cycle that do not depend on the optimization (prepared ahead of time if pipeline_input_preparation is enabled)
+  struct PlanningInput
+  {
+    PlanningInput() : plan_valid(false), goal_idx(0), plan_version(0) {}
+
+    std::vector<geometry_msgs::PoseStamped> global_plan; //!< Pruned global plan (only used by the pipelined preparation)
+    std::vector<geometry_msgs::PoseStamped> transformed_plan; //!< Local portion of the global plan transformed to the planning frame
+    bool plan_valid; //!< \c false if the global plan could not be transformed
+    int goal_idx; //!< Index of the local goal in the global plan
+    geometry_msgs::TransformStamped tf_plan_to_global; //!< Transformation between the global plan and the global planning frame
+    ObstContainer obstacles; //!< Obstacles extracted from the costmap (or costmap_converter) and custom obstacles
+    ViaPointContainer via_points; //!< Via-points generated from the transformed plan
+    unsigned int plan_version; //!< Value of plan_version_ the input was prepared for
+    ros::Time stamp; //!< Time the costmap snapshot and the robot pose were taken (only used by the pipelined preparation)
+  };
+
   /**
-    * @brief Update internal obstacle vector based on occupied costmap cells
-    * @remarks All occupied cells will be added as point obstacles.
-    * @remarks All previous obstacles are cleared.
-    * @sa updateObstacleContainerWithCostmapConverter
-    * @todo Include temporal coherence among obstacle msgs (id vector)
-    * @todo Include properties for dynamic obstacles (e.g. using constant velocity model)
-    */
-  void updateObstacleContainerWithCostmap();
+   * @brief Prepare the inputs of a planning cycle: prune and transform the global plan, generate via-points and extract obstacles.
+   *
+   * The method only reads the given arguments, the tf buffer, the costmap_converter and the custom obstacles (locked),
+   * hence it can be executed concurrently to the optimization of the previous cycle.
+   * @param robot_pose Pose of the robot in the global frame
+   * @param costmap Costmap (or a snapshot of it) from which the obstacles are extracted
+   * @param[in,out] global_plan Global plan that is pruned
+   * @param[out] input Prepared inputs
+   */
+  void prepareInput(const geometry_msgs::PoseStamped& robot_pose, const costmap_2d::Costmap2D& costmap,
+                    std::vector<geometry_msgs::PoseStamped>& global_plan, PlanningInput& input);
+
+  /**
+   * @brief Update an obstacle vector based on occupied costmap cells
+   * @remarks All occupied cells will be added as point obstacles.
+   * @remarks Previous obstacles are NOT cleared.
+   * @sa updateObstacleContainerWithCostmapConverter
+   * @todo Include temporal coherence among obstacle msgs (id vector)
+   * @todo Include properties for dynamic obstacles (e.g. using constant velocity model)
+   * @param costmap Costmap from which the occupied cells are taken
+   * @param robot_pose Current robot pose (cells far behind the robot are ignored)
+   * @param[out] obstacles Obstacle container to which the obstacles are appended
+   */
+  void updateObstacleContainerWithCostmap(const costmap_2d::Costmap2D& costmap, const PoseSE2& robot_pose, ObstContainer& obstacles);
   
   /**
-   * @brief Update internal obstacle vector based on polygons provided by a costmap_converter plugin
+   * @brief Update an obstacle vector based on polygons provided by a costmap_converter plugin
    * @remarks Requires a loaded costmap_converter plugin.
-   * @remarks All previous obstacles are cleared.
+   * @remarks Previous obstacles are NOT cleared.
    * @sa updateObstacleContainerWithCostmap
+   * @param[out] obstacles Obstacle container to which the obstacles are appended
    */
-  void updateObstacleContainerWithCostmapConverter();
+  void updateObstacleContainerWithCostmapConverter(ObstContainer& obstacles);
   
   /**
-   * @brief Update internal obstacle vector based on custom messages received via subscriber
+   * @brief Update an obstacle vector based on custom messages received via subscriber
    * @remarks All previous obstacles are NOT cleared. Call this method after other update methods.
    * @sa updateObstacleContainerWithCostmap, updateObstacleContainerWithCostmapConverter
+   * @param[out] obstacles Obstacle container to which the obstacles are appended
    */
-  void updateObstacleContainerWithCustomObstacles();
+  void updateObstacleContainerWithCustomObstacles(ObstContainer& obstacles);
 
 
   /**
-   * @brief Update internal via-point container based on the current reference plan
+   * @brief Update a via-point container based on the current reference plan
    * @remarks All previous via-points will be cleared.
    * @param transformed_plan (local) portion of the global plan (which is already transformed to the planning frame)
    * @param min_separation minimum separation between two consecutive via-points
+   * @param[out] via_points Via-point container
    */
-  void updateViaPointsContainer(const std::vector<geometry_msgs::PoseStamped>& transformed_plan, double min_separation);
+  void updateViaPointsContainer(const std::vector<geometry_msgs::PoseStamped>& transformed_plan, double min_separation,
+                                ViaPointContainer& via_points);
   
   
   /**
@@ -282,6 +323,32 @@ protected:
     */
   void customViaPointsCB(const nav_msgs::Path::ConstPtr& via_points_msg);
 
+   /**
+    * @brief Callback for obstacle predictions (only subscribed while recording a planning log)
+    * @param predictions_msg pointer to the message containing the predicted obstacles
+    */
+  void recordPredictionsCB(const obstacle_prediction::ObstacleArray::ConstPtr& predictions_msg);
+
+   /**
+    * @brief Callback for the global costmap (only subscribed while recording a planning log)
+    * @param costmap_msg pointer to the global occupancy grid
+    */
+  void recordCostmapCB(const nav_msgs::OccupancyGrid::ConstPtr& costmap_msg);
+
+  /**
+   * @brief Queue the inputs and results of the current planning cycle for the planning log
+   *
+   * Config, footprint and costmap changes since the previous cycle are recorded beforehand.
+   * Encoding takes place in the calling thread, the file is written by the recorder's writer thread.
+   * @param transformed_plan plan passed to the planner
+   * @param success return value of plan()
+   * @param solver_iterations solver iterations within plan()
+   * @param prepare_time duration of the input preparation [s]
+   * @param plan_time duration of plan() [s]
+   */
+  void recordPlanningCycle(const std::vector<geometry_msgs::PoseStamped>& transformed_plan, bool success,
+                           unsigned long solver_iterations, double prepare_time, double plan_time);
+
    /**
     * @brief Prune global plan such that already passed poses are cut off
     * 
@@ -386,6 +453,13 @@ protected:
    * @param min_obst_dist desired distance to obstacles
    */
   void validateFootprints(double opt_inscribed_radius, double costmap_inscribed_radius, double min_obst_dist);
+
+  /**
+   * @brief Rasterize footprint_spec_ for the feasibility check if costmap_model_ is a FootprintCostmapModel
+   *
+   * Nothing is done if the cache already matches the footprint and the costmap geometry.
+   */
+  void updateFootprintCache();
   
   
   void configureBackupModes(std::vector<geometry_msgs::PoseStamped>& transformed_plan,  int& goal_idx);
@@ -410,6 +484,28 @@ private:
   FailureDetector failure_detector_; //!< Detect if the robot got stucked
   
   std::vector<geometry_msgs::PoseStamped> global_plan_; //!< Store the current global plan
+  unsigned int plan_version_; //!< Incremented whenever a new global plan is received (invalidates prepared inputs)
+
+  PlanningInput input_; //!< Inputs of the current planning cycle
+  PlanningInput next_input_; //!< Inputs of the next planning cycle (prepared by input_worker_ while the current cycle is optimized)
+  bool next_input_pending_; //!< \c true if the preparation of next_input_ has been started
+  costmap_2d::Costmap2D costmap_snapshot_; //!< Copy of the costmap used by input_worker_ (the costmap itself is only locked during computeVelocityCommands())
+  WorkerPoolPtr input_worker_; //!< Thread that prepares the inputs of the next cycle (created on first use, pinned according to hcp.worker_cpu_affinity)
+  double controller_period_; //!< Expected period of computeVelocityCommands() [s], prepared inputs older than 1.5 periods are discarded
+
+  std::chrono::steady_clock::time_point last_latency_publish_; //!< Time at which the latency statistics have been published the last time
+
+  PlanningRecorder recorder_; //!< Writes the planning log (if planning_log is set)
+  PlanningCycleInput record_input_; //!< Inputs of the recorded cycle (kept in order to reuse its memory)
+  PlanningCycleOutput record_output_; //!< Results of the recorded cycle (kept in order to reuse its memory)
+  std::uint64_t config_hash_; //!< Hash of the most recently recorded config
+  ros::Subscriber record_predictions_sub_; //!< Subscriber for obstacle predictions (recording only)
+  ros::Subscriber record_costmap_sub_; //!< Subscriber for the global costmap (recording only)
+  boost::mutex record_mutex_; //!< Protects the following changes that are not yet recorded
+  obstacle_prediction::ObstacleArray::ConstPtr record_predictions_; //!< Most recent obstacle predictions
+  nav_msgs::OccupancyGrid::ConstPtr record_costmap_; //!< Global costmap received since the previous cycle
+  RobotFootprintModelPtr record_footprint_; //!< Footprint model created since the previous cycle
+  bool record_config_; //!< \c true if the config changed since the previous cycle
   
   base_local_planner::OdometryHelperRos odom_helper_; //!< Provides an interface to receive the current velocity from the robot
   
@@ -229,6 +229,12 @@ public:
    * @param obstacles Container of obstacles
    */
   void publishFeedbackMessage(const TebOptimalPlanner& teb_planner, const ObstContainer& obstacles);
+
+  /**
+   * @brief Publish the latency statistics of all planning stages recorded since the previous call (see LatencyProfiler)
+   * @param period Duration [s] since the previous call
+   */
+  void publishLatencyStatistics(double period);
   
   //@}
 
@@ -255,6 +261,7 @@ protected:
   ros::Publisher teb_poses_pub_; //!< Publisher for the trajectory pose sequence
   ros::Publisher teb_marker_pub_; //!< Publisher for visualization markers
   ros::Publisher feedback_pub_; //!< Publisher for the feedback message for analysis and debug purposes
+  ros::Publisher latency_pub_; //!< Publisher for the latency statistics of the planning stages
   
   const TebConfig* cfg_; //!< Config class that stores and manages all related parameters
   
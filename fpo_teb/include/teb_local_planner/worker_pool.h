@@ -0,0 +1,179 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#ifndef WORKER_POOL_H_
+#define WORKER_POOL_H_
+
+#include <queue>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+
+namespace teb_local_planner
+{
+
+/**
+ * @class WorkerPool
+ * @brief Fixed set of persistent worker threads that execute submitted jobs.
+ *
+ * The HomotopyClassPlanner optimizes all trajectory candidates in parallel in each sampling interval.
+ * Instead of spawning (and joining) a new thread per candidate in every cycle, jobs are submitted to
+ * this pool whose threads are created once and live as long as the pool. \n
+ * Workers can optionally be pinned to a set of cpu cores (Linux only), e.g. in order to keep the planner
+ * away from cores reserved for other time critical nodes. \n
+ * Jobs can be submitted with an estimated effort: pending jobs are dispatched longest first to whichever
+ * worker becomes idle next. If the workers are not pinned, the thread calling waitAll() executes pending jobs
+ * as well instead of just blocking. This keeps the makespan of a batch of unbalanced jobs close to the duration
+ * of its longest job.
+ */
+class WorkerPool
+{
+public:
+
+  //! Abbrev. for a job executed by a worker
+  typedef boost::function<void ()> Job;
+
+  /**
+   * @brief Construct the pool and start all worker threads
+   * @param num_workers Number of worker threads (if <= 0, boost::thread::hardware_concurrency() is used)
+   * @param cpu_affinity Cpu core ids the workers are pinned to (worker i is pinned to core cpu_affinity[i % cpu_affinity.size()]).
+   *                     Leave empty to let the scheduler decide.
+   */
+  WorkerPool(int num_workers, const std::vector<int>& cpu_affinity = std::vector<int>());
+
+  /**
+   * @brief Destruct the pool: waits for pending jobs and joins all workers.
+   */
+  ~WorkerPool();
+
+  /**
+   * @brief Enqueue a new job. The job is executed by the next idle worker.
+   *
+   * Pending jobs with a larger \c effort are started first, jobs with equal effort in the order of submission.
+   * @param job job to be executed
+   * @param effort estimated (relative) computational effort of the job
+   */
+  void submit(const Job& job, double effort = 0);
+
+  /**
+   * @brief Block until all submitted jobs are finished
+   *
+   * If no cpu affinity is configured, the calling thread executes pending jobs itself until the queue is empty
+   * and waits for the workers afterwards. Otherwise all jobs are left to the pinned workers, since the caller
+   * (e.g. the controller thread) might run on a core that is reserved for other tasks.
+   * @remarks This method is not an interruption point (jobs usually operate on data owned by the caller).
+   */
+  void waitAll();
+
+  /**
+   * @brief Get the number of worker threads
+   * @return number of workers
+   */
+  int size() const {return (int)workers_.size();}
+
+  /**
+   * @brief Get the cpu cores the workers are pinned to
+   * @return cpu core ids (empty if not pinned)
+   */
+  const std::vector<int>& cpuAffinity() const {return cpu_affinity_;}
+
+private:
+
+  /**
+   * @brief Main loop of each worker thread
+   */
+  void workerLoop();
+
+  /**
+   * @brief Pop the next pending job (mutex_ must be locked and jobs_ must not be empty)
+   * @return job with the largest effort
+   */
+  Job popJob();
+
+  /**
+   * @brief Execute a job and catch all exceptions
+   * @param job job to be executed
+   */
+  static void runJob(const Job& job);
+
+  /**
+   * @brief Pin a worker thread to a cpu core
+   * @param worker worker thread
+   * @param cpu cpu core id
+   * @return \c true if successful, \c false otherwise
+   */
+  static bool pinThread(boost::thread& worker, int cpu);
+
+  std::vector< boost::shared_ptr<boost::thread> > workers_; //!< Persistent worker threads
+  std::vector<int> cpu_affinity_; //!< Cpu cores the workers are pinned to
+
+  //! Pending job along with its scheduling priority
+  struct QueuedJob
+  {
+    Job job; //!< The job itself
+    double effort; //!< Estimated effort (larger efforts are scheduled first)
+    unsigned long seq; //!< Submission counter (keeps FIFO order for equal efforts)
+
+    bool operator<(const QueuedJob& other) const
+    {
+      return effort < other.effort || (effort == other.effort && seq > other.seq);
+    }
+  };
+
+  std::priority_queue<QueuedJob> jobs_; //!< Jobs waiting for execution
+  unsigned long submitted_jobs_; //!< Number of jobs submitted so far
+  int active_jobs_; //!< Number of jobs that are currently executed
+  bool stop_; //!< Signals the workers to terminate
+
+  boost::mutex mutex_; //!< Protects jobs_, active_jobs_ and stop_
+  boost::condition_variable job_available_; //!< Notifies workers about new jobs (or termination)
+  boost::condition_variable jobs_done_; //!< Notifies waitAll() once the queue is empty and all workers are idle
+
+  // Non-copyable
+  WorkerPool(const WorkerPool&);
+  WorkerPool& operator=(const WorkerPool&);
+};
+
+//! Abbrev. for shared pointers of a WorkerPool
+typedef boost::shared_ptr<WorkerPool> WorkerPoolPtr;
+
+} // namespace teb_local_planner
+
+#endif /* WORKER_POOL_H_ */
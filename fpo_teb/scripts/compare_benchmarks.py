@@ -0,0 +1,138 @@
+#!/usr/bin/env python
+
+# Compares the json results of replay_benchmark, scaling_benchmark or distance_benchmark
+# against a baseline and fails if the median or the p99 of a benchmark regressed, if more
+# planning cycles failed than in the baseline, or if a benchmark of the baseline is missing
+# in the current results (e.g. because it crashed or was renamed).
+#
+# Usage: compare_benchmarks.py BASELINE CURRENT [--median-threshold 0.1] [--p99-threshold 0.25]
+#                              [--allow-missing-baseline] [--update] [--xunit FILE]
+#
+# A benchmark regressed if its current value exceeds the baseline by more than the relative
+# threshold *and* by more than an absolute noise floor, which avoids failures due to timer
+# resolution for very short benchmarks. A missing baseline is an error unless --allow-missing-baseline
+# is given. --update overwrites the baseline with the current results. --xunit additionally writes
+# the comparison as JUnit xml (one test case per benchmark) for catkin run_tests.
+
+from __future__ import print_function
+
+import argparse, json, shutil, sys, os
+from xml.sax.saxutils import quoteattr
+
+# metric of each result type and the absolute difference below which changes are considered noise
+METRICS = [("latency_ms", 0.05), ("time_ns", 2.0)]
+
+
+def load(filename):
+  with open(filename) as f:
+    return json.load(f)["benchmarks"]
+
+
+def metric_of(result):
+  for name, noise_floor in METRICS:
+    if name in result:
+      return name, noise_floor
+  return None, None
+
+
+def compare(baseline, current, median_threshold, p99_threshold):
+  regressions = []
+  print("%-50s %-6s %12s %12s %8s" % ("benchmark", "stat", "baseline", "current", "change"))
+  for name in sorted(baseline):
+    if name not in current:
+      print("%-50s missing in the current results  REGRESSION" % name)
+      regressions.append("%s missing" % name)
+      continue
+    metric, noise_floor = metric_of(baseline[name])
+    if metric is None or metric not in current[name]:
+      print("%-50s no comparable metric" % name)
+      continue
+    for stat, threshold in (("p50", median_threshold), ("p99", p99_threshold)):
+      old = baseline[name][metric][stat]
+      new = current[name][metric][stat]
+      change = (new - old) / old if old > 0 else 0.
+      regressed = change > threshold and new - old > noise_floor
+      print("%-50s %-6s %12.3f %12.3f %+7.1f%%%s" % (name, stat, old, new, 100. * change, "  REGRESSION" if regressed else ""))
+      if regressed:
+        regressions.append("%s %s" % (name, stat))
+    failures_old = baseline[name].get("failures", 0)
+    failures_new = current[name].get("failures", 0)
+    if failures_new > failures_old:
+      print("%-50s failures increased from %d to %d  REGRESSION" % (name, failures_old, failures_new))
+      regressions.append("%s failures" % name)
+  for name in sorted(set(current) - set(baseline)):
+    print("%-50s not contained in the baseline" % name)
+  return regressions
+
+
+def write_xunit(filename, suite, benchmarks, regressions, error=None):
+  failed = {}
+  for regression in regressions:
+    name, reason = regression.rsplit(" ", 1)
+    failed.setdefault(name, []).append(reason)
+  names = sorted(benchmarks) if error is None else [suite]
+  xunit_dir = os.path.dirname(os.path.abspath(filename))
+  if not os.path.isdir(xunit_dir):
+    os.makedirs(xunit_dir)
+  with open(filename, "w") as f:
+    f.write('<?xml version="1.0" encoding="utf-8"?>\n')
+    f.write('<testsuite name=%s tests="%d" failures="%d" errors="0">\n'
+            % (quoteattr(suite), len(names), len(failed) if error is None else 1))
+    for name in names:
+      f.write('  <testcase classname=%s name=%s>' % (quoteattr(suite), quoteattr(name)))
+      if error is not None:
+        f.write('<failure message=%s/>' % quoteattr(error))
+      elif name in failed:
+        f.write('<failure message=%s/>' % quoteattr("regressed: " + ", ".join(failed[name])))
+      f.write('</testcase>\n')
+    f.write('</testsuite>\n')
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Compare benchmark results against a baseline.")
+  parser.add_argument("baseline", help="json file with the baseline results")
+  parser.add_argument("current", help="json file with the current results")
+  parser.add_argument("--median-threshold", type=float, default=0.1, help="maximum relative increase of the median")
+  parser.add_argument("--p99-threshold", type=float, default=0.25, help="maximum relative increase of the p99")
+  parser.add_argument("--allow-missing-baseline", action="store_true", help="succeed if the baseline does not exist")
+  parser.add_argument("--update", action="store_true", help="replace the baseline by the current results")
+  parser.add_argument("--xunit", help="write the result of the comparison as JUnit xml file")
+  args = parser.parse_args()
+  suite = os.path.splitext(os.path.basename(args.baseline))[0]
+
+  if args.update:
+    baseline_dir = os.path.dirname(os.path.abspath(args.baseline))
+    if not os.path.isdir(baseline_dir):
+      os.makedirs(baseline_dir)
+    shutil.copyfile(args.current, args.baseline)
+    print("Updated baseline %s" % args.baseline)
+    return 0
+
+  if not os.path.exists(args.baseline):
+    print("Baseline %s does not exist." % args.baseline)
+    if args.allow_missing_baseline:
+      return 0
+    if args.xunit:
+      write_xunit(args.xunit, suite, [], [], "baseline %s does not exist" % args.baseline)
+    return 1
+  if not os.path.exists(args.current):
+    print("Results %s do not exist." % args.current)
+    if args.xunit:
+      write_xunit(args.xunit, suite, [], [], "results %s do not exist" % args.current)
+    return 1
+
+  baseline = load(args.baseline)
+  regressions = compare(baseline, load(args.current), args.median_threshold, args.p99_threshold)
+  if args.xunit:
+    write_xunit(args.xunit, suite, baseline, regressions)
+  if regressions:
+    print("\n%d regression(s) compared to %s:" % (len(regressions), args.baseline))
+    for regression in regressions:
+      print("  " + regression)
+    return 1
+  print("\nNo regression compared to %s." % args.baseline)
+  return 0
+
+
+if __name__ == "__main__":
+  sys.exit(main())
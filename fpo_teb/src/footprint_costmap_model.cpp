@@ -0,0 +1,243 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#include <teb_local_planner/footprint_costmap_model.h>
+
+#include <costmap_2d/cost_values.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <utility>
+
+namespace teb_local_planner
+{
+
+FootprintCostmapModel::FootprintCostmapModel(const costmap_2d::Costmap2D& costmap, int num_headings, int num_subcells)
+  : base_local_planner::CostmapModel(costmap), costmap_(costmap), num_headings_(std::max(num_headings, 1)), num_subcells_(std::max(num_subcells, 1)),
+    resolution_(0), size_x_(0)
+{
+}
+
+
+double FootprintCostmapModel::cachedFootprintCost(double x, double y, double theta, const std::vector<geometry_msgs::Point>& footprint_spec)
+{
+  // rasterizing the footprint here would stall the caller, see setFootprint()
+  if (footprint_spec.size() < 3 || !isCached(footprint_spec))
+    return footprintCost(x, y, theta, footprint_spec);
+
+  unsigned int cell_x, cell_y;
+  if (!costmap_.worldToMap(x, y, cell_x, cell_y))
+    return -3.0;
+
+  int heading_idx = (int)std::floor(theta / (2. * M_PI) * num_headings_ + 0.5) % num_headings_;
+  if (heading_idx < 0)
+    heading_idx += num_headings_;
+  // position of the robot inside its cell
+  const int subcell_x = std::min((int)(((x - costmap_.getOriginX()) / resolution_ - cell_x) * num_subcells_), num_subcells_ - 1);
+  const int subcell_y = std::min((int)(((y - costmap_.getOriginY()) / resolution_ - cell_y) * num_subcells_), num_subcells_ - 1);
+  const HeadingBin& heading = bins_[(heading_idx * num_subcells_ + std::max(subcell_y, 0)) * num_subcells_ + std::max(subcell_x, 0)];
+
+  // the offsets are not checked individually, hence cells close to the border of the map are checked exactly
+  if ((int)cell_x + heading.min_x < 0 || (int)cell_x + heading.max_x >= (int)costmap_.getSizeInCellsX() ||
+      (int)cell_y + heading.min_y < 0 || (int)cell_y + heading.max_y >= (int)costmap_.getSizeInCellsY())
+    return footprintCost(x, y, theta, footprint_spec);
+
+  const unsigned char* center = costmap_.getCharMap() + costmap_.getIndex(cell_x, cell_y);
+  unsigned char max_cost = 0;
+  bool no_information = false;
+  for (int i = heading.begin; i < heading.end; ++i)
+  {
+    const unsigned char cost = center[cell_offsets_[i]];
+    if (cost == costmap_2d::LETHAL_OBSTACLE)
+      return -1.0;
+    if (cost == costmap_2d::NO_INFORMATION)
+      no_information = true;
+    else
+      max_cost = std::max(max_cost, cost);
+  }
+  return no_information ? -2.0 : max_cost;
+}
+
+
+bool FootprintCostmapModel::capsuleRowInterval(const Eigen::Vector2d& start, const Eigen::Vector2d& end, double radius, double y,
+                                               double& min_x, double& max_x)
+{
+  // the capsule is convex, hence the row intersects it in a single interval: the hull of the intervals of both end
+  // circles and of the rectangle between them
+  min_x = HUGE_VAL;
+  max_x = -HUGE_VAL;
+  for (const Eigen::Vector2d* center : {&start, &end})
+  {
+    const double dy = y - center->y();
+    if (std::abs(dy) <= radius)
+    {
+      const double half_width = std::sqrt(radius * radius - dy * dy);
+      min_x = std::min(min_x, center->x() - half_width);
+      max_x = std::max(max_x, center->x() + half_width);
+    }
+  }
+
+  const Eigen::Vector2d dir = end - start;
+  const double length = dir.norm();
+  if (std::abs(dir.y()) > 1e-9 * length)
+  {
+    // rectangle: distance to the line below the radius and projection onto the segment inside [0, length^2]
+    const double center_x = start.x() + (y - start.y()) * dir.x() / dir.y();
+    const double half_width = radius * length / std::abs(dir.y());
+    double lower = center_x - half_width;
+    double upper = center_x + half_width;
+    if (std::abs(dir.x()) > 1e-9 * length)
+    {
+      double proj_start = start.x() - (y - start.y()) * dir.y() / dir.x(); // projection 0
+      double proj_end = proj_start + length * length / dir.x(); // projection length^2
+      lower = std::max(lower, std::min(proj_start, proj_end));
+      upper = std::min(upper, std::max(proj_start, proj_end));
+    }
+    else if ((y - start.y()) * dir.y() < 0 || (y - start.y()) * dir.y() > length * length)
+      upper = -HUGE_VAL;
+    if (lower <= upper)
+    {
+      min_x = std::min(min_x, lower);
+      max_x = std::max(max_x, upper);
+    }
+  }
+  else if (std::abs(y - start.y()) <= radius)
+  {
+    min_x = std::min(min_x, std::min(start.x(), end.x()));
+    max_x = std::max(max_x, std::max(start.x(), end.x()));
+  }
+  return min_x <= max_x;
+}
+
+
+bool FootprintCostmapModel::isCached(const std::vector<geometry_msgs::Point>& footprint_spec) const
+{
+  if (costmap_.getResolution() != resolution_ || costmap_.getSizeInCellsX() != size_x_ || footprint_spec.size() != footprint_.size())
+    return false;
+  for (std::size_t i = 0; i < footprint_spec.size(); ++i)
+  {
+    if (footprint_spec[i].x != footprint_[i].x || footprint_spec[i].y != footprint_[i].y)
+      return false;
+  }
+  return true;
+}
+
+
+void FootprintCostmapModel::setFootprint(const std::vector<geometry_msgs::Point>& footprint_spec)
+{
+  if (footprint_spec.size() < 3 || isCached(footprint_spec))
+    return; // footprints with less than three vertices are always checked by the base class
+
+  const double resolution = costmap_.getResolution();
+  const unsigned int size_x = costmap_.getSizeInCellsX();
+  footprint_ = footprint_spec;
+  resolution_ = resolution;
+  size_x_ = size_x;
+  bins_.resize(num_headings_ * num_subcells_ * num_subcells_);
+  cell_offsets_.clear();
+
+  const std::size_t num_vertices = footprint_spec.size();
+  double max_vertex_dist = 0; // [cells]
+  for (const geometry_msgs::Point& vertex : footprint_spec)
+    max_vertex_dist = std::max(max_vertex_dist, std::hypot(vertex.x, vertex.y) / resolution);
+
+  // Any pose of a bin moves the outline by at most half a subcell diagonal plus the arc of half a heading bin w.r.t.
+  // the pose at the center of the bin. Rounding the vertices to their cells shifts the traced line by [0, 1) cells
+  // per axis (at most sqrt(1/2) around a shift of half a cell) and the line iterator deviates by up to half a cell.
+  // Covering all cells within this radius of the outline of the center pose is thus a superset of the traced cells.
+  const double radius = std::sqrt(0.5) / num_subcells_ + max_vertex_dist * M_PI / num_headings_ + std::sqrt(0.5) + 0.5 + 1e-6;
+
+  std::vector<Eigen::Vector2d> vertices(num_vertices);
+  std::vector<std::pair<int, int> > cells; // (y, x) w.r.t. the center cell
+  for (std::size_t k = 0; k < bins_.size(); ++k)
+  {
+    const int heading_idx = (int)k / (num_subcells_ * num_subcells_);
+    const double theta = 2. * M_PI * heading_idx / num_headings_;
+    const double cos_th = std::cos(theta);
+    const double sin_th = std::sin(theta);
+    // center of the subcell the robot is located in (fraction of a cell), shifted by half a cell to account for rounding
+    const double subcell_x = ((int)k % num_subcells_ + 0.5) / num_subcells_ - 0.5;
+    const double subcell_y = ((int)k / num_subcells_ % num_subcells_ + 0.5) / num_subcells_ - 0.5;
+
+    // vertices w.r.t. the center cell [cells]
+    for (std::size_t i = 0; i < num_vertices; ++i)
+    {
+      vertices[i].x() = subcell_x + (cos_th * footprint_spec[i].x - sin_th * footprint_spec[i].y) / resolution;
+      vertices[i].y() = subcell_y + (sin_th * footprint_spec[i].x + cos_th * footprint_spec[i].y) / resolution;
+    }
+
+    // cells within the radius of the closed outline
+    cells.clear();
+    for (std::size_t i = 0; i < num_vertices; ++i)
+    {
+      const Eigen::Vector2d& start = vertices[i];
+      const Eigen::Vector2d& end = vertices[(i + 1) % num_vertices];
+      const int min_y = (int)std::ceil(std::min(start.y(), end.y()) - radius);
+      const int max_y = (int)std::floor(std::max(start.y(), end.y()) + radius);
+      for (int y = min_y; y <= max_y; ++y)
+      {
+        double min_x, max_x;
+        if (capsuleRowInterval(start, end, radius, y, min_x, max_x))
+        {
+          for (int x = (int)std::ceil(min_x); x <= (int)std::floor(max_x); ++x)
+            cells.push_back(std::make_pair(y, x));
+        }
+      }
+    }
+
+    // store each cell once and in memory order of the costmap
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+    HeadingBin& bin = bins_[k];
+    bin.begin = (int)cell_offsets_.size();
+    bin.min_x = bin.min_y = INT_MAX;
+    bin.max_x = bin.max_y = INT_MIN;
+    for (const std::pair<int, int>& cell : cells)
+    {
+      cell_offsets_.push_back(cell.first * (int)size_x + cell.second);
+      bin.min_x = std::min(bin.min_x, cell.second);
+      bin.max_x = std::max(bin.max_x, cell.second);
+      bin.min_y = std::min(bin.min_y, cell.first);
+      bin.max_y = std::max(bin.max_y, cell.first);
+    }
+    bin.end = (int)cell_offsets_.size();
+  }
+}
+
+} // namespace teb_local_planner
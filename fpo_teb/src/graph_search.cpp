@@ -39,53 +39,271 @@
 #include <teb_local_planner/graph_search.h>
 #include <teb_local_planner/homotopy_class_planner.h>
 
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+#include <boost/dynamic_bitset.hpp>
+#include <boost/functional/hash.hpp>
+
 namespace teb_local_planner
 {
 
-void GraphSearchInterface::DepthFirst(HcGraph& g, std::vector<HcGraphVertexType>& visited, const HcGraphVertexType& goal, double start_orientation,
-                                      double goal_orientation, const geometry_msgs::Twist* start_velocity, bool free_goal_vel)
+namespace
 {
-  // see http://www.technical-recipes.com/2011/a-recursive-algorithm-to-find-all-paths-between-two-given-nodes/ for details on finding all simple paths
+  //! Node of the best-first path search (a partial path from the start vertex)
+  struct PathSearchNode
+  {
+    HcGraphVertexType vertex; //!< Last vertex of the partial path
+    int parent; //!< Index of the node of the preceding vertex (-1 for the start)
+    double cost; //!< Length of the partial path
+    int closed; //!< Index into the data of expanded nodes (-1 if not yet expanded)
+  };
+
+  //! Data stored for expanded nodes only
+  struct ExpandedPathData
+  {
+    std::vector<double> winding; //!< Accumulated winding angle around each obstacle
+    boost::dynamic_bitset<> visited; //!< Vertices contained in the partial path
+  };
 
-  if ((int)hcp_->getTrajectoryContainer().size() >= cfg_->hcp.max_number_classes)
+  //! Compare vertices sorted along a direction by their projection
+  bool projectionLess(const std::pair<double, HcGraphVertexType>& lhs, const std::pair<double, HcGraphVertexType>& rhs)
+  {
+    return lhs.first < rhs.first;
+  }
+} // anonymous namespace
+
+
+void GraphSearchInterface::findDistinctPaths(HcGraphVertexType start, HcGraphVertexType goal, double start_orientation, double goal_orientation,
+                                             const geometry_msgs::Twist* start_velocity, bool free_goal_vel)
+{
+  if (enoughCandidates())
     return; // We do not need to search for further possible alternative homotopy classes.
 
-  HcGraphVertexType back = visited.back();
+  const std::size_t no_vertices = boost::num_vertices(graph_);
+  const Eigen::Vector2d& goal_pos = graph_[goal].pos;
+
+  // obstacles that distinguish the equivalence classes
+  const ObstContainer& obstacles = hSignatureObstacles();
+  std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > centroids;
+  centroids.reserve(obstacles.size());
+  for (ObstContainer::const_iterator it_obst = obstacles.begin(); it_obst != obstacles.end(); ++it_obst)
+    centroids.push_back((*it_obst)->getCentroid());
+
+  std::vector<PathSearchNode> nodes;
+  std::vector<ExpandedPathData> expanded;
+  std::vector< std::vector<int> > expanded_at_vertex(no_vertices); // expanded nodes per vertex (one per homotopy class of the partial path)
 
-  /// Examine adjacent nodes
-  HcGraphAdjecencyIterator it, end;
-  for ( boost::tie(it,end) = boost::adjacent_vertices(back,g); it!=end; ++it)
+  typedef std::pair<double, int> QueueEntry; // (cost + heuristic, node index)
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > open;
+
+  PathSearchNode root = {start, -1, 0., -1};
+  nodes.push_back(root);
+  open.push(QueueEntry((goal_pos - graph_[start].pos).norm(), 0));
+
+  std::vector<HcGraphVertexType> path;
+  int no_expansions = 0;
+  while (!open.empty())
   {
-    if ( std::find(visited.begin(), visited.end(), *it)!=visited.end() )
-      continue; // already visited
+    if (enoughCandidates())
+      break;
 
-    if ( *it == goal ) // goal reached
+    if (hcpConfig().graph_search_max_expansions > 0 && no_expansions >= hcpConfig().graph_search_max_expansions)
     {
-      visited.push_back(*it);
+      ROS_DEBUG("GraphSearchInterface::findDistinctPaths(): maximum number of expansions reached.");
+      break;
+    }
 
-      // Add new TEB, if this path belongs to a new homotopy class
-      hcp_->addAndInitNewTeb(visited.begin(), visited.end(), boost::bind(getVector2dFromHcGraph, _1, boost::cref(graph_)),
-                             start_orientation, goal_orientation, start_velocity, free_goal_vel);
+    const int idx = open.top().second;
+    open.pop();
 
-      visited.pop_back();
-      break;
+    const HcGraphVertexType vertex = nodes[idx].vertex;
+    const int parent = nodes[idx].parent;
+
+    // Update winding angles and visited vertices incrementally w.r.t. the parent
+    ExpandedPathData data;
+    if (parent < 0)
+    {
+      data.winding.assign(centroids.size(), 0.);
+      data.visited.resize(no_vertices);
+    }
+    else
+    {
+      const ExpandedPathData& parent_data = expanded[nodes[parent].closed];
+      const Eigen::Vector2d& pos1 = graph_[nodes[parent].vertex].pos;
+      const Eigen::Vector2d& pos2 = graph_[vertex].pos;
+      data.winding = parent_data.winding;
+      data.visited = parent_data.visited;
+      for (std::size_t l = 0; l < centroids.size(); ++l)
+      {
+        Eigen::Vector2d diff1 = pos1 - centroids[l];
+        Eigen::Vector2d diff2 = pos2 - centroids[l];
+        if (diff1.isZero() || diff2.isZero())
+          continue;
+        // signed angle between both vectors in [-pi, pi] (equals the minimum abs angle chosen for the h-signature)
+        data.winding[l] += std::atan2(diff1.x()*diff2.y() - diff1.y()*diff2.x(), diff1.dot(diff2));
+      }
+    }
+
+    // Prune partial paths that are homotopic to an already expanded one (which is not longer)
+    bool duplicate = false;
+    const std::vector<int>& siblings = expanded_at_vertex[vertex];
+    for (std::size_t k = 0; k < siblings.size() && !duplicate; ++k)
+    {
+      const std::vector<double>& other = expanded[siblings[k]].winding;
+      duplicate = true;
+      for (std::size_t l = 0; l < other.size(); ++l)
+      {
+        if (std::abs(other[l] - data.winding[l]) > M_PI) // angles of homotopic paths are equal, otherwise they differ by multiples of 2*pi
+        {
+          duplicate = false;
+          break;
+        }
+      }
+    }
+    if (duplicate)
+      continue;
+
+    data.visited.set(vertex);
+    nodes[idx].closed = (int)expanded.size();
+    expanded_at_vertex[vertex].push_back(nodes[idx].closed);
+    expanded.push_back(data);
+
+    if (vertex == goal) // goal reached with a new homotopy class
+    {
+      path.clear();
+      for (int node = idx; node >= 0; node = nodes[node].parent)
+        path.push_back(nodes[node].vertex);
+      std::reverse(path.begin(), path.end());
+
+      addCandidate(path, start_orientation, goal_orientation, start_velocity, free_goal_vel);
+      continue;
+    }
+
+    ++no_expansions;
+
+    /// Examine adjacent nodes
+    const ExpandedPathData& node_data = expanded.back();
+    const double cost = nodes[idx].cost;
+    HcGraphAdjecencyIterator it, end;
+    for ( boost::tie(it,end) = boost::adjacent_vertices(vertex,graph_); it!=end; ++it)
+    {
+      if (node_data.visited.test(*it))
+        continue; // already visited
+
+      PathSearchNode child = {*it, idx, cost + (graph_[*it].pos - graph_[vertex].pos).norm(), -1};
+      nodes.push_back(child);
+      open.push(QueueEntry(child.cost + (goal_pos - graph_[*it].pos).norm(), (int)nodes.size()-1));
     }
   }
+}
+
 
-  /// Recursion for all adjacent vertices
-  for ( boost::tie(it,end) = boost::adjacent_vertices(back,g); it!=end; ++it)
+
+void GraphSearchInterface::insertForwardEdges(const Eigen::Vector2d& direction, double obstacle_heading_threshold, double max_edge_length, double dist_to_obst,
+                                              HcGraphVertexType goal, const std::vector< std::pair<HcGraphVertexType, HcGraphVertexType> >& excluded_edges)
+{
+  obstacle_grid_.build(obstacles(), dist_to_obst);
+
+  // Sort vertices by their projection onto the goal heading
+  std::vector< std::pair<double, HcGraphVertexType> > sorted;
+  sorted.reserve(boost::num_vertices(graph_));
+  HcGraphVertexIterator it_i, end_i;
+  for (boost::tie(it_i,end_i) = boost::vertices(graph_); it_i!=end_i; ++it_i)
+    sorted.push_back(std::make_pair(graph_[*it_i].pos.dot(direction), *it_i));
+  std::sort(sorted.begin(), sorted.end(), projectionLess);
+
+  std::vector<HcGraphVertexType> targets;
+  for (boost::tie(it_i,end_i) = boost::vertices(graph_); it_i!=end_i; ++it_i)
   {
-    if ( std::find(visited.begin(), visited.end(), *it)!=visited.end() || *it == goal)
-      continue; // already visited || goal reached
+    if (*it_i == goal)
+      continue;
+
+    const Eigen::Vector2d& pos_i = graph_[*it_i].pos;
+    std::pair<double, HcGraphVertexType> key(pos_i.dot(direction), *it_i);
+
+    // For a non-negative threshold, only vertices further ahead along the goal heading are candidates
+    std::vector< std::pair<double, HcGraphVertexType> >::const_iterator it_j = obstacle_heading_threshold >= 0 ?
+          std::upper_bound(sorted.begin(), sorted.end(), key, projectionLess) : sorted.begin();
+
+    targets.clear();
+    for (; it_j != sorted.end(); ++it_j)
+    {
+      // the projection is a lower bound on the distance, hence all subsequent vertices are too far away as well
+      if (max_edge_length > 0 && it_j->first - key.first > max_edge_length)
+        break;
+
+      if (it_j->second == *it_i) // same vertex found
+        continue;
+
+      Eigen::Vector2d distij = graph_[it_j->second].pos - pos_i;
+      double length = distij.norm();
+      if (max_edge_length > 0 && length > max_edge_length)
+        continue;
+
+      // Check if the direction is backwards:
+      if (distij.dot(direction) <= obstacle_heading_threshold*length)
+        continue;
+
+      if (!excluded_edges.empty() && std::find(excluded_edges.begin(), excluded_edges.end(), std::make_pair(*it_i, it_j->second)) != excluded_edges.end())
+        continue;
+
+      // Collision Check
+      if (checkEdgeCollision(*it_i, it_j->second, dist_to_obst))
+        continue;
+
+      targets.push_back(it_j->second);
+    }
+
+    // Create Edges (in the order of the vertices, which determines the order of the depth first search)
+    std::sort(targets.begin(), targets.end());
+    for (std::size_t k = 0; k < targets.size(); ++k)
+      boost::add_edge(*it_i, targets[k], graph_);
+  }
+}
+
+
+
+const ObstContainer* GraphSearchInterface::obstacles() const
+{
+  return job_ ? &job_->obstacles : hcp_->obstacles();
+}
+
+
+const ObstContainer& GraphSearchInterface::hSignatureObstacles() const
+{
+  return job_ ? job_->hsignature_obstacles : hcp_->hSignatureObstacles();
+}
 
 
-    visited.push_back(*it);
+bool GraphSearchInterface::enoughCandidates() const
+{
+  if (job_)
+    return (int)job_->seeds.size() >= job_->max_seeds;
+  return (int)hcp_->getTrajectoryContainer().size() >= hcpConfig().max_number_classes;
+}
 
-    // recursion step
-    DepthFirst(g, visited, goal, start_orientation, goal_orientation, start_velocity, free_goal_vel);
 
-    visited.pop_back();
+void GraphSearchInterface::addCandidate(const std::vector<HcGraphVertexType>& path, double start_orientation, double goal_orientation,
+                                        const geometry_msgs::Twist* start_velocity, bool free_goal_vel)
+{
+  if (job_)
+  {
+    job_->seeds.push_back(ExplorationJob::Path());
+    for (std::size_t i=0; i < path.size(); ++i)
+      job_->seeds.back().push_back(graph_[path[i]].pos);
+    return;
   }
+
+  hcp_->addAndInitNewTeb(path.begin(), path.end(), boost::bind(getVector2dFromHcGraph, _1, boost::cref(graph_)),
+                         start_orientation, goal_orientation, start_velocity, free_goal_vel);
+}
+
+
+bool GraphSearchInterface::checkEdgeCollision(HcGraphVertexType from, HcGraphVertexType to, double dist_to_obst)
+{
+  return obstacle_grid_.checkLineIntersection(graph_[from].pos, graph_[to].pos, dist_to_obst);
 }
 
 
@@ -94,15 +312,15 @@ void lrKeyPointGraph::createGraph(const PoseSE2& start, const PoseSE2& goal, dou
 {
   // Clear existing graph and paths
   clearGraph();
-  if((int)hcp_->getTrajectoryContainer().size() >= cfg_->hcp.max_number_classes)
+  if(enoughCandidates())
     return;
   // Direction-vector between start and goal and normal-vector:
   Eigen::Vector2d diff = goal.position()-start.position();
 
-  if (diff.norm()<cfg_->goal_tolerance.xy_goal_tolerance)
+  if (diff.norm()<goalToleranceConfig().xy_goal_tolerance)
   {
     ROS_DEBUG("HomotopyClassPlanner::createProbRoadmapGraph(): xy-goal-tolerance already reached.");
-    if (hcp_->getTrajectoryContainer().empty())
+    if (!job_ && hcp_->getTrajectoryContainer().empty()) // the planner falls back to a straight line itself for asynchronous explorations
     {
       ROS_INFO("HomotopyClassPlanner::createProbRoadmapGraph(): Initializing a small straight line to just correct orientation errors.");
       hcp_->addAndInitNewTeb(start, goal, start_velocity, free_goal_vel);
@@ -123,9 +341,9 @@ void lrKeyPointGraph::createGraph(const PoseSE2& start, const PoseSE2& goal, dou
   std::pair<HcGraphVertexType,HcGraphVertexType> nearest_obstacle; // both vertices are stored
   double min_dist = DBL_MAX;
 
-  if (hcp_->obstacles()!=NULL)
+  if (obstacles()!=NULL)
   {
-    for (ObstContainer::const_iterator it_obst = hcp_->obstacles()->begin(); it_obst != hcp_->obstacles()->end(); ++it_obst)
+    for (ObstContainer::const_iterator it_obst = obstacles()->begin(); it_obst != obstacles()->end(); ++it_obst)
     {
       // check if obstacle is placed in front of start point
       Eigen::Vector2d start2obst = (*it_obst)->getCentroid() - start.position();
@@ -153,66 +371,31 @@ void lrKeyPointGraph::createGraph(const PoseSE2& start, const PoseSE2& goal, dou
   graph_[goal_vtx].pos = goal.position();
 
   // Insert Edges
-  HcGraphVertexIterator it_i, end_i, it_j, end_j;
-  for (boost::tie(it_i,end_i) = boost::vertices(graph_); it_i!=end_i-1; ++it_i) // ignore goal in this loop
+  std::vector< std::pair<HcGraphVertexType, HcGraphVertexType> > excluded_edges;
+
+  // Check start angle to nearest obstacle
+  if (obstacle_heading_threshold && min_dist!=DBL_MAX)
   {
-    for (boost::tie(it_j,end_j) = boost::vertices(graph_); it_j!=end_j; ++it_j) // check all forward connections
+    Eigen::Vector2d start_orient_vec( cos(start.theta()), sin(start.theta()) ); // already normalized
+    HcGraphVertexType keypoints[2] = {nearest_obstacle.first, nearest_obstacle.second};
+    for (int k = 0; k < 2; ++k)
     {
-      if (it_i==it_j)
-        continue;
-      // TODO: make use of knowing in which order obstacles are inserted and that for each obstacle 2 vertices are added,
-      // therefore we must only check one of them.
-      Eigen::Vector2d distij = graph_[*it_j].pos-graph_[*it_i].pos;
-      distij.normalize();
-      // Check if the direction is backwards:
-      if (distij.dot(diff)<=obstacle_heading_threshold)
-        continue;
-
-
-      // Check start angle to nearest obstacle
-      if (obstacle_heading_threshold && *it_i==start_vtx && min_dist!=DBL_MAX)
+      Eigen::Vector2d keypoint_dist = graph_[keypoints[k]].pos-start.position();
+      keypoint_dist.normalize();
+      // check angle
+      if (start_orient_vec.dot(keypoint_dist) <= obstacle_heading_threshold)
       {
-        if (*it_j == nearest_obstacle.first || *it_j == nearest_obstacle.second)
-        {
-          Eigen::Vector2d keypoint_dist = graph_[*it_j].pos-start.position();
-          keypoint_dist.normalize();
-          Eigen::Vector2d start_orient_vec( cos(start.theta()), sin(start.theta()) ); // already normalized
-          // check angle
-          if (start_orient_vec.dot(keypoint_dist) <= obstacle_heading_threshold)
-          {
-            ROS_DEBUG("createGraph() - deleted edge: limit_obstacle_heading");
-            continue;
-          }
-        }
-      }
-
-      // Collision Check
-
-      if (hcp_->obstacles()!=NULL)
-      {
-        bool collision = false;
-        for (ObstContainer::const_iterator it_obst = hcp_->obstacles()->begin(); it_obst != hcp_->obstacles()->end(); ++it_obst)
-        {
-          if ( (*it_obst)->checkLineIntersection(graph_[*it_i].pos,graph_[*it_j].pos, 0.5*dist_to_obst) )
-          {
-            collision = true;
-            break;
-          }
-        }
-        if (collision)
-          continue;
+        ROS_DEBUG("createGraph() - deleted edge: limit_obstacle_heading");
+        excluded_edges.push_back(std::make_pair(start_vtx, keypoints[k]));
       }
-
-      // Create Edge
-      boost::add_edge(*it_i,*it_j,graph_);
     }
   }
 
+  insertForwardEdges(diff, obstacle_heading_threshold, 0, 0.5*dist_to_obst, goal_vtx, excluded_edges);
+
 
-  // Find all paths between start and goal!
-  std::vector<HcGraphVertexType> visited;
-  visited.push_back(start_vtx);
-  DepthFirst(graph_,visited,goal_vtx, start.theta(), goal.theta(), start_velocity, free_goal_vel);
+  // Find paths of distinct homotopy classes between start and goal!
+  findDistinctPaths(start_vtx, goal_vtx, start.theta(), goal.theta(), start_velocity, free_goal_vel);
 }
 
 
@@ -221,16 +404,16 @@ void ProbRoadmapGraph::createGraph(const PoseSE2& start, const PoseSE2& goal, do
 {
   // Clear existing graph and paths
   clearGraph();
-  if((int)hcp_->getTrajectoryContainer().size() >= cfg_->hcp.max_number_classes)
+  if(enoughCandidates())
     return;
   // Direction-vector between start and goal and normal-vector:
   Eigen::Vector2d diff = goal.position()-start.position();
   double start_goal_dist = diff.norm();
 
-  if (start_goal_dist<cfg_->goal_tolerance.xy_goal_tolerance)
+  if (start_goal_dist<goalToleranceConfig().xy_goal_tolerance)
   {
     ROS_DEBUG("HomotopyClassPlanner::createProbRoadmapGraph(): xy-goal-tolerance already reached.");
-    if (hcp_->getTrajectoryContainer().empty())
+    if (!job_ && hcp_->getTrajectoryContainer().empty()) // the planner falls back to a straight line itself for asynchronous explorations
     {
       ROS_INFO("HomotopyClassPlanner::createProbRoadmapGraph(): Initializing a small straight line to just correct orientation errors.");
       hcp_->addAndInitNewTeb(start, goal, start_velocity, free_goal_vel);
@@ -243,17 +426,17 @@ void ProbRoadmapGraph::createGraph(const PoseSE2& start, const PoseSE2& goal, do
   // Now sample vertices between start, goal and a specified width between both sides
   // Let's start with a square area between start and goal (maybe change it later to something like a circle or whatever)
 
-  double area_width = cfg_->hcp.roadmap_graph_area_width;
+  double area_width = hcpConfig().roadmap_graph_area_width;
 
-  boost::random::uniform_real_distribution<double> distribution_x(0, start_goal_dist * cfg_->hcp.roadmap_graph_area_length_scale);
+  boost::random::uniform_real_distribution<double> distribution_x(0, start_goal_dist * hcpConfig().roadmap_graph_area_length_scale);
   boost::random::uniform_real_distribution<double> distribution_y(0, area_width);
 
   double phi = atan2(diff.coeffRef(1),diff.coeffRef(0)); // rotate area by this angle
   Eigen::Rotation2D<double> rot_phi(phi);
 
   Eigen::Vector2d area_origin;
-  if (cfg_->hcp.roadmap_graph_area_length_scale != 1.0)
-    area_origin = start.position() + 0.5*(1.0-cfg_->hcp.roadmap_graph_area_length_scale)*start_goal_dist*diff.normalized() - 0.5*area_width*normal; // bottom left corner of the origin
+  if (hcpConfig().roadmap_graph_area_length_scale != 1.0)
+    area_origin = start.position() + 0.5*(1.0-hcpConfig().roadmap_graph_area_length_scale)*start_goal_dist*diff.normalized() - 0.5*area_width*normal; // bottom left corner of the origin
   else
     area_origin = start.position() - 0.5*area_width*normal; // bottom left corner of the origin
 
@@ -263,34 +446,59 @@ void ProbRoadmapGraph::createGraph(const PoseSE2& start, const PoseSE2& goal, do
   diff.normalize(); // normalize in place
 
 
-  // Start sampling
-  for (int i=0; i < cfg_->hcp.roadmap_graph_no_samples; ++i)
+  if (clear_cache_.exchange(false))
+  {
+    samples_.clear();
+    edge_cache_.clear();
+    halton_index_ = 0;
+    roadmap_dist_to_obst_ = -1;
+    current_obstacle_keys_.clear();
+  }
+
+  if (hcpConfig().roadmap_graph_reuse)
+  {
+    // Reuse keypoints of previous cycles
+    updateSamples(area_origin, rot_phi, start_goal_dist * hcpConfig().roadmap_graph_area_length_scale, area_width);
+    updateObstacleSnapshot(dist_to_obst);
+    for (std::size_t i=0; i < samples_.size(); ++i)
+    {
+      HcGraphVertexType v = boost::add_vertex(graph_);
+      graph_[v].pos = samples_[i];
+    }
+  }
+  else
   {
-    Eigen::Vector2d sample;
-//     bool coll_free;
-//     do // sample as long as a collision free sample is found
-//     {
-      // Sample coordinates
-      sample = area_origin + rot_phi*Eigen::Vector2d(distribution_x(rnd_generator_), distribution_y(rnd_generator_));
-
-      // Test for collision
-      // we do not care for collision checking here to improve efficiency, since we perform resampling repeatedly.
-      // occupied vertices are ignored in the edge insertion state since they always violate the edge-obstacle collision check.
-//       coll_free = true;
-//       for (ObstContainer::const_iterator it_obst = obstacles_->begin(); it_obst != obstacles_->end(); ++it_obst)
-//       {
-//         if ( (*it_obst)->checkCollision(sample, dist_to_obst)) // TODO really keep dist_to_obst here?
-//         {
-//           coll_free = false;
-//           break;
-//         }
-//       }
-//
-//     } while (!coll_free && ros::ok());
-
-    // Add new vertex
-    HcGraphVertexType v = boost::add_vertex(graph_);
-    graph_[v].pos = sample;
+    // Start sampling
+    samples_.clear();
+    edge_cache_.clear();
+    for (int i=0; i < hcpConfig().roadmap_graph_no_samples; ++i)
+    {
+      Eigen::Vector2d sample;
+  //     bool coll_free;
+  //     do // sample as long as a collision free sample is found
+  //     {
+        // Sample coordinates
+        sample = area_origin + rot_phi*Eigen::Vector2d(distribution_x(rnd_generator_), distribution_y(rnd_generator_));
+
+        // Test for collision
+        // we do not care for collision checking here to improve efficiency, since we perform resampling repeatedly.
+        // occupied vertices are ignored in the edge insertion state since they always violate the edge-obstacle collision check.
+  //       coll_free = true;
+  //       for (ObstContainer::const_iterator it_obst = obstacles_->begin(); it_obst != obstacles_->end(); ++it_obst)
+  //       {
+  //         if ( (*it_obst)->checkCollision(sample, dist_to_obst)) // TODO really keep dist_to_obst here?
+  //         {
+  //           coll_free = false;
+  //           break;
+  //         }
+  //       }
+  //
+  //     } while (!coll_free && ros::ok());
+
+      // Add new vertex
+      HcGraphVertexType v = boost::add_vertex(graph_);
+      graph_[v].pos = sample;
+    }
   }
 
   // Now add goal vertex
@@ -299,44 +507,155 @@ void ProbRoadmapGraph::createGraph(const PoseSE2& start, const PoseSE2& goal, do
 
 
   // Insert Edges
-  HcGraphVertexIterator it_i, end_i, it_j, end_j;
-  for (boost::tie(it_i,end_i) = boost::vertices(graph_); it_i!=boost::prior(end_i); ++it_i) // ignore goal in this loop
+  insertForwardEdges(diff, obstacle_heading_threshold, hcpConfig().roadmap_graph_max_edge_length, dist_to_obst, goal_vtx);
+
+  /// Find paths of distinct homotopy classes between start and goal!
+  findDistinctPaths(start_vtx, goal_vtx, start.theta(), goal.theta(), start_velocity, free_goal_vel);
+}
+
+
+
+bool ProbRoadmapGraph::checkEdgeCollision(HcGraphVertexType from, HcGraphVertexType to, double dist_to_obst)
+{
+  // vertex 0 is the start vertex, vertices 1 ... n are the persistent keypoints (in this order)
+  const std::size_t no_samples = samples_.size();
+  if (!hcpConfig().roadmap_graph_reuse || edge_cache_.size() != no_samples*no_samples || from < 1 || to < 1 || from > no_samples || to > no_samples)
+    return GraphSearchInterface::checkEdgeCollision(from, to, dist_to_obst);
+
+  EdgeState& edge = edge_cache_[(std::min(from, to)-1)*no_samples + std::max(from, to)-1];
+  const Eigen::Vector2d& pos_from = graph_[from].pos;
+  const Eigen::Vector2d& pos_to = graph_[to].pos;
+  int obst_idx = -1;
+
+  // a free edge can only be blocked by obstacles that appeared since the last check.
+  // added_obstacles_ only covers the previous cycle: edges that were skipped in between (e.g. by the heading
+  // or length filters of insertForwardEdges()) might have missed obstacles and are checked from scratch.
+  if (edge.state == EdgeState::Free && edge.cycle + 1 == cycle_)
   {
-    for (boost::tie(it_j,end_j) = boost::vertices(graph_); it_j!=end_j; ++it_j) // check all forward connections
+    edge.cycle = cycle_;
+    if (!added_obstacle_grid_.checkLineIntersection(pos_from, pos_to, dist_to_obst, &obst_idx))
+      return false;
+    edge.state = EdgeState::Blocked;
+    edge.blocker = added_obstacle_keys_[obst_idx];
+    return true;
+  }
+
+  // a blocked edge remains blocked as long as the blocking obstacle exists
+  if (edge.state == EdgeState::Blocked && edge.blocker != 0 && current_obstacle_keys_.count(edge.blocker) > 0)
+  {
+    edge.cycle = cycle_;
+    return true;
+  }
+
+  bool collision = obstacle_grid_.checkLineIntersection(pos_from, pos_to, dist_to_obst, &obst_idx);
+  edge.state = collision ? EdgeState::Blocked : EdgeState::Free;
+  edge.blocker = collision ? obstacle_keys_[obst_idx] : 0;
+  edge.cycle = cycle_;
+  return collision;
+}
+
+
+void ProbRoadmapGraph::updateSamples(const Eigen::Vector2d& area_origin, const Eigen::Rotation2D<double>& rot_phi, double area_length, double area_width)
+{
+  const std::size_t no_samples = (std::size_t) std::max(hcpConfig().roadmap_graph_no_samples, 0);
+  bool reset = false;
+  if (samples_.size() != no_samples || edge_cache_.size() != no_samples*no_samples)
+  {
+    samples_.resize(no_samples);
+    EdgeState unknown = {EdgeState::Unknown, 0, 0};
+    edge_cache_.assign(no_samples*no_samples, unknown);
+    reset = true;
+  }
+
+  Eigen::Rotation2D<double> rot_inv = rot_phi.inverse();
+  for (std::size_t i=0; i < no_samples; ++i)
+  {
+    if (!reset)
     {
-      if (it_i==it_j) // same vertex found
+      // keep keypoints that are still located inside the sampling area
+      Eigen::Vector2d local = rot_inv*(samples_[i] - area_origin);
+      if (local.x() >= 0 && local.x() <= area_length && local.y() >= 0 && local.y() <= area_width)
         continue;
+    }
 
-      Eigen::Vector2d distij = graph_[*it_j].pos-graph_[*it_i].pos;
-      distij.normalize(); // normalize in place
+    // draw the next element of the Halton sequence (bases 2 and 3)
+    ++halton_index_;
+    samples_[i] = area_origin + rot_phi*Eigen::Vector2d(radicalInverse(halton_index_, 2)*area_length, radicalInverse(halton_index_, 3)*area_width);
 
-      // Check if the direction is backwards:
-      if (distij.dot(diff)<=obstacle_heading_threshold)
-          continue; // diff is already normalized
+    // all edges of this keypoint are unknown now
+    for (std::size_t k=0; k < no_samples; ++k)
+      edge_cache_[std::min(i, k)*no_samples + std::max(i, k)].state = EdgeState::Unknown;
+  }
+}
 
 
-      // Collision Check
-      bool collision = false;
-      for (ObstContainer::const_iterator it_obst = hcp_->obstacles()->begin(); it_obst != hcp_->obstacles()->end(); ++it_obst)
+void ProbRoadmapGraph::updateObstacleSnapshot(double dist_to_obst)
+{
+  if (dist_to_obst != roadmap_dist_to_obst_)
+  {
+    for (std::size_t i=0; i < edge_cache_.size(); ++i)
+      edge_cache_[i].state = EdgeState::Unknown;
+    roadmap_dist_to_obst_ = dist_to_obst;
+  }
+
+  ++cycle_;
+  previous_obstacle_keys_.swap(current_obstacle_keys_);
+  current_obstacle_keys_.clear();
+  obstacle_keys_.clear();
+  added_obstacles_.clear();
+  added_obstacle_keys_.clear();
+
+  const ObstContainer* obstacles = this->obstacles();
+  if (obstacles != NULL)
+  {
+    obstacle_keys_.reserve(obstacles->size());
+    for (ObstContainer::const_iterator it_obst = obstacles->begin(); it_obst != obstacles->end(); ++it_obst)
+    {
+      std::size_t key = obstacleKey(**it_obst);
+      obstacle_keys_.push_back(key);
+      if (key != 0)
+        current_obstacle_keys_.insert(key);
+
+      // obstacles of unknown extent are always treated as new
+      if (key == 0 || previous_obstacle_keys_.count(key) == 0)
       {
-        if ( (*it_obst)->checkLineIntersection(graph_[*it_i].pos,graph_[*it_j].pos, dist_to_obst) )
-        {
-          collision = true;
-          break;
-        }
+        added_obstacles_.push_back(*it_obst);
+        added_obstacle_keys_.push_back(key);
       }
-      if (collision)
-        continue;
-
-      // Create Edge
-      boost::add_edge(*it_i,*it_j,graph_);
     }
   }
+  added_obstacle_grid_.build(&added_obstacles_, dist_to_obst);
+}
+
+
+std::size_t ProbRoadmapGraph::obstacleKey(const Obstacle& obst)
+{
+  Eigen::Vector2d min, max;
+  if (!ObstacleGrid::boundingBox(obst, min, max) || !min.allFinite() || !max.allFinite())
+    return 0;
+
+  // obstacles are identified by their bounding box (1 cm resolution)
+  std::size_t key = 0;
+  boost::hash_combine(key, std::floor(min.x()*100 + 0.5));
+  boost::hash_combine(key, std::floor(min.y()*100 + 0.5));
+  boost::hash_combine(key, std::floor(max.x()*100 + 0.5));
+  boost::hash_combine(key, std::floor(max.y()*100 + 0.5));
+  return key != 0 ? key : 1;
+}
+
 
-  /// Find all paths between start and goal!
-  std::vector<HcGraphVertexType> visited;
-  visited.push_back(start_vtx);
-  DepthFirst(graph_,visited,goal_vtx, start.theta(), goal.theta(), start_velocity, free_goal_vel);
+double ProbRoadmapGraph::radicalInverse(unsigned int index, unsigned int base)
+{
+  const double inv_base = 1.0 / base;
+  double factor = inv_base;
+  double result = 0;
+  while (index > 0)
+  {
+    result += factor * (index % base);
+    index /= base;
+    factor *= inv_base;
+  }
+  return result;
 }
 
 } // end namespace
@@ -37,24 +37,31 @@
  *********************************************************************/
 
 #include <teb_local_planner/homotopy_class_planner.h>
+#include <teb_local_planner/latency_profiler.h>
 
+#include <cmath>
 #include <limits>
+#include <unordered_map>
 
 namespace teb_local_planner
 {
 
-HomotopyClassPlanner::HomotopyClassPlanner() : cfg_(NULL), obstacles_(NULL), via_points_(NULL), robot_model_(new PointRobotFootprint()), initial_plan_(NULL), initialized_(false)
+HomotopyClassPlanner::HomotopyClassPlanner() : cfg_(NULL), obstacles_(NULL), via_points_(NULL), robot_model_(new PointRobotFootprint()), initial_plan_(NULL),
+                                               exploration_running_(false), exploration_generation_(0), initialized_(false)
 {
 }
 
 HomotopyClassPlanner::HomotopyClassPlanner(const TebConfig& cfg, ObstContainer* obstacles, RobotFootprintModelPtr robot_model,
-                                           TebVisualizationPtr visual, const ViaPointContainer* via_points) : initial_plan_(NULL)
+                                           TebVisualizationPtr visual, const ViaPointContainer* via_points) : initial_plan_(NULL),
+                                           exploration_running_(false), exploration_generation_(0)
 {
   initialize(cfg, obstacles, robot_model, visual, via_points);
 }
 
 HomotopyClassPlanner::~HomotopyClassPlanner()
 {
+  // wait for a pending exploration before any member it accesses is destroyed
+  exploration_worker_.reset();
 }
 
 void HomotopyClassPlanner::initialize(const TebConfig& cfg, ObstContainer* obstacles, RobotFootprintModelPtr robot_model,
@@ -66,9 +73,15 @@ void HomotopyClassPlanner::initialize(const TebConfig& cfg, ObstContainer* obsta
   robot_model_ = robot_model;
 
   if (cfg_->hcp.simple_exploration)
+  {
     graph_search_ = boost::shared_ptr<GraphSearchInterface>(new lrKeyPointGraph(*cfg_, this));
+    async_graph_search_ = boost::shared_ptr<GraphSearchInterface>(new lrKeyPointGraph(*cfg_, this));
+  }
   else
+  {
     graph_search_ = boost::shared_ptr<GraphSearchInterface>(new ProbRoadmapGraph(*cfg_, this));
+    async_graph_search_ = boost::shared_ptr<GraphSearchInterface>(new ProbRoadmapGraph(*cfg_, this));
+  }
 
   std::random_device rd;
   random_.seed(rd());
@@ -154,7 +167,9 @@ void HomotopyClassPlanner::visualize()
   if (visualization_)
   {
     // Visualize graph
-    if (cfg_->hcp.visualize_hc_graph && graph_search_)
+    if (cfg_->hcp.visualize_hc_graph && cfg_->hcp.async_exploration)
+      visualization_->publishGraph(async_graph_);
+    else if (cfg_->hcp.visualize_hc_graph && graph_search_)
       visualization_->publishGraph(graph_search_->graph_);
 
     // Visualize active tebs as marker
@@ -224,6 +239,15 @@ void HomotopyClassPlanner::renewAndAnalyzeOldTebs(bool delete_detours)
   // clear old h-signatures (since they could be changed due to new obstacle positions.
   equivalence_classes_.clear();
 
+  // signatures of the previous cycle: contributions of obstacles that (relative to the trajectory) barely moved are reused
+  std::unordered_map<const TebOptimalPlanner*, EquivalenceClassPtr> previous_eq_classes;
+  previous_eq_classes.swap(teb_eq_class_cache_);
+  auto previous_eq_class = [&previous_eq_classes](const TebOptimalPlanner* teb)
+  {
+    auto it = previous_eq_classes.find(teb);
+    return it != previous_eq_classes.end() ? it->second : EquivalenceClassPtr();
+  };
+
   // Adding the equivalence class of the latest best_teb_ first
   TebOptPlannerContainer::iterator it_best_teb = best_teb_ ? std::find(tebs_.begin(), tebs_.end(), best_teb_) : tebs_.end();
   bool has_best_teb = it_best_teb != tebs_.end();
@@ -231,8 +255,9 @@ void HomotopyClassPlanner::renewAndAnalyzeOldTebs(bool delete_detours)
   {
     std::iter_swap(tebs_.begin(), it_best_teb);  // Putting the last best teb at the beginning of the container
     best_teb_eq_class_ = calculateEquivalenceClass(best_teb_->teb().poses().begin(),
-      best_teb_->teb().poses().end(), getCplxFromVertexPosePtr , obstacles_,
-      best_teb_->teb().timediffs().begin(), best_teb_->teb().timediffs().end());
+      best_teb_->teb().poses().end(), getCplxFromVertexPosePtr , &hsignature_obstacles_,
+      best_teb_->teb().timediffs().begin(), best_teb_->teb().timediffs().end(), previous_eq_class(best_teb_.get()));
+    teb_eq_class_cache_[best_teb_.get()] = best_teb_eq_class_;
     addEquivalenceClassIfNew(best_teb_eq_class_);
   }
   // Collect h-signatures for all existing TEBs and store them together with the corresponding iterator / pointer:
@@ -244,8 +269,9 @@ void HomotopyClassPlanner::renewAndAnalyzeOldTebs(bool delete_detours)
   while(it_teb != tebs_.end())
   {
     // calculate equivalence class for the current candidate
-    EquivalenceClassPtr equivalence_class = calculateEquivalenceClass(it_teb->get()->teb().poses().begin(), it_teb->get()->teb().poses().end(), getCplxFromVertexPosePtr , obstacles_,
-                                                                      it_teb->get()->teb().timediffs().begin(), it_teb->get()->teb().timediffs().end());
+    EquivalenceClassPtr equivalence_class = calculateEquivalenceClass(it_teb->get()->teb().poses().begin(), it_teb->get()->teb().poses().end(), getCplxFromVertexPosePtr , &hsignature_obstacles_,
+                                                                      it_teb->get()->teb().timediffs().begin(), it_teb->get()->teb().timediffs().end(),
+                                                                      previous_eq_class(it_teb->get()));
 
 //     teb_candidates.push_back(std::make_pair(it_teb,H));
 
@@ -257,6 +283,7 @@ void HomotopyClassPlanner::renewAndAnalyzeOldTebs(bool delete_detours)
       it_teb = tebs_.erase(it_teb);
       continue;
     }
+    teb_eq_class_cache_[it_teb->get()] = equivalence_class;
 
     ++it_teb;
   }
@@ -342,8 +369,123 @@ void HomotopyClassPlanner::updateReferenceTrajectoryViaPoints(bool all_trajector
 }
 
 
+void HomotopyClassPlanner::updateHSignatureObstacles(const PoseSE2& start, const PoseSE2& goal)
+{
+  hsignature_obstacles_.clear();
+  if (!obstacles_)
+    return;
+
+  if (!cfg_->hcp.h_signature_filter_obstacles)
+  {
+    hsignature_obstacles_ = *obstacles_;
+    return;
+  }
+
+  const double half_width = 0.5 * cfg_->hcp.h_signature_corridor_width;
+  const double cluster_dist = cfg_->hcp.h_signature_cluster_dist;
+
+  // keep obstacles inside the corridor, collect static point obstacles for clustering
+  std::vector<int> points;
+  for (int i = 0; i < (int)obstacles_->size(); ++i)
+  {
+    const ObstaclePtr& obst = obstacles_->at(i);
+    if (obst->isDynamic())
+    {
+      hsignature_obstacles_.push_back(obst);
+      continue;
+    }
+    if (obst->getMinimumDistance(start.position(), goal.position()) > half_width)
+      continue;
+    if (cluster_dist > 0 && dynamic_cast<const PointObstacle*>(obst.get()))
+      points.push_back(i);
+    else
+      hsignature_obstacles_.push_back(obst);
+  }
+
+  if (points.empty())
+    return;
+
+  // cluster point obstacles: union-find over neighbors found with a hash grid (cell size = cluster_dist)
+  auto cell_key = [](int cx, int cy) {return (static_cast<long long>(cx) << 32) ^ static_cast<unsigned int>(cy);};
+  std::unordered_map<long long, std::vector<int> > grid;
+  grid.reserve(points.size());
+  std::vector<int> parent(points.size());
+  for (int k = 0; k < (int)points.size(); ++k)
+  {
+    parent[k] = k;
+    const Eigen::Vector2d& pos = obstacles_->at(points[k])->getCentroid();
+    grid[cell_key((int)std::floor(pos.x() / cluster_dist), (int)std::floor(pos.y() / cluster_dist))].push_back(k);
+  }
+
+  auto find_root = [&parent](int k)
+  {
+    while (parent[k] != k)
+      k = parent[k] = parent[parent[k]];
+    return k;
+  };
+
+  const double cluster_dist_sq = cluster_dist * cluster_dist;
+  for (int k = 0; k < (int)points.size(); ++k)
+  {
+    const Eigen::Vector2d& pos = obstacles_->at(points[k])->getCentroid();
+    int cx = (int)std::floor(pos.x() / cluster_dist);
+    int cy = (int)std::floor(pos.y() / cluster_dist);
+    for (int nx = cx - 1; nx <= cx + 1; ++nx)
+    {
+      for (int ny = cy - 1; ny <= cy + 1; ++ny)
+      {
+        auto cell = grid.find(cell_key(nx, ny));
+        if (cell == grid.end())
+          continue;
+        for (int other : cell->second)
+        {
+          if (other <= k || (obstacles_->at(points[other])->getCentroid() - pos).squaredNorm() > cluster_dist_sq)
+            continue;
+          parent[find_root(other)] = find_root(k);
+        }
+      }
+    }
+  }
+
+  // compute centroid of each cluster
+  std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > centroid(points.size(), Eigen::Vector2d::Zero());
+  std::vector<int> count(points.size(), 0);
+  for (int k = 0; k < (int)points.size(); ++k)
+  {
+    int root = find_root(k);
+    centroid[root] += obstacles_->at(points[k])->getCentroid();
+    ++count[root];
+  }
+
+  // the representative is the member closest to the centroid (a centroid of a non-convex cluster might lie outside the obstacle)
+  std::vector<int> representative(points.size(), -1);
+  std::vector<double> representative_dist(points.size(), std::numeric_limits<double>::max());
+  for (int k = 0; k < (int)points.size(); ++k)
+  {
+    int root = find_root(k);
+    double dist = (obstacles_->at(points[k])->getCentroid() - centroid[root] / count[root]).squaredNorm();
+    if (dist < representative_dist[root])
+    {
+      representative_dist[root] = dist;
+      representative[root] = k;
+    }
+  }
+
+  for (int k = 0; k < (int)points.size(); ++k)
+  {
+    if (representative[k] >= 0)
+      hsignature_obstacles_.push_back(obstacles_->at(points[representative[k]]));
+  }
+}
+
+
 void HomotopyClassPlanner::exploreEquivalenceClassesAndInitTebs(const PoseSE2& start, const PoseSE2& goal, double dist_to_obst, const geometry_msgs::Twist* start_vel, bool free_goal_vel)
 {
+  TEB_PROFILE_STAGE(Exploration);
+
+  // reduce the obstacle set for computing equivalence classes in this cycle
+  updateHSignatureObstacles(start, goal);
+
   // first process old trajectories
   renewAndAnalyzeOldTebs(cfg_->hcp.delete_detours_backwards);
   randomlyDropTebs();
@@ -359,23 +501,115 @@ void HomotopyClassPlanner::exploreEquivalenceClassesAndInitTebs(const PoseSE2& s
     initial_plan_teb_ = getInitialPlanTEB(); // this method searches for initial_plan_eq_class_ in the teb container (-> if !initial_plan_teb_)
   }
 
+  if (cfg_->hcp.async_exploration)
+  {
+    // initialize tebs explored in the background meanwhile and start the next exploration
+    addExploredTebs(start, goal, start_vel, free_goal_vel);
+    startAsyncExploration(start, goal, dist_to_obst);
+    return;
+  }
+
   // now explore new homotopy classes and initialize tebs if new ones are found. The appropriate createGraph method is chosen via polymorphism.
   graph_search_->createGraph(start,goal,dist_to_obst,cfg_->hcp.obstacle_heading_threshold, start_vel, free_goal_vel);
 }
 
 
+void HomotopyClassPlanner::addExploredTebs(const PoseSE2& start, const PoseSE2& goal, const geometry_msgs::Twist* start_velocity, bool free_goal_vel)
+{
+  std::vector<ExplorationJobPtr> finished;
+  {
+    boost::mutex::scoped_lock lock(exploration_mutex_);
+    finished.swap(finished_explorations_);
+  }
+
+  for (const ExplorationJobPtr& job : finished)
+  {
+    if (job->generation != exploration_generation_)
+      continue; // planner was cleared in the meantime
+
+    if (cfg_->hcp.visualize_hc_graph)
+      async_graph_.swap(job->graph);
+
+    for (ExplorationJob::Path& path : job->seeds)
+    {
+      if ((int)tebs_.size() >= cfg_->hcp.max_number_classes)
+        break;
+      if (path.size() < 2)
+        continue;
+      path.front() = start.position();
+      path.back() = goal.position();
+      addAndInitNewTeb(path.begin(), path.end(), getVector2dFromPoint, start.theta(), goal.theta(), start_velocity, free_goal_vel);
+    }
+  }
+
+  // no candidate available yet (e.g. first cycle or goal already reached)
+  if (tebs_.empty())
+    addAndInitNewTeb(start, goal, start_velocity, free_goal_vel);
+}
+
+
+void HomotopyClassPlanner::startAsyncExploration(const PoseSE2& start, const PoseSE2& goal, double dist_to_obst)
+{
+  {
+    boost::mutex::scoped_lock lock(exploration_mutex_);
+    if (exploration_running_)
+      return; // the previous exploration is still pending
+    exploration_running_ = true;
+  }
+
+  ExplorationJobPtr job = boost::make_shared<ExplorationJob>();
+  job->start = start;
+  job->goal = goal;
+  job->dist_to_obst = dist_to_obst;
+  job->obstacle_heading_threshold = cfg_->hcp.obstacle_heading_threshold;
+  // the exploration thread must not read cfg_, which might be reconfigured in the meantime
+  job->hcp = cfg_->hcp;
+  job->goal_tolerance = cfg_->goal_tolerance;
+  if (obstacles_)
+    job->obstacles = *obstacles_; // obstacles are recreated in each cycle, hence copying the pointers results in a consistent snapshot
+  job->hsignature_obstacles = hsignature_obstacles_;
+  job->max_seeds = cfg_->hcp.max_number_classes + (int)tebs_.size(); // seeds might belong to the classes of existing tebs
+  job->generation = exploration_generation_;
+
+  if (!exploration_worker_)
+    exploration_worker_ = boost::make_shared<WorkerPool>(1, cfg_->hcp.worker_cpu_affinity);
+  exploration_worker_->submit(boost::bind(&HomotopyClassPlanner::runExploration, this, job));
+}
+
+
+void HomotopyClassPlanner::runExploration(ExplorationJobPtr job)
+{
+  try
+  {
+    async_graph_search_->setExplorationJob(job.get());
+    async_graph_search_->createGraph(job->start, job->goal, job->dist_to_obst, job->obstacle_heading_threshold, NULL);
+    if (job->hcp.visualize_hc_graph)
+      job->graph = async_graph_search_->graph_;
+  }
+  catch (const std::exception& e)
+  {
+    ROS_ERROR("HomotopyClassPlanner::runExploration(): exploration failed: %s", e.what());
+  }
+  async_graph_search_->setExplorationJob(NULL);
+
+  boost::mutex::scoped_lock lock(exploration_mutex_);
+  finished_explorations_.push_back(job);
+  exploration_running_ = false;
+}
+
+
 TebOptimalPlannerPtr HomotopyClassPlanner::addAndInitNewTeb(const PoseSE2& start, const PoseSE2& goal, const geometry_msgs::Twist* start_velocity, bool free_goal_vel)
 {
   if(tebs_.size() >= cfg_->hcp.max_number_classes)
     return TebOptimalPlannerPtr();
-  TebOptimalPlannerPtr candidate =  TebOptimalPlannerPtr( new TebOptimalPlanner(*cfg_, obstacles_, robot_model_, visualization_));
+  TebOptimalPlannerPtr candidate = acquireTeb(visualization_);
 
   candidate->teb().initTrajectoryToGoal(start, goal, 0, cfg_->robot.max_vel_x, cfg_->trajectory.min_samples, cfg_->trajectory.allow_init_with_backwards_motion);
 
   if (start_velocity)
     candidate->setVelocityStart(*start_velocity);
 
-  EquivalenceClassPtr H = calculateEquivalenceClass(candidate->teb().poses().begin(), candidate->teb().poses().end(), getCplxFromVertexPosePtr, obstacles_,
+  EquivalenceClassPtr H = calculateEquivalenceClass(candidate->teb().poses().begin(), candidate->teb().poses().end(), getCplxFromVertexPosePtr, &hsignature_obstacles_,
                                                     candidate->teb().timediffs().begin(), candidate->teb().timediffs().end());
 
   if (free_goal_vel)
@@ -384,6 +618,7 @@ TebOptimalPlannerPtr HomotopyClassPlanner::addAndInitNewTeb(const PoseSE2& start
   if(addEquivalenceClassIfNew(H))
   {
     tebs_.push_back(candidate);
+    teb_eq_class_cache_[candidate.get()] = H;
     return tebs_.back();
   }
 
@@ -392,6 +627,49 @@ TebOptimalPlannerPtr HomotopyClassPlanner::addAndInitNewTeb(const PoseSE2& start
 }
 
 
+TebOptimalPlannerPtr HomotopyClassPlanner::acquireTeb(TebVisualizationPtr visualization)
+{
+  // a pooled planner is free if the pool holds the only reference
+  for (TebOptPlannerContainer::iterator it = teb_pool_.begin(); it != teb_pool_.end(); ++it)
+  {
+    if (it->unique())
+    {
+      teb_eq_class_cache_.erase(it->get());
+      it->get()->reset(obstacles_, robot_model_, visualization);
+      return *it;
+    }
+  }
+
+  teb_pool_.push_back( TebOptimalPlannerPtr( new TebOptimalPlanner(*cfg_, obstacles_, robot_model_, visualization)) );
+  if (obstacle_predictions_)
+    teb_pool_.back()->setObstaclePredictions(*obstacle_predictions_);
+  if (global_costmap_)
+    teb_pool_.back()->setGlobalCostmap(*global_costmap_);
+  return teb_pool_.back();
+}
+
+void HomotopyClassPlanner::setObstaclePredictions(const obstacle_prediction::ObstacleArray& predictions)
+{
+  obstacle_predictions_ = boost::make_shared<obstacle_prediction::ObstacleArray>(predictions);
+  for (const TebOptimalPlannerPtr& teb : teb_pool_)
+    teb->setObstaclePredictions(predictions);
+}
+
+void HomotopyClassPlanner::setGlobalCostmap(const nav_msgs::OccupancyGrid& costmap)
+{
+  global_costmap_ = boost::make_shared<nav_msgs::OccupancyGrid>(costmap);
+  for (const TebOptimalPlannerPtr& teb : teb_pool_)
+    teb->setGlobalCostmap(costmap);
+}
+
+unsigned long HomotopyClassPlanner::getSolverIterations() const
+{
+  unsigned long iterations = 0;
+  for (const TebOptimalPlannerPtr& teb : teb_pool_)
+    iterations += teb->getSolverIterations();
+  return iterations;
+}
+
 bool HomotopyClassPlanner::isInBestTebClass(const EquivalenceClassPtr& eq_class) const
 {
   bool answer = false;
@@ -423,7 +701,7 @@ TebOptimalPlannerPtr HomotopyClassPlanner::addAndInitNewTeb(const std::vector<ge
 {
   if(tebs_.size() >= cfg_->hcp.max_number_classes)
     return TebOptimalPlannerPtr();
-  TebOptimalPlannerPtr candidate = TebOptimalPlannerPtr( new TebOptimalPlanner(*cfg_, obstacles_, robot_model_, visualization_));
+  TebOptimalPlannerPtr candidate = acquireTeb(visualization_);
 
   candidate->teb().initTrajectoryToGoal(initial_plan, cfg_->robot.max_vel_x, cfg_->robot.max_vel_theta,
     cfg_->trajectory.global_plan_overwrite_orientation, cfg_->trajectory.min_samples, cfg_->trajectory.allow_init_with_backwards_motion);
@@ -435,12 +713,13 @@ TebOptimalPlannerPtr HomotopyClassPlanner::addAndInitNewTeb(const std::vector<ge
     candidate->setVelocityGoalFree();
 
   // store the h signature of the initial plan to enable searching a matching teb later.
-  initial_plan_eq_class_ = calculateEquivalenceClass(candidate->teb().poses().begin(), candidate->teb().poses().end(), getCplxFromVertexPosePtr, obstacles_,
+  initial_plan_eq_class_ = calculateEquivalenceClass(candidate->teb().poses().begin(), candidate->teb().poses().end(), getCplxFromVertexPosePtr, &hsignature_obstacles_,
                                                      candidate->teb().timediffs().begin(), candidate->teb().timediffs().end());
 
   if(addEquivalenceClassIfNew(initial_plan_eq_class_, true)) // also prevent candidate from deletion
   {
     tebs_.push_back(candidate);
+    teb_eq_class_cache_[candidate.get()] = initial_plan_eq_class_;
     return tebs_.back();
   }
 
@@ -473,31 +752,171 @@ void HomotopyClassPlanner::updateAllTEBs(const PoseSE2* start, const PoseSE2* go
 
 void HomotopyClassPlanner::optimizeAllTEBs(int iter_innerloop, int iter_outerloop)
 {
+  outer_iterations_.assign(tebs_.size(), 0);
+
+  std::vector<int> budget;
+  computeOuterIterations(iter_innerloop, iter_outerloop, budget);
+
+  for (std::size_t i = 0; i < tebs_.size(); ++i)
+  {
+    if (budget[i] <= 0 && outer_iterations_[i] < iter_outerloop)
+      tebs_[i]->setCurrentCost(std::numeric_limits<double>::infinity()); // skipped by lower bound pruning, never selected
+    budget[i] = std::max(0, budget[i] - outer_iterations_[i]); // the incumbents might already be optimized
+  }
+
+  if (cfg_->hcp.optimization_budget_policy != "successive_halving" || tebs_.size() < 3)
+  {
+    if (cfg_->hcp.optimization_budget_policy != "uniform" && cfg_->hcp.optimization_budget_policy != "successive_halving")
+      ROS_WARN_ONCE("HomotopyClassPlanner: unknown optimization_budget_policy '%s', using 'uniform'.", cfg_->hcp.optimization_budget_policy.c_str());
+    optimizeCandidates(iter_innerloop, iter_outerloop, budget);
+    return;
+  }
+
+  // Successive halving: all candidates start with a few outer iterations, after each round only the better half
+  // is optimized further, the remaining candidates are frozen with their current cost. The overall number of outer
+  // iterations does not exceed the uniform allocation. Candidates reduced by lower bound pruning only take part in the first round.
+  std::vector<int> round_iterations(tebs_.size(), 0);
+  std::vector<std::size_t> survivors;
+  for (std::size_t i = 0; i < tebs_.size(); ++i)
+  {
+    if (budget[i] >= iter_outerloop) // neither reduced nor already optimized
+      survivors.push_back(i);
+    else
+      round_iterations[i] = budget[i];
+  }
+
+  int remaining_budget = (int)survivors.size() * iter_outerloop;
+  int num_rounds = 1;
+  while ((1u << num_rounds) < survivors.size())
+    ++num_rounds;
+
+  for (int round = 0; round < num_rounds && !survivors.empty(); ++round)
+  {
+    int iterations = std::max(1, remaining_budget / ((num_rounds - round) * (int)survivors.size()));
+    for (std::size_t idx : survivors)
+      round_iterations[idx] = iterations;
+    remaining_budget -= iterations * (int)survivors.size();
+
+    optimizeCandidates(iter_innerloop, iter_outerloop, round_iterations);
+    std::fill(round_iterations.begin(), round_iterations.end(), 0);
+
+    if (round + 1 < num_rounds)
+    {
+      // rank w.r.t. the cost used in selectBestTeb()
+      std::vector<std::pair<double, std::size_t> > ranking;
+      for (std::size_t idx : survivors)
+      {
+        double cost = tebs_[idx]->getCurrentCost();
+        if (tebs_[idx] == best_teb_)
+          cost *= cfg_->hcp.selection_cost_hysteresis;
+        else if (tebs_[idx] == initial_plan_teb_)
+          cost *= cfg_->hcp.selection_prefer_initial_plan;
+        ranking.push_back(std::make_pair(cost, idx));
+      }
+      std::sort(ranking.begin(), ranking.end());
+      survivors.clear();
+      for (std::size_t j = 0; j < (ranking.size() + 1) / 2; ++j)
+        survivors.push_back(ranking[j].second);
+    }
+  }
+}
+
+void HomotopyClassPlanner::optimizeCandidates(int iter_innerloop, int iter_outerloop, const std::vector<int>& iterations)
+{
+  // The obstacle weights grow with each outer iteration and the cost is computed with the weights of the last one.
+  // Rescale the obstacle cost such that candidates optimized with different numbers of outer iterations remain comparable.
+  const double adapt_factor = cfg_->optim.weight_adapt_factor;
+
   // optimize TEBs in parallel since they are independend of each other
   if (cfg_->hcp.enable_multithreading)
   {
-    // Must prevent .join_all() from throwing exception if interruption was
-    // requested, as this can lead to multiple threads operating on the same
-    // TEB, which leads to SIGSEGV
-    boost::this_thread::disable_interruption di;
+    if (!worker_pool_)
+    {
+      int num_workers = cfg_->hcp.worker_pool_size;
+      if (num_workers <= 0)
+        num_workers = std::max(1, std::min((int)boost::thread::hardware_concurrency(), cfg_->hcp.max_number_classes));
+      worker_pool_ = boost::make_shared<WorkerPool>(num_workers, cfg_->hcp.worker_cpu_affinity);
+    }
 
-    boost::thread_group teb_threads;
-    for (TebOptPlannerContainer::iterator it_teb = tebs_.begin(); it_teb != tebs_.end(); ++it_teb)
+    // Candidates differ a lot in size and number of obstacle edges: start the most expensive ones first
+    // so that the cycle does not end up waiting on a single large candidate started last.
+    for (std::size_t i = 0; i < tebs_.size(); ++i)
     {
-      teb_threads.create_thread( boost::bind(&TebOptimalPlanner::optimizeTEB, it_teb->get(), iter_innerloop, iter_outerloop,
-                                             true, cfg_->hcp.selection_obst_cost_scale, cfg_->hcp.selection_viapoint_cost_scale,
-                                             cfg_->hcp.selection_alternative_time_cost) );
+      if (iterations[i] <= 0)
+        continue;
+      double obst_cost_scale = cfg_->hcp.selection_obst_cost_scale * std::pow(adapt_factor, iter_outerloop - outer_iterations_[i] - iterations[i]);
+      worker_pool_->submit( boost::bind(&TebOptimalPlanner::optimizeTEB, tebs_[i].get(), iter_innerloop, iterations[i],
+                                        true, obst_cost_scale, cfg_->hcp.selection_viapoint_cost_scale,
+                                        cfg_->hcp.selection_alternative_time_cost, std::pow(adapt_factor, outer_iterations_[i])),
+                            tebs_[i]->estimateOptimizationEffort() * iterations[i] );
+      outer_iterations_[i] += iterations[i];
     }
-    teb_threads.join_all();
+    // Must not return before all jobs are finished (even if interruption was requested),
+    // otherwise multiple threads might operate on the same TEB in the next cycle, which leads to SIGSEGV
+    worker_pool_->waitAll();
   }
   else
   {
-    for (TebOptPlannerContainer::iterator it_teb = tebs_.begin(); it_teb != tebs_.end(); ++it_teb)
+    for (std::size_t i = 0; i < tebs_.size(); ++i)
+    {
+      if (iterations[i] <= 0)
+        continue;
+      double obst_cost_scale = cfg_->hcp.selection_obst_cost_scale * std::pow(adapt_factor, iter_outerloop - outer_iterations_[i] - iterations[i]);
+      tebs_[i]->optimizeTEB(iter_innerloop, iterations[i], true, obst_cost_scale, cfg_->hcp.selection_viapoint_cost_scale,
+                            cfg_->hcp.selection_alternative_time_cost, std::pow(adapt_factor, outer_iterations_[i])); // compute cost as well inside optimizeTEB (last argument = true)
+      outer_iterations_[i] += iterations[i];
+    }
+  }
+}
+
+void HomotopyClassPlanner::computeOuterIterations(int iter_innerloop, int iter_outerloop, std::vector<int>& outer_iterations)
+{
+  outer_iterations.assign(tebs_.size(), iter_outerloop);
+
+  if (!cfg_->hcp.selection_lower_bound_pruning || tebs_.size() < 2)
+    return;
+
+  bool best_valid = best_teb_ && std::find(tebs_.begin(), tebs_.end(), best_teb_) != tebs_.end();
+  bool initial_valid = initial_plan_teb_ && std::find(tebs_.begin(), tebs_.end(), initial_plan_teb_) != tebs_.end();
+  if (!best_valid && !initial_valid)
+    return;
+
+  // The costs of the incumbents stem from the previous cycle (or were never computed for a new initial plan teb),
+  // hence optimize them first and compare the remaining candidates against their costs of the current cycle.
+  std::vector<int> incumbent_iterations(tebs_.size(), 0);
+  for (std::size_t i = 0; i < tebs_.size(); ++i)
+  {
+    if ((best_valid && tebs_[i] == best_teb_) || (initial_valid && tebs_[i] == initial_plan_teb_))
+      incumbent_iterations[i] = iter_outerloop;
+  }
+  optimizeCandidates(iter_innerloop, iter_outerloop, incumbent_iterations);
+
+  // cost a candidate has to fall below in order to be selected
+  double threshold = std::numeric_limits<double>::infinity();
+  if (best_valid)
+    threshold = std::min(threshold, best_teb_->getCurrentCost() * cfg_->hcp.selection_cost_hysteresis);
+  if (initial_valid)
+    threshold = std::min(threshold, initial_plan_teb_->getCurrentCost() * cfg_->hcp.selection_prefer_initial_plan);
+  if (!std::isfinite(threshold))
+    return; // optimization of the incumbents failed
+
+  int pruned_iterations = std::min(std::max(cfg_->hcp.selection_pruned_outer_iterations, 0), iter_outerloop);
+  int num_pruned = 0;
+  for (std::size_t i = 0; i < tebs_.size(); ++i)
+  {
+    if (incumbent_iterations[i] > 0)
+      continue; // never prune the incumbents
+
+    double lower_bound = tebs_[i]->computeCostLowerBound(cfg_->hcp.selection_obst_cost_scale, cfg_->hcp.selection_alternative_time_cost);
+    if (lower_bound >= threshold)
     {
-      it_teb->get()->optimizeTEB(iter_innerloop,iter_outerloop, true, cfg_->hcp.selection_obst_cost_scale,
-                                 cfg_->hcp.selection_viapoint_cost_scale, cfg_->hcp.selection_alternative_time_cost); // compute cost as well inside optimizeTEB (last argument = true)
+      outer_iterations[i] = pruned_iterations;
+      ++num_pruned;
     }
   }
+  if (num_pruned > 0)
+    ROS_DEBUG("HomotopyClassPlanner: %d of %d candidates cannot beat the selected trajectory, reduced to %d outer iterations.",
+              num_pruned, (int)tebs_.size(), pruned_iterations);
 }
 
 TebOptimalPlannerPtr HomotopyClassPlanner::getInitialPlanTEB()
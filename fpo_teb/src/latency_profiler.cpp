@@ -0,0 +1,199 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#include <teb_local_planner/latency_profiler.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/make_shared.hpp>
+
+
+namespace teb_local_planner
+{
+
+LatencyProfiler::ThreadHistograms::ThreadHistograms()
+{
+  for (int i = 0; i < NumStages; ++i)
+  {
+    for (int j = 0; j < NumBins; ++j)
+      bins[i][j].store(0, std::memory_order_relaxed);
+    sum[i].store(0, std::memory_order_relaxed);
+    max[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+LatencyProfiler& LatencyProfiler::instance()
+{
+  static LatencyProfiler profiler;
+  return profiler;
+}
+
+LatencyProfiler::ThreadHistograms& LatencyProfiler::localHistograms()
+{
+  static thread_local ThreadHistograms* histograms = NULL;
+  if (!histograms)
+  {
+    boost::shared_ptr<ThreadHistograms> new_histograms = boost::make_shared<ThreadHistograms>();
+    boost::mutex::scoped_lock lock(mutex_);
+    threads_.push_back(new_histograms);
+    histograms = new_histograms.get();
+  }
+  return *histograms;
+}
+
+void LatencyProfiler::record(LatencyStage stage, std::uint64_t nanoseconds)
+{
+  ThreadHistograms& histograms = localHistograms();
+  int idx = static_cast<int>(stage);
+
+  // only the owning thread writes bins and sums, hence a relaxed load/store pair is sufficient
+  std::atomic<std::uint64_t>& bin = histograms.bins[idx][binIndex(nanoseconds)];
+  bin.store(bin.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  histograms.sum[idx].store(histograms.sum[idx].load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+
+  // the maximum is reset by getStatistics()
+  std::uint64_t current_max = histograms.max[idx].load(std::memory_order_relaxed);
+  while (nanoseconds > current_max && !histograms.max[idx].compare_exchange_weak(current_max, nanoseconds, std::memory_order_relaxed)) {}
+}
+
+void LatencyProfiler::getStatistics(std::vector<StageStatistics>& statistics)
+{
+  statistics.clear();
+
+  boost::mutex::scoped_lock lock(mutex_);
+  last_bins_.resize(NumStages * NumBins, 0);
+  last_sum_.resize(NumStages, 0);
+
+  std::vector<std::uint64_t> bins(NumBins);
+  for (int i = 0; i < NumStages; ++i)
+  {
+    std::fill(bins.begin(), bins.end(), 0);
+    std::uint64_t sum = 0;
+    std::uint64_t max = 0;
+    for (const boost::shared_ptr<ThreadHistograms>& thread : threads_)
+    {
+      for (int j = 0; j < NumBins; ++j)
+        bins[j] += thread->bins[i][j].load(std::memory_order_relaxed);
+      sum += thread->sum[i].load(std::memory_order_relaxed);
+      max = std::max(max, thread->max[i].exchange(0, std::memory_order_relaxed));
+    }
+
+    // samples since the previous call
+    std::uint64_t count = 0;
+    for (int j = 0; j < NumBins; ++j)
+    {
+      std::uint64_t total = bins[j];
+      bins[j] -= last_bins_[i * NumBins + j];
+      last_bins_[i * NumBins + j] = total;
+      count += bins[j];
+    }
+    std::uint64_t period_sum = sum - last_sum_[i];
+    last_sum_[i] = sum;
+
+    if (count == 0)
+      continue;
+
+    StageStatistics stats;
+    stats.stage = static_cast<LatencyStage>(i);
+    stats.count = count;
+    stats.mean = (double)period_sum / (double)count * 1e-9;
+    stats.max = (double)max * 1e-9;
+
+    const double quantiles[] = {0.5, 0.9, 0.99};
+    double* results[] = {&stats.median, &stats.p90, &stats.p99};
+    std::uint64_t cumulative = 0;
+    int q = 0;
+    for (int j = 0; j < NumBins && q < 3; ++j)
+    {
+      cumulative += bins[j];
+      while (q < 3 && (double)cumulative >= quantiles[q] * (double)count)
+      {
+        // the bin bound might exceed the actual maximum
+        *results[q] = std::min(binUpperBound(j) * 1e-9, stats.max);
+        ++q;
+      }
+    }
+    statistics.push_back(stats);
+  }
+}
+
+int LatencyProfiler::binIndex(std::uint64_t nanoseconds)
+{
+  if (nanoseconds < 2)
+    return 0;
+  int exponent = 63 - __builtin_clzll(nanoseconds);
+  int half = (nanoseconds >> (exponent - 1)) & 1; // upper or lower half of [2^exponent, 2^(exponent+1))
+  return std::min(2 * exponent + half, NumBins - 1);
+}
+
+double LatencyProfiler::binUpperBound(int bin)
+{
+  int exponent = bin / 2;
+  return bin % 2 == 0 ? 1.5 * std::ldexp(1.0, exponent) : std::ldexp(1.0, exponent + 1);
+}
+
+const char* LatencyProfiler::stageName(LatencyStage stage)
+{
+  switch (stage)
+  {
+    case LatencyStage::Cycle: return "cycle";
+    case LatencyStage::PrunePlan: return "prune_plan";
+    case LatencyStage::TransformPlan: return "transform_plan";
+    case LatencyStage::UpdateViaPoints: return "update_via_points";
+    case LatencyStage::UpdateObstacles: return "update_obstacles";
+    case LatencyStage::Plan: return "plan";
+    case LatencyStage::Exploration: return "exploration";
+    case LatencyStage::BuildGraphVertices: return "build_graph/vertices";
+    case LatencyStage::BuildGraphObstacles: return "build_graph/obstacles";
+    case LatencyStage::BuildGraphViaPoints: return "build_graph/via_points";
+    case LatencyStage::BuildGraphVelocity: return "build_graph/velocity";
+    case LatencyStage::BuildGraphAcceleration: return "build_graph/acceleration";
+    case LatencyStage::BuildGraphTimeOptimal: return "build_graph/time_optimal";
+    case LatencyStage::BuildGraphShortestPath: return "build_graph/shortest_path";
+    case LatencyStage::BuildGraphKinematics: return "build_graph/kinematics";
+    case LatencyStage::BuildGraphPreferRotDir: return "build_graph/prefer_rotdir";
+    case LatencyStage::BuildGraphVelocityObstacleRatio: return "build_graph/velocity_obstacle_ratio";
+    case LatencyStage::OptimizeGraph: return "optimize_graph";
+    case LatencyStage::ComputeCost: return "compute_cost";
+    case LatencyStage::FeasibilityCheck: return "feasibility_check";
+    case LatencyStage::Visualization: return "visualization";
+    default: return "unknown";
+  }
+}
+
+} // namespace teb_local_planner
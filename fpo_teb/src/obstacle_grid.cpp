@@ -0,0 +1,329 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#include <teb_local_planner/obstacle_grid.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace teb_local_planner
+{
+
+ObstacleGrid::ObstacleGrid() : obstacles_(NULL), inflation_(0), origin_(Eigen::Vector2d::Zero()), cell_size_(1), cols_(0), rows_(0), query_id_(0)
+{
+}
+
+
+void ObstacleGrid::clear()
+{
+  obstacles_ = NULL;
+  cols_ = rows_ = 0;
+  cell_start_.clear();
+  cell_items_.clear();
+  unbounded_.clear();
+  boxes_.clear();
+  visited_.clear();
+  query_id_ = 0;
+}
+
+
+void ObstacleGrid::build(const ObstContainer* obstacles, double inflation, int max_cells)
+{
+  clear();
+  obstacles_ = obstacles;
+  inflation_ = std::max(inflation, 0.);
+
+  if (obstacles_ == NULL || obstacles_->empty())
+    return;
+
+  const int n = (int)obstacles_->size();
+  boxes_.resize(n);
+  visited_.assign(n, 0);
+
+  // slightly enlarge boxes such that touching configurations are reported by the exact test
+  const double padding = inflation_ + 1e-6;
+
+  Eigen::Vector2d lower = Eigen::Vector2d::Constant(std::numeric_limits<double>::infinity());
+  Eigen::Vector2d upper = -lower;
+  int no_bounded = 0;
+  for (int i = 0; i < n; ++i)
+  {
+    Eigen::Vector2d min, max;
+    if (!boundingBox(*obstacles_->at(i), min, max) || !min.allFinite() || !max.allFinite())
+    {
+      unbounded_.push_back(i);
+      boxes_[i].setConstant(std::numeric_limits<double>::quiet_NaN());
+      continue;
+    }
+    min.array() -= padding;
+    max.array() += padding;
+    boxes_[i] << min, max;
+    lower = lower.cwiseMin(min);
+    upper = upper.cwiseMax(max);
+    ++no_bounded;
+  }
+
+  if (no_bounded == 0)
+    return;
+
+  // choose the cell size such that each cell contains roughly a single obstacle
+  max_cells = std::max(max_cells, 1);
+  const Eigen::Vector2d extent = (upper - lower).cwiseMax(1e-3);
+  const double area = extent.x() * extent.y();
+  cell_size_ = std::max(std::sqrt(area / no_bounded), std::sqrt(area / max_cells));
+  cols_ = std::max(1, std::min((int)std::ceil(extent.x() / cell_size_), max_cells));
+  rows_ = std::max(1, std::min((int)std::ceil(extent.y() / cell_size_), max_cells));
+  cell_size_ = std::max(cell_size_, std::max(extent.x() / cols_, extent.y() / rows_));
+  origin_ = lower;
+
+  // Counting sort of all (cell, obstacle) pairs into a compact array
+  std::vector<int> cell_range(4 * n);
+  cell_start_.assign(cols_ * rows_ + 1, 0);
+  for (int i = 0; i < n; ++i)
+  {
+    if (std::isnan(boxes_[i][0]))
+      continue;
+    int* range = &cell_range[4 * i];
+    range[0] = std::min(cols_ - 1, std::max(0, (int)std::floor((boxes_[i][0] - origin_.x()) / cell_size_)));
+    range[1] = std::min(rows_ - 1, std::max(0, (int)std::floor((boxes_[i][1] - origin_.y()) / cell_size_)));
+    range[2] = std::min(cols_ - 1, std::max(0, (int)std::floor((boxes_[i][2] - origin_.x()) / cell_size_)));
+    range[3] = std::min(rows_ - 1, std::max(0, (int)std::floor((boxes_[i][3] - origin_.y()) / cell_size_)));
+    for (int iy = range[1]; iy <= range[3]; ++iy)
+      for (int ix = range[0]; ix <= range[2]; ++ix)
+        ++cell_start_[iy * cols_ + ix + 1];
+  }
+  for (std::size_t c = 1; c < cell_start_.size(); ++c)
+    cell_start_[c] += cell_start_[c - 1];
+
+  cell_items_.resize(cell_start_.back());
+  std::vector<int> cursor(cell_start_.begin(), cell_start_.end() - 1);
+  for (int i = 0; i < n; ++i)
+  {
+    if (std::isnan(boxes_[i][0]))
+      continue;
+    const int* range = &cell_range[4 * i];
+    for (int iy = range[1]; iy <= range[3]; ++iy)
+      for (int ix = range[0]; ix <= range[2]; ++ix)
+        cell_items_[cursor[iy * cols_ + ix]++] = i;
+  }
+}
+
+
+bool ObstacleGrid::checkLineIntersection(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, double min_dist, int* obstacle_idx) const
+{
+  if (obstacles_ == NULL || obstacles_->empty())
+    return false;
+
+  if (++query_id_ == 0) // wrap around
+  {
+    std::fill(visited_.begin(), visited_.end(), 0);
+    query_id_ = 1;
+  }
+
+  if (min_dist > inflation_) // index is not valid for this distance
+  {
+    for (std::size_t i = 0; i < obstacles_->size(); ++i)
+    {
+      if ( obstacles_->at(i)->checkLineIntersection(line_start, line_end, min_dist) )
+      {
+        if (obstacle_idx)
+          *obstacle_idx = (int)i;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  for (std::size_t i = 0; i < unbounded_.size(); ++i)
+  {
+    if (testObstacle(unbounded_[i], line_start, line_end, min_dist))
+    {
+      if (obstacle_idx)
+        *obstacle_idx = unbounded_[i];
+      return true;
+    }
+  }
+
+  if (cols_ == 0)
+    return false;
+
+  Eigen::Vector2d start = line_start;
+  Eigen::Vector2d end = line_end;
+  if (!clipSegment(origin_, origin_ + cell_size_ * Eigen::Vector2d(cols_, rows_), start, end))
+    return false;
+
+  // Traverse all cells touched by the segment (Amanatides & Woo)
+  const Eigen::Vector2d a = (start - origin_) / cell_size_;
+  const Eigen::Vector2d b = (end - origin_) / cell_size_;
+  const Eigen::Vector2d d = b - a;
+
+  int ix = std::min(cols_ - 1, std::max(0, (int)std::floor(a.x())));
+  int iy = std::min(rows_ - 1, std::max(0, (int)std::floor(a.y())));
+  const int ex = std::min(cols_ - 1, std::max(0, (int)std::floor(b.x())));
+  const int ey = std::min(rows_ - 1, std::max(0, (int)std::floor(b.y())));
+
+  const double inf = std::numeric_limits<double>::infinity();
+  const int step_x = d.x() > 0 ? 1 : -1;
+  const int step_y = d.y() > 0 ? 1 : -1;
+  const double delta_x = d.x() != 0 ? 1.0 / std::abs(d.x()) : inf;
+  const double delta_y = d.y() != 0 ? 1.0 / std::abs(d.y()) : inf;
+  double t_max_x = d.x() != 0 ? ((ix + (step_x > 0 ? 1 : 0)) - a.x()) / d.x() : inf;
+  double t_max_y = d.y() != 0 ? ((iy + (step_y > 0 ? 1 : 0)) - a.y()) / d.y() : inf;
+
+  for (int iter = 0; iter <= cols_ + rows_; ++iter)
+  {
+    const int cell = iy * cols_ + ix;
+    for (int k = cell_start_[cell]; k < cell_start_[cell + 1]; ++k)
+    {
+      if (testObstacle(cell_items_[k], line_start, line_end, min_dist))
+      {
+        if (obstacle_idx)
+          *obstacle_idx = cell_items_[k];
+        return true;
+      }
+    }
+
+    if (ix == ex && iy == ey)
+      break;
+
+    if (t_max_x < t_max_y)
+    {
+      ix += step_x;
+      t_max_x += delta_x;
+    }
+    else
+    {
+      iy += step_y;
+      t_max_y += delta_y;
+    }
+    if (ix < 0 || ix >= cols_ || iy < 0 || iy >= rows_)
+      break;
+  }
+  return false;
+}
+
+
+bool ObstacleGrid::testObstacle(int idx, const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end, double min_dist) const
+{
+  if (visited_[idx] == query_id_)
+    return false;
+  visited_[idx] = query_id_;
+
+  // cheap rejection based on the inflated bounding box
+  if (!std::isnan(boxes_[idx][0]))
+  {
+    Eigen::Vector2d start = line_start;
+    Eigen::Vector2d end = line_end;
+    if (!clipSegment(boxes_[idx].head<2>(), boxes_[idx].tail<2>(), start, end))
+      return false;
+  }
+  return obstacles_->at(idx)->checkLineIntersection(line_start, line_end, min_dist);
+}
+
+
+bool ObstacleGrid::clipSegment(const Eigen::Vector2d& min, const Eigen::Vector2d& max, Eigen::Vector2d& line_start, Eigen::Vector2d& line_end)
+{
+  const Eigen::Vector2d d = line_end - line_start;
+  double t0 = 0;
+  double t1 = 1;
+  for (int i = 0; i < 2; ++i)
+  {
+    if (d[i] == 0)
+    {
+      if (line_start[i] < min[i] || line_start[i] > max[i])
+        return false;
+      continue;
+    }
+    double t_near = (min[i] - line_start[i]) / d[i];
+    double t_far = (max[i] - line_start[i]) / d[i];
+    if (t_near > t_far)
+      std::swap(t_near, t_far);
+    t0 = std::max(t0, t_near);
+    t1 = std::min(t1, t_far);
+    if (t0 > t1)
+      return false;
+  }
+  const Eigen::Vector2d start = line_start;
+  line_start = start + t0 * d;
+  line_end = start + t1 * d;
+  return true;
+}
+
+
+bool ObstacleGrid::boundingBox(const Obstacle& obst, Eigen::Vector2d& min, Eigen::Vector2d& max)
+{
+  if (dynamic_cast<const PointObstacle*>(&obst))
+  {
+    min = max = obst.getCentroid();
+    return true;
+  }
+  if (const CircularObstacle* circle = dynamic_cast<const CircularObstacle*>(&obst))
+  {
+    min = circle->position().array() - circle->radius();
+    max = circle->position().array() + circle->radius();
+    return true;
+  }
+  if (const LineObstacle* line = dynamic_cast<const LineObstacle*>(&obst))
+  {
+    min = line->start().cwiseMin(line->end());
+    max = line->start().cwiseMax(line->end());
+    return true;
+  }
+  if (const PillObstacle* pill = dynamic_cast<const PillObstacle*>(&obst))
+  {
+    const double radius = -pill->getMinimumDistance(pill->start()); // the radius is not exposed
+    min = pill->start().cwiseMin(pill->end()).array() - radius;
+    max = pill->start().cwiseMax(pill->end()).array() + radius;
+    return true;
+  }
+  if (const PolygonObstacle* polygon = dynamic_cast<const PolygonObstacle*>(&obst))
+  {
+    if (polygon->vertices().empty())
+      return false;
+    min = max = polygon->vertices().front();
+    for (Point2dContainer::const_iterator it = polygon->vertices().begin(); it != polygon->vertices().end(); ++it)
+    {
+      min = min.cwiseMin(*it);
+      max = max.cwiseMax(*it);
+    }
+    return true;
+  }
+  return false;
+}
+
+} // namespace teb_local_planner
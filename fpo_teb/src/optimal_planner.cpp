@@ -49,9 +49,12 @@
 #include <teb_local_planner/g2o_types/edge_dynamic_obstacle.h>
 #include <teb_local_planner/g2o_types/edge_via_point.h>
 #include <teb_local_planner/g2o_types/edge_prefer_rotdir.h>
+#include <teb_local_planner/footprint_costmap_model.h>
+#include <teb_local_planner/latency_profiler.h>
 
 #include <memory>
 #include <limits>
+#include <cmath>
 
 namespace teb_local_planner
 {
@@ -59,15 +62,20 @@ namespace teb_local_planner
   // ============== Implementation ===================
 
   TebOptimalPlanner::TebOptimalPlanner() : cfg_(NULL), obstacles_(NULL), via_points_(NULL), cost_(HUGE_VAL), prefer_rotdir_(RotType::none),
-                                           robot_model_(new PointRobotFootprint()), initialized_(false), optimized_(false)
+                                           robot_model_(new PointRobotFootprint()), initialized_(false), optimized_(false), solver_iterations_(0)
   {
   }
 
   TebOptimalPlanner::TebOptimalPlanner(const TebConfig &cfg, ObstContainer *obstacles, RobotFootprintModelPtr robot_model, TebVisualizationPtr visual, const ViaPointContainer *via_points)
+    : solver_iterations_(0)
   {
-    ros::NodeHandle nh;
-    sub_obst = nh.subscribe("/obst_arr", 1, &TebOptimalPlanner::obstacle_arr_cb, this);
-    sub_costmap = nh.subscribe("/move_base/global_costmap/costmap", 1, &TebOptimalPlanner::global_costmap_cb, this);
+    // without ROS (e.g. offline replay) predictions and costmap are assigned explicitly
+    if (ros::isInitialized())
+    {
+      ros::NodeHandle nh;
+      sub_obst = nh.subscribe("/obst_arr", 1, &TebOptimalPlanner::obstacle_arr_cb, this);
+      sub_costmap = nh.subscribe("/move_base/global_costmap/costmap", 1, &TebOptimalPlanner::global_costmap_cb, this);
+    }
     initialize(cfg, obstacles, robot_model, visual, via_points);
   }
 
@@ -158,11 +166,27 @@ namespace teb_local_planner
     optimizer_ = initOptimizer();
 
     cfg_ = &cfg;
+    reset(obstacles, robot_model, visual, via_points);
+    initialized_ = true;
+  }
+
+  void TebOptimalPlanner::reset(ObstContainer *obstacles, RobotFootprintModelPtr robot_model, TebVisualizationPtr visual, const ViaPointContainer *via_points)
+  {
+    clearGraph();
+    teb_.clearTimedElasticBand();
+    if (optimizer_)
+      optimizer_->batchStatistics().clear();
+
+    // drop the obstacle association entirely: estimateOptimizationEffort() must not mistake
+    // the emptied entries of the previous trajectory for poses without obstacles
+    obstacles_per_vertex_.clear();
+
     obstacles_ = obstacles;
     robot_model_ = robot_model;
     via_points_ = via_points;
     cost_ = HUGE_VAL;
     prefer_rotdir_ = RotType::none;
+    optimized_ = false;
     setVisualization(visual);
 
     vel_start_.first = true;
@@ -174,7 +198,6 @@ namespace teb_local_planner
     vel_goal_.second.linear.x = 0;
     vel_goal_.second.linear.y = 0;
     vel_goal_.second.angular.z = 0;
-    initialized_ = true;
   }
 
   void TebOptimalPlanner::setVisualization(TebVisualizationPtr visualization)
@@ -251,7 +274,8 @@ namespace teb_local_planner
   }
 
   bool TebOptimalPlanner::optimizeTEB(int iterations_innerloop, int iterations_outerloop, bool compute_cost_afterwards,
-                                      double obst_cost_scale, double viapoint_cost_scale, bool alternative_time_cost)
+                                      double obst_cost_scale, double viapoint_cost_scale, bool alternative_time_cost,
+                                      double initial_weight_multiplier)
   {
     if (cfg_->optim.optimization_activate == false)
       return false;
@@ -259,7 +283,7 @@ namespace teb_local_planner
     bool success = false;
     optimized_ = false;
 
-    double weight_multiplier = 1.0;
+    double weight_multiplier = initial_weight_multiplier;
 
     // TODO(roesmann): we introduced the non-fast mode with the support of dynamic obstacles
     //                (which leads to better results in terms of x-y-t homotopy planning).
@@ -408,36 +432,66 @@ namespace teb_local_planner
     optimizer_->setComputeBatchStatistics(cfg_->recovery.divergence_detection_enable);
 
     // add TEB vertices
-    AddTEBVertices();
+    {
+      TEB_PROFILE_STAGE(BuildGraphVertices);
+      AddTEBVertices();
+    }
 
     // add Edges (local cost functions)
     // if (cfg_->obstacles.legacy_obstacle_association)
     // AddEdgesObstaclesLegacy(weight_multiplier);
 
-    if (cfg_->obstacles.include_dynamic_obstacles)
-      AddEdgesDynamicObstacles(weight_multiplier);
-    else
-      AddEdgesObstacles(weight_multiplier);
+    {
+      TEB_PROFILE_STAGE(BuildGraphObstacles);
+      if (cfg_->obstacles.include_dynamic_obstacles)
+        AddEdgesDynamicObstacles(weight_multiplier);
+      else
+        AddEdgesObstacles(weight_multiplier);
+    }
 
-    AddEdgesViaPoints();
+    {
+      TEB_PROFILE_STAGE(BuildGraphViaPoints);
+      AddEdgesViaPoints();
+    }
 
-    AddEdgesVelocity();
+    {
+      TEB_PROFILE_STAGE(BuildGraphVelocity);
+      AddEdgesVelocity();
+    }
 
-    AddEdgesAcceleration();
+    {
+      TEB_PROFILE_STAGE(BuildGraphAcceleration);
+      AddEdgesAcceleration();
+    }
 
-    AddEdgesTimeOptimal();
+    {
+      TEB_PROFILE_STAGE(BuildGraphTimeOptimal);
+      AddEdgesTimeOptimal();
+    }
 
-    AddEdgesShortestPath();
+    {
+      TEB_PROFILE_STAGE(BuildGraphShortestPath);
+      AddEdgesShortestPath();
+    }
 
-    if (cfg_->robot.min_turning_radius == 0 || cfg_->optim.weight_kinematics_turning_radius == 0)
-      AddEdgesKinematicsDiffDrive(); // we have a differential drive robot
-    else
-      AddEdgesKinematicsCarlike(); // we have a carlike robot since the turning radius is bounded from below.
+    {
+      TEB_PROFILE_STAGE(BuildGraphKinematics);
+      if (cfg_->robot.min_turning_radius == 0 || cfg_->optim.weight_kinematics_turning_radius == 0)
+        AddEdgesKinematicsDiffDrive(); // we have a differential drive robot
+      else
+        AddEdgesKinematicsCarlike(); // we have a carlike robot since the turning radius is bounded from below.
+    }
 
-    AddEdgesPreferRotDir();
+    {
+      TEB_PROFILE_STAGE(BuildGraphPreferRotDir);
+      AddEdgesPreferRotDir();
+    }
 
     if (cfg_->optim.weight_velocity_obstacle_ratio > 0)
+    {
+      TEB_PROFILE_STAGE(BuildGraphVelocityObstacleRatio);
       AddEdgesVelocityObstacleRatio();
+    }
 
     return true;
   }
@@ -460,10 +514,16 @@ namespace teb_local_planner
       return false;
     }
 
-    optimizer_->setVerbose(cfg_->optim.optimization_verbose);
-    optimizer_->initializeOptimization();
+    int iter;
+    {
+      TEB_PROFILE_STAGE(OptimizeGraph);
+      optimizer_->setVerbose(cfg_->optim.optimization_verbose);
+      optimizer_->initializeOptimization();
 
-    int iter = optimizer_->optimize(no_iterations);
+      iter = optimizer_->optimize(no_iterations);
+    }
+    if (iter > 0)
+      solver_iterations_ += iter;
 
     // Save Hessian for visualization
     //  g2o::OptimizationAlgorithmLevenberg* lm = dynamic_cast<g2o::OptimizationAlgorithmLevenberg*> (optimizer_->solver());
@@ -557,6 +617,10 @@ namespace teb_local_planner
 
     // iterate all teb points, skipping the last and, if the EdgeVelocityObstacleRatio edges should not be created, the first one too
     const int first_vertex = cfg_->optim.weight_velocity_obstacle_ratio == 0 ? 1 : 0;
+
+    // we handle dynamic obstacles differently below
+    Eigen::Map<Eigen::ArrayXXd> distances = calculateObstacleDistances(first_vertex, teb_.sizePoses() - 1, cfg_->obstacles.include_dynamic_obstacles);
+
     for (int i = first_vertex; i < teb_.sizePoses() - 1; ++i)
     {
       double left_min_dist = std::numeric_limits<double>::max();
@@ -567,14 +631,16 @@ namespace teb_local_planner
       const Eigen::Vector2d pose_orient = teb_.Pose(i).orientationUnitVec();
 
       // iterate obstacles
-      for (const ObstaclePtr &obst : *obstacles_)
+      for (std::size_t j = 0; j < obstacles_->size(); ++j)
       {
+        const ObstaclePtr &obst = (*obstacles_)[j];
+
         // we handle dynamic obstacles differently below
         if (cfg_->obstacles.include_dynamic_obstacles && obst->isDynamic())
           continue;
 
-        // calculate distance to robot model
-        double dist = robot_model_->calculateDistance(teb_.Pose(i), obst.get());
+        // distance to robot model
+        double dist = distances(i - first_vertex, j);
 
         // force considering obstacle if really close to the current pose
         if (dist < cfg_->obstacles.min_obstacle_dist * cfg_->obstacles.obstacle_association_force_inclusion_factor)
@@ -749,12 +815,15 @@ namespace teb_local_planner
     float time_diff_sum = 0;
     if (this->global_costmap.data.size() > 0)
     {
+      Eigen::Map<Eigen::ArrayXXd> distances = calculateObstacleDistances(1, teb_.sizePoses() - 1, false);
+
       for (int i = 1; i < teb_.sizePoses() - 1; i++)
       {
         // 添加静态障碍物
-        for (const ObstaclePtr &obst : *obstacles_)
+        for (std::size_t j = 0; j < obstacles_->size(); ++j)
         {
-          double dist = robot_model_->calculateDistance(teb_.Pose(i), obst.get());
+          const ObstaclePtr &obst = (*obstacles_)[j];
+          double dist = distances(i - 1, j);
           // force considering obstacle if really close to the current pose
           float x = obst->getCentroid().x();
           float y = obst->getCentroid().y();
@@ -809,6 +878,35 @@ namespace teb_local_planner
     }
   }
 
+  Eigen::Map<Eigen::ArrayXXd> TebOptimalPlanner::calculateObstacleDistances(int first_pose, int last_pose, bool skip_dynamic)
+  {
+    const int num_poses = std::max(0, last_pose - first_pose);
+    const int num_obstacles = obstacles_ ? (int)obstacles_->size() : 0;
+    obstacle_distances_.resize((std::size_t)num_poses * num_obstacles); // keeps the capacity
+    Eigen::Map<Eigen::ArrayXXd> distances(obstacle_distances_.data(), num_poses, num_obstacles);
+    distances.setConstant(std::numeric_limits<double>::infinity());
+    if (num_poses == 0 || num_obstacles == 0)
+      return distances;
+
+    Eigen::ArrayXd poses_x(num_poses), poses_y(num_poses), poses_theta(num_poses);
+    for (int i = 0; i < num_poses; ++i)
+    {
+      const PoseSE2& pose = teb_.Pose(first_pose + i);
+      poses_x[i] = pose.x();
+      poses_y[i] = pose.y();
+      poses_theta[i] = pose.theta();
+    }
+
+    // evaluate each obstacle for all poses at once, which allows the footprint and obstacle models to vectorize
+    for (std::size_t j = 0; j < obstacles_->size(); ++j)
+    {
+      if (skip_dynamic && (*obstacles_)[j]->isDynamic())
+        continue;
+      robot_model_->calculateDistances(poses_x, poses_y, poses_theta, (*obstacles_)[j].get(), distances.col(j));
+    }
+    return distances;
+  }
+
   void TebOptimalPlanner::AddEdgesViaPoints()
   {
     if (cfg_->optim.weight_viapoint == 0 || via_points_ == NULL || via_points_->empty())
@@ -1169,8 +1267,75 @@ namespace teb_local_planner
     return last_iter_stats.chi2 > cfg_->recovery.divergence_detection_max_chi_squared;
   }
 
+  double TebOptimalPlanner::estimateOptimizationEffort() const
+  {
+    double obst_per_pose = (obstacles_ && !obstacles_->empty()) ? 2.0 : 0.0;
+    if (!obstacles_per_vertex_.empty())
+    {
+      std::size_t num_associations = 0;
+      for (const ObstContainer& obst : obstacles_per_vertex_)
+        num_associations += obst.size();
+      obst_per_pose = (double)num_associations / (double)obstacles_per_vertex_.size();
+    }
+    return (double)teb_.sizePoses() * (1.0 + obst_per_pose);
+  }
+
+  double TebOptimalPlanner::computeCostLowerBound(double obst_cost_scale, bool alternative_time_cost) const
+  {
+    if (teb_.sizePoses() < 2)
+      return 0;
+
+    double bound = 0;
+
+    // minimum transition time along the current path
+    double max_vel = std::max(cfg_->robot.max_vel_x, cfg_->robot.max_vel_x_backwards);
+    max_vel = std::max(max_vel, std::max(cfg_->robot.max_vel_trans, std::hypot(cfg_->robot.max_vel_x, cfg_->robot.max_vel_y)));
+    if (max_vel > 0)
+    {
+      double min_time = teb_.getAccumulatedDistance() / max_vel;
+      if (alternative_time_cost)
+        bound += min_time;
+      else if (cfg_->optim.weight_optimaltime > 0)
+      {
+        // sum of squared time differences (Cauchy-Schwarz for a fixed number of samples)
+        double sum_sq_dt = min_time * min_time / (double)teb_.sizeTimeDiffs();
+        if (cfg_->trajectory.teb_autosize)
+        {
+          // autoResize() keeps dt above dt_ref-dt_hysteresis unless the trajectory is reduced to min_samples
+          sum_sq_dt = std::min(min_time * std::max(0.0, cfg_->trajectory.dt_ref - cfg_->trajectory.dt_hysteresis),
+                               min_time * min_time / (double)std::max(1, cfg_->trajectory.min_samples - 1));
+        }
+        bound += cfg_->optim.weight_optimaltime * sum_sq_dt;
+      }
+    }
+
+    // penalties of poses that are already in collision with one of their associated static obstacles
+    // (association of the previous optimization, ignoring further obstacles only loosens the bound)
+    if (obstacles_ && cfg_->optim.weight_obstacle > 0)
+    {
+      int num_poses = std::min(teb_.sizePoses(), (int)obstacles_per_vertex_.size());
+      for (int i = 0; i < num_poses; ++i)
+      {
+        double min_dist = 0;
+        for (const ObstaclePtr& obst : obstacles_per_vertex_[i])
+        {
+          if (!obst->isDynamic())
+            min_dist = std::min(min_dist, robot_model_->calculateDistance(teb_.Pose(i), obst.get()));
+        }
+        if (min_dist < 0)
+        {
+          double penalty = penaltyBoundFromBelow(min_dist, cfg_->obstacles.min_obstacle_dist, cfg_->optim.penalty_epsilon);
+          bound += cfg_->optim.weight_obstacle * obst_cost_scale * penalty * penalty;
+        }
+      }
+    }
+    return bound;
+  }
+
   void TebOptimalPlanner::computeCurrentCost(double obst_cost_scale, double viapoint_cost_scale, bool alternative_time_cost)
   {
+    TEB_PROFILE_STAGE(ComputeCost);
+
     // check if graph is empty/exist  -> important if function is called between buildGraph and optimizeGraph/clearGraph
     bool graph_exist_flag(false);
     if (optimizer_->edges().empty() && optimizer_->vertices().empty())
@@ -1380,9 +1545,18 @@ namespace teb_local_planner
     if (look_ahead_idx < 0 || look_ahead_idx >= teb().sizePoses())
       look_ahead_idx = teb().sizePoses() - 1;
 
+    // a FootprintCostmapModel checks the precomputed outline cells instead of rasterizing the footprint for each pose
+    FootprintCostmapModel* cached_model = dynamic_cast<FootprintCostmapModel*>(costmap_model);
+    auto footprint_cost = [&](const PoseSE2& pose) -> double
+    {
+      if (cached_model)
+        return cached_model->cachedFootprintCost(pose.x(), pose.y(), pose.theta(), footprint_spec);
+      return costmap_model->footprintCost(pose.x(), pose.y(), pose.theta(), footprint_spec, inscribed_radius, circumscribed_radius);
+    };
+
     for (int i = 0; i <= look_ahead_idx; ++i)
     {
-      if (costmap_model->footprintCost(teb().Pose(i).x(), teb().Pose(i).y(), teb().Pose(i).theta(), footprint_spec, inscribed_radius, circumscribed_radius) == -1)
+      if (footprint_cost(teb().Pose(i)) == -1)
       {
         if (visualization_)
         {
@@ -1409,8 +1583,7 @@ namespace teb_local_planner
             intermediate_pose.position() = intermediate_pose.position() + delta_dist / (n_additional_samples + 1.0);
             intermediate_pose.theta() = g2o::normalize_theta(intermediate_pose.theta() +
                                                              delta_rot / (n_additional_samples + 1.0));
-            if (costmap_model->footprintCost(intermediate_pose.x(), intermediate_pose.y(), intermediate_pose.theta(),
-                                             footprint_spec, inscribed_radius, circumscribed_radius) == -1)
+            if (footprint_cost(intermediate_pose) == -1)
             {
               if (visualization_)
               {
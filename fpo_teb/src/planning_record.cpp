@@ -0,0 +1,1021 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#include <teb_local_planner/planning_record.h>
+
+#include <cstring>
+#include <map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <ros/serialization.h>
+#include <tf/transform_datatypes.h>
+
+
+namespace teb_local_planner
+{
+
+namespace
+{
+
+const char LogMagic[] = {'T', 'E', 'B', 'L', 'O', 'G'};
+const std::uint32_t LogVersion = 1;
+const std::size_t LogHeaderSize = sizeof(LogMagic) + sizeof(LogVersion);
+const std::size_t RecordHeaderSize = 2 * sizeof(std::uint32_t);
+
+enum ConfigValueType : std::uint8_t {ConfigBool = 1, ConfigInt = 2, ConfigDouble = 3, ConfigString = 4, ConfigIntVector = 5};
+enum FootprintType : std::uint8_t {FootprintPoint = 1, FootprintCircular = 2, FootprintTwoCircles = 3, FootprintLine = 4, FootprintPolygon = 5,
+                                   FootprintMultiCircle = 6};
+enum ObstacleType : std::uint8_t {ObstaclePoint = 1, ObstacleCircular = 2, ObstacleLine = 3, ObstaclePill = 4, ObstaclePolygon = 5};
+
+
+//! Appends values to a payload buffer
+class PayloadWriter
+{
+public:
+  explicit PayloadWriter(std::vector<std::uint8_t>& payload) : payload_(payload) {payload_.clear();}
+
+  template <typename T>
+  void put(const T& value)
+  {
+    const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+    payload_.insert(payload_.end(), bytes, bytes + sizeof(T));
+  }
+
+  void putString(const std::string& str)
+  {
+    put<std::uint32_t>(str.size());
+    payload_.insert(payload_.end(), str.begin(), str.end());
+  }
+
+  void putVector(const Eigen::Vector2d& vec)
+  {
+    put(vec.x());
+    put(vec.y());
+  }
+
+  template <typename Msg>
+  void putMessage(const Msg& msg)
+  {
+    std::uint32_t length = ros::serialization::serializationLength(msg);
+    put(length);
+    std::size_t offset = payload_.size();
+    payload_.resize(offset + length);
+    ros::serialization::OStream stream(payload_.data() + offset, length);
+    ros::serialization::serialize(stream, msg);
+  }
+
+  std::size_t size() const {return payload_.size();}
+
+  template <typename T>
+  void overwrite(std::size_t offset, const T& value)
+  {
+    std::memcpy(payload_.data() + offset, &value, sizeof(T));
+  }
+
+private:
+  std::vector<std::uint8_t>& payload_;
+};
+
+//! Reads values from a payload, all getters fail once the end of the payload is exceeded
+class PayloadReader
+{
+public:
+  PayloadReader(const std::uint8_t* data, std::size_t size) : data_(data), size_(size), offset_(0), valid_(true) {}
+
+  template <typename T>
+  bool get(T& value)
+  {
+    if (!reserve(sizeof(T)))
+      return false;
+    std::memcpy(&value, data_ + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return true;
+  }
+
+  bool getString(std::string& str)
+  {
+    std::uint32_t length;
+    if (!get(length) || !reserve(length))
+      return false;
+    str.assign(reinterpret_cast<const char*>(data_ + offset_), length);
+    offset_ += length;
+    return true;
+  }
+
+  bool getVector(Eigen::Vector2d& vec)
+  {
+    return get(vec.x()) && get(vec.y());
+  }
+
+  template <typename Msg>
+  bool getMessage(Msg& msg)
+  {
+    std::uint32_t length;
+    if (!get(length) || !reserve(length))
+      return false;
+    try
+    {
+      ros::serialization::IStream stream(const_cast<std::uint8_t*>(data_ + offset_), length);
+      ros::serialization::deserialize(stream, msg);
+    }
+    catch (const ros::Exception&)
+    {
+      valid_ = false;
+      return false;
+    }
+    offset_ += length;
+    return true;
+  }
+
+  bool valid() const {return valid_;}
+
+  //! True if all bytes have been read (fields appended in later versions are missing)
+  bool atEnd() const {return offset_ >= size_;}
+
+private:
+  bool reserve(std::size_t bytes)
+  {
+    if (valid_ && size_ - offset_ < bytes)
+      valid_ = false;
+    return valid_;
+  }
+
+  const std::uint8_t* data_;
+  std::size_t size_;
+  std::size_t offset_;
+  bool valid_;
+};
+
+
+/**
+ * @brief Call visit(name, member) for each parameter of the config.
+ * @remarks Keep in sync with TebConfig::loadRosParamFromNodeHandle(), names are identical to the ROS parameter names.
+ */
+template <typename Config, typename Visitor>
+void visitConfigParameters(Config& cfg, Visitor& visit)
+{
+  visit("odom_topic", cfg.odom_topic);
+  visit("map_frame", cfg.map_frame);
+  visit("pipeline_input_preparation", cfg.pipeline_input_preparation);
+  visit("latency_statistics_period", cfg.latency_statistics_period);
+  visit("planning_log", cfg.planning_log);
+  visit("planning_log_queue_size", cfg.planning_log_queue_size);
+  visit("teb_autosize", cfg.trajectory.teb_autosize);
+  visit("dt_ref", cfg.trajectory.dt_ref);
+  visit("dt_hysteresis", cfg.trajectory.dt_hysteresis);
+  visit("min_samples", cfg.trajectory.min_samples);
+  visit("max_samples", cfg.trajectory.max_samples);
+  visit("global_plan_overwrite_orientation", cfg.trajectory.global_plan_overwrite_orientation);
+  visit("allow_init_with_backwards_motion", cfg.trajectory.allow_init_with_backwards_motion);
+  visit("global_plan_viapoint_sep", cfg.trajectory.global_plan_viapoint_sep);
+  visit("via_points_ordered", cfg.trajectory.via_points_ordered);
+  visit("max_global_plan_lookahead_dist", cfg.trajectory.max_global_plan_lookahead_dist);
+  visit("global_plan_prune_distance", cfg.trajectory.global_plan_prune_distance);
+  visit("exact_arc_length", cfg.trajectory.exact_arc_length);
+  visit("force_reinit_new_goal_dist", cfg.trajectory.force_reinit_new_goal_dist);
+  visit("force_reinit_new_goal_angular", cfg.trajectory.force_reinit_new_goal_angular);
+  visit("feasibility_check_no_poses", cfg.trajectory.feasibility_check_no_poses);
+  visit("publish_feedback", cfg.trajectory.publish_feedback);
+  visit("min_resolution_collision_check_angular", cfg.trajectory.min_resolution_collision_check_angular);
+  visit("feasibility_check_heading_bins", cfg.trajectory.feasibility_check_heading_bins);
+  visit("control_look_ahead_poses", cfg.trajectory.control_look_ahead_poses);
+  visit("prevent_look_ahead_poses_near_goal", cfg.trajectory.prevent_look_ahead_poses_near_goal);
+  visit("max_vel_x", cfg.robot.max_vel_x);
+  visit("max_vel_x_backwards", cfg.robot.max_vel_x_backwards);
+  visit("max_vel_y", cfg.robot.max_vel_y);
+  visit("max_vel_trans", cfg.robot.max_vel_trans);
+  visit("max_vel_theta", cfg.robot.max_vel_theta);
+  visit("acc_lim_x", cfg.robot.acc_lim_x);
+  visit("acc_lim_y", cfg.robot.acc_lim_y);
+  visit("acc_lim_theta", cfg.robot.acc_lim_theta);
+  visit("min_turning_radius", cfg.robot.min_turning_radius);
+  visit("wheelbase", cfg.robot.wheelbase);
+  visit("cmd_angle_instead_rotvel", cfg.robot.cmd_angle_instead_rotvel);
+  visit("is_footprint_dynamic", cfg.robot.is_footprint_dynamic);
+  visit("use_proportional_saturation", cfg.robot.use_proportional_saturation);
+  visit("transform_tolerance", cfg.robot.transform_tolerance);
+  visit("xy_goal_tolerance", cfg.goal_tolerance.xy_goal_tolerance);
+  visit("yaw_goal_tolerance", cfg.goal_tolerance.yaw_goal_tolerance);
+  visit("free_goal_vel", cfg.goal_tolerance.free_goal_vel);
+  visit("trans_stopped_vel", cfg.goal_tolerance.trans_stopped_vel);
+  visit("theta_stopped_vel", cfg.goal_tolerance.theta_stopped_vel);
+  visit("complete_global_plan", cfg.goal_tolerance.complete_global_plan);
+  visit("min_obstacle_dist", cfg.obstacles.min_obstacle_dist);
+  visit("inflation_dist", cfg.obstacles.inflation_dist);
+  visit("dynamic_obstacle_inflation_dist", cfg.obstacles.dynamic_obstacle_inflation_dist);
+  visit("include_dynamic_obstacles", cfg.obstacles.include_dynamic_obstacles);
+  visit("include_costmap_obstacles", cfg.obstacles.include_costmap_obstacles);
+  visit("costmap_obstacles_behind_robot_dist", cfg.obstacles.costmap_obstacles_behind_robot_dist);
+  visit("obstacle_poses_affected", cfg.obstacles.obstacle_poses_affected);
+  visit("legacy_obstacle_association", cfg.obstacles.legacy_obstacle_association);
+  visit("obstacle_association_force_inclusion_factor", cfg.obstacles.obstacle_association_force_inclusion_factor);
+  visit("obstacle_association_cutoff_factor", cfg.obstacles.obstacle_association_cutoff_factor);
+  visit("costmap_converter_plugin", cfg.obstacles.costmap_converter_plugin);
+  visit("costmap_converter_spin_thread", cfg.obstacles.costmap_converter_spin_thread);
+  visit("obstacle_proximity_ratio_max_vel", cfg.obstacles.obstacle_proximity_ratio_max_vel);
+  visit("obstacle_proximity_lower_bound", cfg.obstacles.obstacle_proximity_lower_bound);
+  visit("obstacle_proximity_upper_bound", cfg.obstacles.obstacle_proximity_upper_bound);
+  visit("no_inner_iterations", cfg.optim.no_inner_iterations);
+  visit("no_outer_iterations", cfg.optim.no_outer_iterations);
+  visit("optimization_activate", cfg.optim.optimization_activate);
+  visit("optimization_verbose", cfg.optim.optimization_verbose);
+  visit("penalty_epsilon", cfg.optim.penalty_epsilon);
+  visit("weight_max_vel_x", cfg.optim.weight_max_vel_x);
+  visit("weight_max_vel_y", cfg.optim.weight_max_vel_y);
+  visit("weight_max_vel_theta", cfg.optim.weight_max_vel_theta);
+  visit("weight_acc_lim_x", cfg.optim.weight_acc_lim_x);
+  visit("weight_acc_lim_y", cfg.optim.weight_acc_lim_y);
+  visit("weight_acc_lim_theta", cfg.optim.weight_acc_lim_theta);
+  visit("weight_kinematics_nh", cfg.optim.weight_kinematics_nh);
+  visit("weight_kinematics_forward_drive", cfg.optim.weight_kinematics_forward_drive);
+  visit("weight_kinematics_turning_radius", cfg.optim.weight_kinematics_turning_radius);
+  visit("weight_optimaltime", cfg.optim.weight_optimaltime);
+  visit("weight_shortest_path", cfg.optim.weight_shortest_path);
+  visit("weight_obstacle", cfg.optim.weight_obstacle);
+  visit("weight_inflation", cfg.optim.weight_inflation);
+  visit("weight_dynamic_obstacle", cfg.optim.weight_dynamic_obstacle);
+  visit("weight_dynamic_obstacle_inflation", cfg.optim.weight_dynamic_obstacle_inflation);
+  visit("weight_velocity_obstacle_ratio", cfg.optim.weight_velocity_obstacle_ratio);
+  visit("weight_viapoint", cfg.optim.weight_viapoint);
+  visit("weight_prefer_rotdir", cfg.optim.weight_prefer_rotdir);
+  visit("weight_adapt_factor", cfg.optim.weight_adapt_factor);
+  visit("obstacle_cost_exponent", cfg.optim.obstacle_cost_exponent);
+  visit("enable_homotopy_class_planning", cfg.hcp.enable_homotopy_class_planning);
+  visit("enable_multithreading", cfg.hcp.enable_multithreading);
+  visit("worker_pool_size", cfg.hcp.worker_pool_size);
+  visit("worker_cpu_affinity", cfg.hcp.worker_cpu_affinity);
+  visit("simple_exploration", cfg.hcp.simple_exploration);
+  visit("async_exploration", cfg.hcp.async_exploration);
+  visit("max_number_classes", cfg.hcp.max_number_classes);
+  visit("max_number_plans_in_current_class", cfg.hcp.max_number_plans_in_current_class);
+  visit("selection_obst_cost_scale", cfg.hcp.selection_obst_cost_scale);
+  visit("selection_prefer_initial_plan", cfg.hcp.selection_prefer_initial_plan);
+  visit("selection_viapoint_cost_scale", cfg.hcp.selection_viapoint_cost_scale);
+  visit("selection_cost_hysteresis", cfg.hcp.selection_cost_hysteresis);
+  visit("selection_alternative_time_cost", cfg.hcp.selection_alternative_time_cost);
+  visit("selection_dropping_probability", cfg.hcp.selection_dropping_probability);
+  visit("selection_lower_bound_pruning", cfg.hcp.selection_lower_bound_pruning);
+  visit("selection_pruned_outer_iterations", cfg.hcp.selection_pruned_outer_iterations);
+  visit("optimization_budget_policy", cfg.hcp.optimization_budget_policy);
+  visit("switching_blocking_period", cfg.hcp.switching_blocking_period);
+  visit("roadmap_graph_samples", cfg.hcp.roadmap_graph_no_samples);
+  visit("roadmap_graph_area_width", cfg.hcp.roadmap_graph_area_width);
+  visit("roadmap_graph_area_length_scale", cfg.hcp.roadmap_graph_area_length_scale);
+  visit("roadmap_graph_max_edge_length", cfg.hcp.roadmap_graph_max_edge_length);
+  visit("roadmap_graph_reuse", cfg.hcp.roadmap_graph_reuse);
+  visit("graph_search_max_expansions", cfg.hcp.graph_search_max_expansions);
+  visit("h_signature_prescaler", cfg.hcp.h_signature_prescaler);
+  visit("h_signature_threshold", cfg.hcp.h_signature_threshold);
+  visit("h_signature_int_steps", cfg.hcp.h_signature_int_steps);
+  visit("h_signature_adaptive_int_steps", cfg.hcp.h_signature_adaptive_int_steps);
+  visit("h_signature_filter_obstacles", cfg.hcp.h_signature_filter_obstacles);
+  visit("h_signature_corridor_width", cfg.hcp.h_signature_corridor_width);
+  visit("h_signature_cluster_dist", cfg.hcp.h_signature_cluster_dist);
+  visit("h_signature_cache_tolerance", cfg.hcp.h_signature_cache_tolerance);
+  visit("obstacle_keypoint_offset", cfg.hcp.obstacle_keypoint_offset);
+  visit("obstacle_heading_threshold", cfg.hcp.obstacle_heading_threshold);
+  visit("viapoints_all_candidates", cfg.hcp.viapoints_all_candidates);
+  visit("visualize_hc_graph", cfg.hcp.visualize_hc_graph);
+  visit("visualize_with_time_as_z_axis_scale", cfg.hcp.visualize_with_time_as_z_axis_scale);
+  visit("delete_detours_backwards", cfg.hcp.delete_detours_backwards);
+  visit("detours_orientation_tolerance", cfg.hcp.detours_orientation_tolerance);
+  visit("length_start_orientation_vector", cfg.hcp.length_start_orientation_vector);
+  visit("max_ratio_detours_duration_best_duration", cfg.hcp.max_ratio_detours_duration_best_duration);
+  visit("shrink_horizon_backup", cfg.recovery.shrink_horizon_backup);
+  visit("shrink_horizon_min_duration", cfg.recovery.shrink_horizon_min_duration);
+  visit("oscillation_recovery", cfg.recovery.oscillation_recovery);
+  visit("oscillation_v_eps", cfg.recovery.oscillation_v_eps);
+  visit("oscillation_omega_eps", cfg.recovery.oscillation_omega_eps);
+  visit("oscillation_recovery_min_duration", cfg.recovery.oscillation_recovery_min_duration);
+  visit("oscillation_filter_duration", cfg.recovery.oscillation_filter_duration);
+  visit("divergence_detection", cfg.recovery.divergence_detection_enable);
+  visit("divergence_detection_max_chi_squared", cfg.recovery.divergence_detection_max_chi_squared);
+}
+
+//! Appends each visited parameter to the payload
+struct ConfigEncoder
+{
+  explicit ConfigEncoder(PayloadWriter& payload) : out(payload), count(0) {}
+
+  void operator()(const char* name, bool value) {begin(name, ConfigBool); out.put<std::uint8_t>(value);}
+  void operator()(const char* name, int value) {begin(name, ConfigInt); out.put<std::int32_t>(value);}
+  void operator()(const char* name, double value) {begin(name, ConfigDouble); out.put(value);}
+  void operator()(const char* name, const std::string& value) {begin(name, ConfigString); out.putString(value);}
+  void operator()(const char* name, const std::vector<int>& value)
+  {
+    begin(name, ConfigIntVector);
+    out.put<std::uint32_t>(value.size());
+    for (int element : value)
+      out.put<std::int32_t>(element);
+  }
+
+  void begin(const char* name, ConfigValueType type)
+  {
+    out.putString(name);
+    out.put<std::uint8_t>(type);
+    ++count;
+  }
+
+  PayloadWriter& out;
+  std::uint32_t count;
+};
+
+//! Value of a decoded parameter
+struct ConfigValue
+{
+  std::uint8_t type = 0;
+  double number = 0;
+  std::string str;
+  std::vector<int> vec;
+  bool used = false;
+};
+
+//! Assigns the decoded values to the visited parameters
+struct ConfigDecoder
+{
+  void operator()(const char* name, bool& value) {if (ConfigValue* v = find(name, ConfigBool)) value = v->number != 0;}
+  void operator()(const char* name, int& value) {if (ConfigValue* v = find(name, ConfigInt)) value = static_cast<int>(v->number);}
+  void operator()(const char* name, double& value) {if (ConfigValue* v = find(name, ConfigDouble)) value = v->number;}
+  void operator()(const char* name, std::string& value) {if (ConfigValue* v = find(name, ConfigString)) value = v->str;}
+  void operator()(const char* name, std::vector<int>& value) {if (ConfigValue* v = find(name, ConfigIntVector)) value = v->vec;}
+
+  ConfigValue* find(const char* name, ConfigValueType type)
+  {
+    std::map<std::string, ConfigValue>::iterator it = values.find(name);
+    if (it == values.end())
+      return NULL;
+    it->second.used = true;
+    if (it->second.type != type)
+    {
+      ROS_WARN("Planning log: parameter '%s' is recorded with a different type, keeping the default.", name);
+      return NULL;
+    }
+    return &it->second;
+  }
+
+  std::map<std::string, ConfigValue> values;
+};
+
+
+void putObstacle(PayloadWriter& out, const Obstacle& obstacle)
+{
+  if (const PointObstacle* point = dynamic_cast<const PointObstacle*>(&obstacle))
+  {
+    out.put<std::uint8_t>(ObstaclePoint);
+    out.putVector(point->position());
+  }
+  else if (const CircularObstacle* circle = dynamic_cast<const CircularObstacle*>(&obstacle))
+  {
+    out.put<std::uint8_t>(ObstacleCircular);
+    out.putVector(circle->position());
+    out.put(circle->radius());
+  }
+  else if (const LineObstacle* line = dynamic_cast<const LineObstacle*>(&obstacle))
+  {
+    out.put<std::uint8_t>(ObstacleLine);
+    out.putVector(line->start());
+    out.putVector(line->end());
+  }
+  else if (const PillObstacle* pill = dynamic_cast<const PillObstacle*>(&obstacle))
+  {
+    out.put<std::uint8_t>(ObstaclePill);
+    out.putVector(pill->start());
+    out.putVector(pill->end());
+    out.put(pill->radius());
+  }
+  else if (const PolygonObstacle* polygon = dynamic_cast<const PolygonObstacle*>(&obstacle))
+  {
+    out.put<std::uint8_t>(ObstaclePolygon);
+    out.put<std::uint32_t>(polygon->vertices().size());
+    for (const Eigen::Vector2d& vertex : polygon->vertices())
+      out.putVector(vertex);
+  }
+  else
+  {
+    // unknown obstacle type: keep at least its centroid
+    ROS_WARN_ONCE("Planning log: unknown obstacle type, recording its centroid only.");
+    out.put<std::uint8_t>(ObstaclePoint);
+    out.putVector(obstacle.getCentroid());
+  }
+  out.put<std::uint8_t>(obstacle.isDynamic());
+  out.putVector(obstacle.getCentroidVelocity());
+}
+
+ObstaclePtr getObstacle(PayloadReader& in)
+{
+  std::uint8_t type = 0;
+  in.get(type);
+
+  ObstaclePtr obstacle;
+  Eigen::Vector2d first, second;
+  double radius = 0;
+  switch (type)
+  {
+    case ObstaclePoint:
+      if (in.getVector(first))
+        obstacle = ObstaclePtr(new PointObstacle(first));
+      break;
+    case ObstacleCircular:
+      if (in.getVector(first) && in.get(radius))
+        obstacle = ObstaclePtr(new CircularObstacle(first, radius));
+      break;
+    case ObstacleLine:
+      if (in.getVector(first) && in.getVector(second))
+        obstacle = ObstaclePtr(new LineObstacle(first, second));
+      break;
+    case ObstaclePill:
+      if (in.getVector(first) && in.getVector(second) && in.get(radius))
+        obstacle = ObstaclePtr(new PillObstacle(first, second, radius));
+      break;
+    case ObstaclePolygon:
+    {
+      std::uint32_t num_vertices = 0;
+      Point2dContainer vertices;
+      if (in.get(num_vertices))
+      {
+        for (std::uint32_t i = 0; i < num_vertices && in.getVector(first); ++i)
+          vertices.push_back(first);
+      }
+      if (in.valid())
+        obstacle = ObstaclePtr(new PolygonObstacle(vertices));
+      break;
+    }
+    default:
+      return ObstaclePtr();
+  }
+
+  std::uint8_t dynamic = 0;
+  Eigen::Vector2d velocity;
+  if (!obstacle || !in.get(dynamic) || !in.getVector(velocity))
+    return ObstaclePtr();
+  if (dynamic)
+    obstacle->setCentroidVelocity(velocity);
+  return obstacle;
+}
+
+} // anonymous namespace
+
+
+void encodeConfig(const TebConfig& cfg, std::vector<std::uint8_t>& payload)
+{
+  PayloadWriter out(payload);
+  out.put<std::uint32_t>(0); // number of parameters, written afterwards
+  ConfigEncoder encoder(out);
+  visitConfigParameters(cfg, encoder);
+  out.overwrite(0, encoder.count);
+}
+
+bool decodeConfig(const std::uint8_t* data, std::size_t size, TebConfig& cfg)
+{
+  PayloadReader in(data, size);
+  ConfigDecoder decoder;
+  std::uint32_t count = 0;
+  in.get(count);
+  for (std::uint32_t i = 0; i < count && in.valid(); ++i)
+  {
+    std::string name;
+    ConfigValue value;
+    if (!in.getString(name) || !in.get(value.type))
+      break;
+    switch (value.type)
+    {
+      case ConfigBool:
+      {
+        std::uint8_t flag = 0;
+        in.get(flag);
+        value.number = flag;
+        break;
+      }
+      case ConfigInt:
+      {
+        std::int32_t number = 0;
+        in.get(number);
+        value.number = number;
+        break;
+      }
+      case ConfigDouble:
+        in.get(value.number);
+        break;
+      case ConfigString:
+        in.getString(value.str);
+        break;
+      case ConfigIntVector:
+      {
+        std::uint32_t length = 0;
+        std::int32_t element = 0;
+        in.get(length);
+        for (std::uint32_t j = 0; j < length && in.get(element); ++j)
+          value.vec.push_back(element);
+        break;
+      }
+      default:
+        ROS_ERROR("Planning log: parameter '%s' has an unknown type.", name.c_str());
+        return false;
+    }
+    decoder.values[name] = value;
+  }
+  if (!in.valid())
+  {
+    ROS_ERROR("Planning log: config record is corrupted.");
+    return false;
+  }
+
+  visitConfigParameters(cfg, decoder);
+  for (const std::pair<const std::string, ConfigValue>& entry : decoder.values)
+  {
+    if (!entry.second.used)
+      ROS_WARN("Planning log: ignoring unknown parameter '%s'.", entry.first.c_str());
+  }
+  return true;
+}
+
+void encodeFootprint(const BaseRobotFootprintModel& robot_model, std::vector<std::uint8_t>& payload)
+{
+  PayloadWriter out(payload);
+  if (const PointRobotFootprint* point = dynamic_cast<const PointRobotFootprint*>(&robot_model))
+  {
+    out.put<std::uint8_t>(FootprintPoint);
+    out.put(point->getMinObstacleDist());
+  }
+  else if (const CircularRobotFootprint* circle = dynamic_cast<const CircularRobotFootprint*>(&robot_model))
+  {
+    out.put<std::uint8_t>(FootprintCircular);
+    out.put(circle->getRadius());
+  }
+  else if (const TwoCirclesRobotFootprint* circles = dynamic_cast<const TwoCirclesRobotFootprint*>(&robot_model))
+  {
+    out.put<std::uint8_t>(FootprintTwoCircles);
+    out.put(circles->getFrontOffset());
+    out.put(circles->getFrontRadius());
+    out.put(circles->getRearOffset());
+    out.put(circles->getRearRadius());
+  }
+  else if (const LineRobotFootprint* line = dynamic_cast<const LineRobotFootprint*>(&robot_model))
+  {
+    out.put<std::uint8_t>(FootprintLine);
+    out.putVector(line->getLineStart());
+    out.putVector(line->getLineEnd());
+    out.put(line->getMinObstacleDist());
+    out.put(line->getDistanceField().resolution());
+    out.put(line->getDistanceField().margin());
+  }
+  else if (const PolygonRobotFootprint* polygon = dynamic_cast<const PolygonRobotFootprint*>(&robot_model))
+  {
+    out.put<std::uint8_t>(FootprintPolygon);
+    out.put<std::uint32_t>(polygon->getVertices().size());
+    for (const Eigen::Vector2d& vertex : polygon->getVertices())
+      out.putVector(vertex);
+    out.put(polygon->getDistanceField().resolution());
+    out.put(polygon->getDistanceField().margin());
+  }
+  else if (const MultiCircleRobotFootprint* circles = dynamic_cast<const MultiCircleRobotFootprint*>(&robot_model))
+  {
+    out.put<std::uint8_t>(FootprintMultiCircle);
+    out.put<std::uint32_t>(circles->numCircles());
+    for (int i = 0; i < circles->numCircles(); ++i)
+    {
+      out.putVector(circles->getCenter(i));
+      out.put(circles->getRadius(i));
+    }
+  }
+  else
+  {
+    ROS_WARN("Planning log: unknown footprint model, recording a point robot instead.");
+    out.put<std::uint8_t>(FootprintPoint);
+    out.put(0.0);
+  }
+}
+
+RobotFootprintModelPtr decodeFootprint(const std::uint8_t* data, std::size_t size)
+{
+  PayloadReader in(data, size);
+  std::uint8_t type = 0;
+  in.get(type);
+
+  RobotFootprintModelPtr robot_model;
+  double values[4];
+  Eigen::Vector2d start, end;
+  switch (type)
+  {
+    case FootprintPoint:
+      if (in.get(values[0]))
+        robot_model = RobotFootprintModelPtr(new PointRobotFootprint(values[0]));
+      break;
+    case FootprintCircular:
+      if (in.get(values[0]))
+        robot_model = RobotFootprintModelPtr(new CircularRobotFootprint(values[0]));
+      break;
+    case FootprintTwoCircles:
+      if (in.get(values[0]) && in.get(values[1]) && in.get(values[2]) && in.get(values[3]))
+        robot_model = RobotFootprintModelPtr(new TwoCirclesRobotFootprint(values[0], values[1], values[2], values[3]));
+      break;
+    case FootprintLine:
+      if (in.getVector(start) && in.getVector(end) && in.get(values[0]))
+      {
+        LineRobotFootprint* line = new LineRobotFootprint(start, end, values[0]);
+        robot_model = RobotFootprintModelPtr(line);
+        if (!in.atEnd() && in.get(values[1]) && in.get(values[2]))
+          line->setDistanceField(values[1], values[2]);
+      }
+      break;
+    case FootprintPolygon:
+    {
+      std::uint32_t num_vertices = 0;
+      Point2dContainer vertices;
+      if (in.get(num_vertices))
+      {
+        for (std::uint32_t i = 0; i < num_vertices && in.getVector(start); ++i)
+          vertices.push_back(start);
+      }
+      if (in.valid())
+      {
+        PolygonRobotFootprint* polygon = new PolygonRobotFootprint(vertices);
+        robot_model = RobotFootprintModelPtr(polygon);
+        if (!in.atEnd() && in.get(values[0]) && in.get(values[1]))
+          polygon->setDistanceField(values[0], values[1]);
+      }
+      break;
+    }
+    case FootprintMultiCircle:
+    {
+      std::uint32_t num_circles = 0;
+      Point2dContainer centers;
+      std::vector<double> radii;
+      if (in.get(num_circles))
+      {
+        for (std::uint32_t i = 0; i < num_circles && in.getVector(start) && in.get(values[0]); ++i)
+        {
+          centers.push_back(start);
+          radii.push_back(values[0]);
+        }
+      }
+      if (in.valid())
+        robot_model = RobotFootprintModelPtr(new MultiCircleRobotFootprint(centers, radii));
+      break;
+    }
+    default:
+      break;
+  }
+
+  if (!robot_model)
+    ROS_ERROR("Planning log: footprint record is corrupted or of an unknown type.");
+  return robot_model;
+}
+
+void encodeGlobalCostmap(const nav_msgs::OccupancyGrid& costmap, std::vector<std::uint8_t>& payload)
+{
+  PayloadWriter out(payload);
+  out.putMessage(costmap);
+}
+
+bool decodeGlobalCostmap(const std::uint8_t* data, std::size_t size, nav_msgs::OccupancyGrid& costmap)
+{
+  PayloadReader in(data, size);
+  if (!in.getMessage(costmap))
+  {
+    ROS_ERROR("Planning log: costmap record is corrupted.");
+    return false;
+  }
+  return true;
+}
+
+void encodeCycleInput(const PlanningCycleInput& input, std::vector<std::uint8_t>& payload)
+{
+  PayloadWriter out(payload);
+  out.put(input.stamp);
+
+  // plan (all poses share the frame of the first one)
+  out.putString(input.plan.empty() ? std::string() : input.plan.front().header.frame_id);
+  out.put<std::uint32_t>(input.plan.size());
+  for (const geometry_msgs::PoseStamped& pose : input.plan)
+  {
+    out.put(pose.pose.position.x);
+    out.put(pose.pose.position.y);
+    out.put(tf::getYaw(pose.pose.orientation));
+  }
+
+  out.put(input.robot_vel.linear.x);
+  out.put(input.robot_vel.linear.y);
+  out.put(input.robot_vel.angular.z);
+  out.put<std::uint8_t>(input.free_goal_vel);
+
+  out.put<std::uint32_t>(input.obstacles.size());
+  for (const ObstaclePtr& obstacle : input.obstacles)
+    putObstacle(out, *obstacle);
+
+  out.put<std::uint32_t>(input.via_points.size());
+  for (const Eigen::Vector2d& via_point : input.via_points)
+    out.putVector(via_point);
+
+  out.putMessage(input.predictions);
+  out.put(input.config_hash);
+}
+
+bool decodeCycleInput(const std::uint8_t* data, std::size_t size, PlanningCycleInput& input)
+{
+  PayloadReader in(data, size);
+  in.get(input.stamp);
+
+  std::string frame_id;
+  std::uint32_t count = 0;
+  in.getString(frame_id);
+  in.get(count);
+  input.plan.clear();
+  for (std::uint32_t i = 0; i < count && in.valid(); ++i)
+  {
+    double x = 0, y = 0, theta = 0;
+    if (!in.get(x) || !in.get(y) || !in.get(theta))
+      break;
+    geometry_msgs::PoseStamped pose;
+    pose.header.frame_id = frame_id;
+    pose.pose.position.x = x;
+    pose.pose.position.y = y;
+    pose.pose.orientation = tf::createQuaternionMsgFromYaw(theta);
+    input.plan.push_back(pose);
+  }
+
+  std::uint8_t free_goal_vel = 0;
+  input.robot_vel = geometry_msgs::Twist();
+  in.get(input.robot_vel.linear.x);
+  in.get(input.robot_vel.linear.y);
+  in.get(input.robot_vel.angular.z);
+  in.get(free_goal_vel);
+  input.free_goal_vel = free_goal_vel != 0;
+
+  count = 0;
+  in.get(count);
+  input.obstacles.clear();
+  for (std::uint32_t i = 0; i < count && in.valid(); ++i)
+  {
+    ObstaclePtr obstacle = getObstacle(in);
+    if (!obstacle)
+    {
+      ROS_ERROR("Planning log: cycle record contains a corrupted obstacle.");
+      return false;
+    }
+    input.obstacles.push_back(obstacle);
+  }
+
+  count = 0;
+  in.get(count);
+  input.via_points.clear();
+  Eigen::Vector2d via_point;
+  for (std::uint32_t i = 0; i < count && in.getVector(via_point); ++i)
+    input.via_points.push_back(via_point);
+
+  in.getMessage(input.predictions);
+
+  input.config_hash = 0;
+  if (in.valid() && !in.atEnd())
+    in.get(input.config_hash);
+
+  if (!in.valid())
+  {
+    ROS_ERROR("Planning log: cycle record is corrupted.");
+    return false;
+  }
+  return true;
+}
+
+void encodeCycleOutput(const PlanningCycleOutput& output, std::vector<std::uint8_t>& payload)
+{
+  PayloadWriter out(payload);
+  out.put(output.stamp);
+  out.put<std::uint8_t>(output.success);
+  out.put(output.cost);
+  out.put(output.solver_iterations);
+  out.put(output.prepare_time);
+  out.put(output.plan_time);
+  out.put<std::uint32_t>(output.trajectory.size());
+  for (const PlanningCycleOutput::TrajectoryPose& pose : output.trajectory)
+  {
+    out.put(pose.x);
+    out.put(pose.y);
+    out.put(pose.theta);
+    out.put(pose.time_from_start);
+  }
+}
+
+bool decodeCycleOutput(const std::uint8_t* data, std::size_t size, PlanningCycleOutput& output)
+{
+  PayloadReader in(data, size);
+  std::uint8_t success = 0;
+  in.get(output.stamp);
+  in.get(success);
+  output.success = success != 0;
+  in.get(output.cost);
+  in.get(output.solver_iterations);
+  in.get(output.prepare_time);
+  in.get(output.plan_time);
+
+  std::uint32_t count = 0;
+  in.get(count);
+  output.trajectory.clear();
+  PlanningCycleOutput::TrajectoryPose pose;
+  for (std::uint32_t i = 0; i < count && in.get(pose.x) && in.get(pose.y) && in.get(pose.theta) && in.get(pose.time_from_start); ++i)
+    output.trajectory.push_back(pose);
+
+  if (!in.valid())
+  {
+    ROS_ERROR("Planning log: cycle output record is corrupted.");
+    return false;
+  }
+  return true;
+}
+
+void appendRecord(PlanningRecordType type, const std::vector<std::uint8_t>& payload, std::vector<std::uint8_t>& buffer)
+{
+  std::uint32_t header[2] = {static_cast<std::uint32_t>(type), static_cast<std::uint32_t>(payload.size())};
+  const std::uint8_t* header_bytes = reinterpret_cast<const std::uint8_t*>(header);
+  buffer.insert(buffer.end(), header_bytes, header_bytes + sizeof(header));
+  buffer.insert(buffer.end(), payload.begin(), payload.end());
+}
+
+std::uint64_t computeConfigHash(const TebConfig& cfg)
+{
+  std::vector<std::uint8_t> payload;
+  encodeConfig(cfg, payload);
+  return computeConfigHash(payload.data(), payload.size());
+}
+
+std::uint64_t computeConfigHash(const std::uint8_t* data, std::size_t size)
+{
+  std::uint64_t hash = 14695981039346656037ull;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    hash ^= data[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+
+bool PlanningRecordWriter::open(const std::string& filename)
+{
+  close();
+  file_.open(filename.c_str(), std::ios::binary | std::ios::trunc);
+  if (!file_.is_open())
+  {
+    ROS_ERROR("Planning log: cannot create '%s'.", filename.c_str());
+    return false;
+  }
+  file_.write(LogMagic, sizeof(LogMagic));
+  file_.write(reinterpret_cast<const char*>(&LogVersion), sizeof(LogVersion));
+  return file_.good();
+}
+
+void PlanningRecordWriter::close()
+{
+  if (file_.is_open())
+    file_.close();
+}
+
+bool PlanningRecordWriter::write(PlanningRecordType type, const std::vector<std::uint8_t>& payload)
+{
+  if (!file_.is_open())
+    return false;
+  std::uint32_t header[2] = {static_cast<std::uint32_t>(type), static_cast<std::uint32_t>(payload.size())};
+  file_.write(reinterpret_cast<const char*>(header), sizeof(header));
+  file_.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+  return file_.good();
+}
+
+bool PlanningRecordWriter::writeRecords(const std::vector<std::uint8_t>& records)
+{
+  if (!file_.is_open())
+    return false;
+  file_.write(reinterpret_cast<const char*>(records.data()), records.size());
+  return file_.good();
+}
+
+void PlanningRecordWriter::flush()
+{
+  if (file_.is_open())
+    file_.flush();
+}
+
+
+PlanningRecordReader::~PlanningRecordReader()
+{
+  close();
+}
+
+bool PlanningRecordReader::open(const std::string& filename)
+{
+  close();
+
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    ROS_ERROR("Planning log: cannot open '%s'.", filename.c_str());
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(LogHeaderSize))
+  {
+    ROS_ERROR("Planning log: '%s' is not a planning log.", filename.c_str());
+    ::close(fd);
+    return false;
+  }
+  void* mapping = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // the mapping remains valid
+  if (mapping == MAP_FAILED)
+  {
+    ROS_ERROR("Planning log: cannot map '%s'.", filename.c_str());
+    return false;
+  }
+  madvise(mapping, file_stat.st_size, MADV_SEQUENTIAL);
+  data_ = static_cast<const std::uint8_t*>(mapping);
+  size_ = file_stat.st_size;
+
+  std::uint32_t version = 0;
+  std::memcpy(&version, data_ + sizeof(LogMagic), sizeof(version));
+  if (std::memcmp(data_, LogMagic, sizeof(LogMagic)) != 0)
+  {
+    ROS_ERROR("Planning log: '%s' is not a planning log.", filename.c_str());
+    close();
+    return false;
+  }
+  if (version != LogVersion)
+  {
+    ROS_ERROR("Planning log: '%s' has version %u, supported version is %u.", filename.c_str(), version, LogVersion);
+    close();
+    return false;
+  }
+  offset_ = LogHeaderSize;
+  return true;
+}
+
+bool PlanningRecordReader::next(PlanningRecordView& record)
+{
+  if (size_ < offset_ + RecordHeaderSize)
+    return false;
+
+  std::uint32_t header[2];
+  std::memcpy(header, data_ + offset_, sizeof(header));
+  if (size_ - offset_ - RecordHeaderSize < header[1])
+  {
+    ROS_WARN("Planning log: ignoring truncated record at the end of the log.");
+    offset_ = size_;
+    return false;
+  }
+  record.type = static_cast<PlanningRecordType>(header[0]);
+  record.data = data_ + offset_ + RecordHeaderSize;
+  record.size = header[1];
+  offset_ += RecordHeaderSize + header[1];
+  return true;
+}
+
+void PlanningRecordReader::rewind()
+{
+  offset_ = data_ ? LogHeaderSize : 0;
+}
+
+void PlanningRecordReader::close()
+{
+  if (data_)
+    munmap(const_cast<std::uint8_t*>(data_), size_);
+  data_ = nullptr;
+  size_ = 0;
+  offset_ = 0;
+}
+
+} // namespace teb_local_planner
@@ -0,0 +1,198 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#include <teb_local_planner/planning_recorder.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+
+namespace teb_local_planner
+{
+
+PlanningRecorder::PlanningRecorder() : stop_requested_(false), dropped_(0)
+{
+}
+
+PlanningRecorder::~PlanningRecorder()
+{
+  stop();
+}
+
+bool PlanningRecorder::start(const std::string& filename, int queue_size)
+{
+  stop();
+  if (!writer_.open(filename))
+    return false;
+
+  queue_size = std::max(2, queue_size); // a cycle might require two buffers in the worst case (costmap and cycle)
+  buffers_.assign(queue_size, Buffer());
+  pending_.reset(new boost::lockfree::spsc_queue<PendingRecord>(queue_size));
+  free_.reset(new boost::lockfree::spsc_queue<Buffer*>(queue_size));
+  for (Buffer& buffer : buffers_)
+    free_->push(&buffer);
+
+  stop_requested_ = false;
+  dropped_ = 0;
+  writer_thread_.reset(new boost::thread(&PlanningRecorder::writeLoop, this));
+  ROS_INFO("Recording planning cycles to '%s'.", filename.c_str());
+  return true;
+}
+
+void PlanningRecorder::stop()
+{
+  if (!writer_thread_)
+    return;
+  stop_requested_ = true;
+  writer_thread_->join();
+  writer_thread_.reset();
+  writer_.close();
+  if (dropped_ > 0)
+    ROS_WARN("Planning log: %lu records have been dropped since the writer could not keep up.", (unsigned long) dropped_.load());
+}
+
+PlanningRecorder::Buffer* PlanningRecorder::acquire()
+{
+  Buffer* buffer = NULL;
+  if (!writer_thread_ || !free_->pop(buffer))
+  {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return NULL;
+  }
+  buffer->clear();
+  return buffer;
+}
+
+void PlanningRecorder::commit(Buffer* buffer, const nav_msgs::OccupancyGrid::ConstPtr& costmap)
+{
+  PendingRecord record;
+  record.buffer = buffer;
+  record.costmap = costmap;
+  // cannot fail: the queue holds as many elements as there are buffers
+  pending_->push(record);
+}
+
+bool PlanningRecorder::recordConfig(const TebConfig& cfg)
+{
+  Buffer* buffer = acquire();
+  if (!buffer)
+    return false;
+  encodeConfig(cfg, payload_);
+  appendRecord(PlanningRecordType::Config, payload_, *buffer);
+  commit(buffer);
+  return true;
+}
+
+bool PlanningRecorder::recordFootprint(const BaseRobotFootprintModel& robot_model)
+{
+  Buffer* buffer = acquire();
+  if (!buffer)
+    return false;
+  encodeFootprint(robot_model, payload_);
+  appendRecord(PlanningRecordType::Footprint, payload_, *buffer);
+  commit(buffer);
+  return true;
+}
+
+bool PlanningRecorder::recordGlobalCostmap(const nav_msgs::OccupancyGrid::ConstPtr& costmap)
+{
+  // encoding a whole costmap is too expensive for the control thread, the (empty) buffer only reserves a slot in the queue
+  Buffer* buffer = acquire();
+  if (!buffer)
+    return false;
+  commit(buffer, costmap);
+  return true;
+}
+
+bool PlanningRecorder::recordCycle(const PlanningCycleInput& input, const PlanningCycleOutput& output)
+{
+  Buffer* buffer = acquire();
+  if (!buffer)
+    return false;
+  encodeCycleInput(input, payload_);
+  appendRecord(PlanningRecordType::CycleInput, payload_, *buffer);
+  encodeCycleOutput(output, payload_);
+  appendRecord(PlanningRecordType::CycleOutput, payload_, *buffer);
+  commit(buffer);
+  return true;
+}
+
+void PlanningRecorder::writeLoop()
+{
+  bool write_error = false;
+
+  while (true)
+  {
+    // read the flag before emptying the queue, such that buffers committed before stop() are not lost
+    bool stop = stop_requested_.load();
+    PendingRecord record;
+    bool written = false;
+    while (pending_->pop(record))
+    {
+      bool success = true;
+      if (record.costmap)
+      {
+        // the scratch buffers keep their capacity, the costmap size rarely changes
+        encodeGlobalCostmap(*record.costmap, costmap_payload_);
+        costmap_record_.clear();
+        appendRecord(PlanningRecordType::GlobalCostmap, costmap_payload_, costmap_record_);
+        success = writer_.writeRecords(costmap_record_);
+        record.costmap.reset();
+      }
+      if (!record.buffer->empty())
+        success = writer_.writeRecords(*record.buffer) && success;
+      if (!success && !write_error)
+      {
+        ROS_ERROR("Planning log: writing failed, further records are discarded.");
+        write_error = true;
+      }
+      free_->push(record.buffer);
+      written = true;
+    }
+
+    if (stop)
+      break;
+    if (written)
+      writer_.flush(); // allow reading the log while recording
+    else
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  writer_.flush();
+}
+
+} // namespace teb_local_planner
@@ -46,6 +46,10 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle& nh)
     
   nh.param("odom_topic", odom_topic, odom_topic);
   nh.param("map_frame", map_frame, map_frame);
+  nh.param("pipeline_input_preparation", pipeline_input_preparation, pipeline_input_preparation);
+  nh.param("latency_statistics_period", latency_statistics_period, latency_statistics_period);
+  nh.param("planning_log", planning_log, planning_log);
+  nh.param("planning_log_queue_size", planning_log_queue_size, planning_log_queue_size);
   
   // Trajectory
   nh.param("teb_autosize", trajectory.teb_autosize, trajectory.teb_autosize);
@@ -67,6 +71,7 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle& nh)
   nh.param("feasibility_check_no_poses", trajectory.feasibility_check_no_poses, trajectory.feasibility_check_no_poses);
   nh.param("publish_feedback", trajectory.publish_feedback, trajectory.publish_feedback);
   nh.param("min_resolution_collision_check_angular", trajectory.min_resolution_collision_check_angular, trajectory.min_resolution_collision_check_angular);
+  nh.param("feasibility_check_heading_bins", trajectory.feasibility_check_heading_bins, trajectory.feasibility_check_heading_bins);
   nh.param("control_look_ahead_poses", trajectory.control_look_ahead_poses, trajectory.control_look_ahead_poses);
   nh.param("prevent_look_ahead_poses_near_goal", trajectory.prevent_look_ahead_poses_near_goal, trajectory.prevent_look_ahead_poses_near_goal);
   
@@ -141,7 +146,10 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle& nh)
   // Homotopy Class Planner
   nh.param("enable_homotopy_class_planning", hcp.enable_homotopy_class_planning, hcp.enable_homotopy_class_planning); 
   nh.param("enable_multithreading", hcp.enable_multithreading, hcp.enable_multithreading); 
+  nh.param("worker_pool_size", hcp.worker_pool_size, hcp.worker_pool_size);
+  nh.param("worker_cpu_affinity", hcp.worker_cpu_affinity, hcp.worker_cpu_affinity);
   nh.param("simple_exploration", hcp.simple_exploration, hcp.simple_exploration); 
+  nh.param("async_exploration", hcp.async_exploration, hcp.async_exploration);
   nh.param("max_number_classes", hcp.max_number_classes, hcp.max_number_classes);
   nh.param("max_number_plans_in_current_class", hcp.max_number_plans_in_current_class, hcp.max_number_plans_in_current_class);
   nh.param("selection_obst_cost_scale", hcp.selection_obst_cost_scale, hcp.selection_obst_cost_scale);
@@ -150,12 +158,24 @@ void TebConfig::loadRosParamFromNodeHandle(const ros::NodeHandle& nh)
   nh.param("selection_cost_hysteresis", hcp.selection_cost_hysteresis, hcp.selection_cost_hysteresis); 
   nh.param("selection_alternative_time_cost", hcp.selection_alternative_time_cost, hcp.selection_alternative_time_cost); 
   nh.param("selection_dropping_probability", hcp.selection_dropping_probability, hcp.selection_dropping_probability); 
+  nh.param("selection_lower_bound_pruning", hcp.selection_lower_bound_pruning, hcp.selection_lower_bound_pruning);
+  nh.param("selection_pruned_outer_iterations", hcp.selection_pruned_outer_iterations, hcp.selection_pruned_outer_iterations);
+  nh.param("optimization_budget_policy", hcp.optimization_budget_policy, hcp.optimization_budget_policy);
   nh.param("switching_blocking_period", hcp.switching_blocking_period, hcp.switching_blocking_period);
   nh.param("roadmap_graph_samples", hcp.roadmap_graph_no_samples, hcp.roadmap_graph_no_samples); 
   nh.param("roadmap_graph_area_width", hcp.roadmap_graph_area_width, hcp.roadmap_graph_area_width); 
   nh.param("roadmap_graph_area_length_scale", hcp.roadmap_graph_area_length_scale, hcp.roadmap_graph_area_length_scale);
+  nh.param("roadmap_graph_max_edge_length", hcp.roadmap_graph_max_edge_length, hcp.roadmap_graph_max_edge_length);
+  nh.param("roadmap_graph_reuse", hcp.roadmap_graph_reuse, hcp.roadmap_graph_reuse);
+  nh.param("graph_search_max_expansions", hcp.graph_search_max_expansions, hcp.graph_search_max_expansions);
   nh.param("h_signature_prescaler", hcp.h_signature_prescaler, hcp.h_signature_prescaler); 
   nh.param("h_signature_threshold", hcp.h_signature_threshold, hcp.h_signature_threshold); 
+  nh.param("h_signature_int_steps", hcp.h_signature_int_steps, hcp.h_signature_int_steps);
+  nh.param("h_signature_adaptive_int_steps", hcp.h_signature_adaptive_int_steps, hcp.h_signature_adaptive_int_steps);
+  nh.param("h_signature_filter_obstacles", hcp.h_signature_filter_obstacles, hcp.h_signature_filter_obstacles);
+  nh.param("h_signature_corridor_width", hcp.h_signature_corridor_width, hcp.h_signature_corridor_width);
+  nh.param("h_signature_cluster_dist", hcp.h_signature_cluster_dist, hcp.h_signature_cluster_dist);
+  nh.param("h_signature_cache_tolerance", hcp.h_signature_cache_tolerance, hcp.h_signature_cache_tolerance);
   nh.param("obstacle_keypoint_offset", hcp.obstacle_keypoint_offset, hcp.obstacle_keypoint_offset); 
   nh.param("obstacle_heading_threshold", hcp.obstacle_heading_threshold, hcp.obstacle_heading_threshold); 
   nh.param("viapoints_all_candidates", hcp.viapoints_all_candidates, hcp.viapoints_all_candidates);
@@ -199,6 +219,7 @@ void TebConfig::reconfigure(TebLocalPlannerReconfigureConfig& cfg)
   trajectory.force_reinit_new_goal_angular = cfg.force_reinit_new_goal_angular;
   trajectory.feasibility_check_no_poses = cfg.feasibility_check_no_poses;
   trajectory.publish_feedback = cfg.publish_feedback;
+  latency_statistics_period = cfg.latency_statistics_period;
   trajectory.control_look_ahead_poses = cfg.control_look_ahead_poses;
   trajectory.prevent_look_ahead_poses_near_goal = cfg.prevent_look_ahead_poses_near_goal;
   
@@ -271,6 +292,7 @@ void TebConfig::reconfigure(TebLocalPlannerReconfigureConfig& cfg)
   
   // Homotopy Class Planner
   hcp.enable_multithreading = cfg.enable_multithreading;
+  hcp.async_exploration = cfg.async_exploration;
   hcp.max_number_classes = cfg.max_number_classes; 
   hcp.max_number_plans_in_current_class = cfg.max_number_plans_in_current_class;
   hcp.selection_cost_hysteresis = cfg.selection_cost_hysteresis;
@@ -280,13 +302,25 @@ void TebConfig::reconfigure(TebLocalPlannerReconfigureConfig& cfg)
   hcp.selection_alternative_time_cost = cfg.selection_alternative_time_cost;
   hcp.selection_dropping_probability = cfg.selection_dropping_probability;
   hcp.switching_blocking_period = cfg.switching_blocking_period;
+  hcp.selection_lower_bound_pruning = cfg.selection_lower_bound_pruning;
+  hcp.selection_pruned_outer_iterations = cfg.selection_pruned_outer_iterations;
+  hcp.optimization_budget_policy = cfg.optimization_budget_policy;
   
   hcp.obstacle_heading_threshold = cfg.obstacle_heading_threshold;
   hcp.roadmap_graph_no_samples = cfg.roadmap_graph_no_samples;
   hcp.roadmap_graph_area_width = cfg.roadmap_graph_area_width;
   hcp.roadmap_graph_area_length_scale = cfg.roadmap_graph_area_length_scale;
+  hcp.roadmap_graph_max_edge_length = cfg.roadmap_graph_max_edge_length;
+  hcp.roadmap_graph_reuse = cfg.roadmap_graph_reuse;
+  hcp.graph_search_max_expansions = cfg.graph_search_max_expansions;
   hcp.h_signature_prescaler = cfg.h_signature_prescaler;
   hcp.h_signature_threshold = cfg.h_signature_threshold;
+  hcp.h_signature_int_steps = cfg.h_signature_int_steps;
+  hcp.h_signature_adaptive_int_steps = cfg.h_signature_adaptive_int_steps;
+  hcp.h_signature_filter_obstacles = cfg.h_signature_filter_obstacles;
+  hcp.h_signature_corridor_width = cfg.h_signature_corridor_width;
+  hcp.h_signature_cluster_dist = cfg.h_signature_cluster_dist;
+  hcp.h_signature_cache_tolerance = cfg.h_signature_cache_tolerance;
   hcp.viapoints_all_candidates = cfg.viapoints_all_candidates;
   hcp.visualize_hc_graph = cfg.visualize_hc_graph;
   hcp.visualize_with_time_as_z_axis_scale = cfg.visualize_with_time_as_z_axis_scale;
@@ -340,6 +374,14 @@ void TebConfig::checkParameters() const
   if (hcp.obstacle_keypoint_offset>=1 || hcp.obstacle_keypoint_offset<=0)
     ROS_WARN("TebLocalPlannerROS() Param Warning: parameter obstacle_heading_threshold must be in the interval ]0,1[. 0=0deg opening angle, 1=90deg opening angle.");
   
+  // hcp: 3d h-signature integration
+  if (hcp.h_signature_int_steps < 1)
+    ROS_WARN("TebLocalPlannerROS() Param Warning: parameter h_signature_int_steps must be >= 1.");
+
+  // hcp: worker pool
+  if (hcp.worker_pool_size < 0)
+    ROS_WARN("TebLocalPlannerROS() Param Warning: parameter worker_pool_size must be >= 0 (0: choose automatically).");
+
   // carlike
   if (robot.cmd_angle_instead_rotvel && robot.wheelbase==0)
     ROS_WARN("TebLocalPlannerROS() Param Warning: parameter cmd_angle_instead_rotvel is non-zero but wheelbase is set to zero: undesired behavior.");
@@ -37,6 +37,8 @@
  *********************************************************************/
 
 #include <teb_local_planner/teb_local_planner_ros.h>
+#include <teb_local_planner/latency_profiler.h>
+#include <teb_local_planner/footprint_costmap_model.h>
 
 #include <tf2_eigen/tf2_eigen.h>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
@@ -64,18 +66,51 @@ PLUGINLIB_EXPORT_CLASS(teb_local_planner::TebLocalPlannerROS, mbf_costmap_core::
 
 namespace teb_local_planner
 {
-  
+
+namespace
+{
+
+/**
+ * @brief Fit circles to a polygon footprint, reusing the previous fit if the polygon and the error bound are unchanged
+ *
+ * Fitting takes up to a second for small error bounds, but getRobotFootprintFromParamServer() is called on every
+ * reconfiguration, which mostly leaves the footprint unchanged.
+ * @return a new model (copied from the cached fit), or an empty pointer if the polygon cannot be approximated
+ */
+boost::shared_ptr<MultiCircleRobotFootprint> approximatePolygonCached(const Point2dContainer& polygon, double max_error)
+{
+  static boost::mutex mutex;
+  static Point2dContainer cached_polygon;
+  static double cached_max_error = 0.;
+  static boost::shared_ptr<const MultiCircleRobotFootprint> cached_model;
+
+  boost::mutex::scoped_lock lock(mutex);
+  if (!cached_model || max_error != cached_max_error || polygon != cached_polygon)
+  {
+    cached_model = MultiCircleRobotFootprint::approximatePolygon(polygon, max_error);
+    cached_polygon = polygon;
+    cached_max_error = max_error;
+    if (!cached_model)
+      return boost::shared_ptr<MultiCircleRobotFootprint>();
+  }
+  return boost::make_shared<MultiCircleRobotFootprint>(*cached_model);
+}
+
+} // anonymous namespace
+
 
 TebLocalPlannerROS::TebLocalPlannerROS() : costmap_ros_(NULL), tf_(NULL), costmap_model_(NULL),
                                            costmap_converter_loader_("costmap_converter", "costmap_converter::BaseCostmapToPolygons"),
-                                           dynamic_recfg_(NULL), custom_via_points_active_(false), goal_reached_(false), no_infeasible_plans_(0),
-                                           last_preferred_rotdir_(RotType::none), initialized_(false)
+                                           dynamic_recfg_(NULL), plan_version_(0), next_input_pending_(false), controller_period_(0.2), config_hash_(0), record_config_(false), custom_via_points_active_(false),
+                                           goal_reached_(false), no_infeasible_plans_(0), last_preferred_rotdir_(RotType::none), initialized_(false)
 {
 }
 
 
 TebLocalPlannerROS::~TebLocalPlannerROS()
 {
+  // wait for a pending input preparation, it operates on members of this class
+  input_worker_.reset();
 }
 
 void TebLocalPlannerROS::reconfigureCB(TebLocalPlannerReconfigureConfig& config, uint32_t level)
@@ -85,6 +120,13 @@ void TebLocalPlannerROS::reconfigureCB(TebLocalPlannerReconfigureConfig& config,
   // create robot footprint/contour model for optimization
   RobotFootprintModelPtr robot_model = getRobotFootprintFromParamServer(nh, cfg_);
   planner_->updateRobotModel(robot_model);
+
+  if (recorder_.isRecording())
+  {
+    boost::mutex::scoped_lock lock(record_mutex_);
+    record_config_ = true;
+    record_footprint_ = robot_model;
+  }
 }
 
 void TebLocalPlannerROS::initialize(std::string name, tf2_ros::Buffer* tf, costmap_2d::Costmap2DROS* costmap_ros)
@@ -125,7 +167,10 @@ void TebLocalPlannerROS::initialize(std::string name, tf2_ros::Buffer* tf, costm
     costmap_ros_ = costmap_ros;
     costmap_ = costmap_ros_->getCostmap(); // locking should be done in MoveBase.
     
-    costmap_model_ = boost::make_shared<base_local_planner::CostmapModel>(*costmap_);
+    if (cfg_.trajectory.feasibility_check_heading_bins > 0)
+      costmap_model_ = boost::make_shared<FootprintCostmapModel>(*costmap_, cfg_.trajectory.feasibility_check_heading_bins);
+    else
+      costmap_model_ = boost::make_shared<base_local_planner::CostmapModel>(*costmap_);
 
     global_frame_ = costmap_ros_->getGlobalFrameID();
     cfg_.map_frame = global_frame_; // TODO
@@ -160,6 +205,7 @@ void TebLocalPlannerROS::initialize(std::string name, tf2_ros::Buffer* tf, costm
     // Get footprint of the robot and minimum and maximum distance from the center of the robot to its footprint vertices.
     footprint_spec_ = costmap_ros_->getRobotFootprint();
     costmap_2d::calculateMinAndMaxDistances(footprint_spec_, robot_inscribed_radius_, robot_circumscribed_radius);    
+    updateFootprintCache();
     
     // init the odom helper to receive the robot's velocity from odom messages
     odom_helper_.setOdomTopic(cfg_.odom_topic);
@@ -183,6 +229,22 @@ void TebLocalPlannerROS::initialize(std::string name, tf2_ros::Buffer* tf, costm
     double controller_frequency = 5;
     nh_move_base.param("controller_frequency", controller_frequency, controller_frequency);
     failure_detector_.setBufferLength(std::round(cfg_.recovery.oscillation_filter_duration*controller_frequency));
+    if (controller_frequency > 0)
+      controller_period_ = 1.0 / controller_frequency;
+
+    // the first latency statistics cover the period since initialization
+    last_latency_publish_ = std::chrono::steady_clock::now();
+
+    // record the planning cycles for offline analysis and replay (see planning_record.h)
+    if (!cfg_.planning_log.empty() && recorder_.start(cfg_.planning_log, cfg_.planning_log_queue_size))
+    {
+      record_config_ = true;
+      record_footprint_ = robot_model;
+      // the planners receive predictions and costmap on their own, subscribe to the same topics
+      ros::NodeHandle nh_global;
+      record_predictions_sub_ = nh_global.subscribe("/obst_arr", 1, &TebLocalPlannerROS::recordPredictionsCB, this);
+      record_costmap_sub_ = nh_global.subscribe("/move_base/global_costmap/costmap", 1, &TebLocalPlannerROS::recordCostmapCB, this);
+    }
     
     // set initialized flag
     initialized_ = true;
@@ -209,6 +271,7 @@ bool TebLocalPlannerROS::setPlan(const std::vector<geometry_msgs::PoseStamped>&
   // store the global plan
   global_plan_.clear();
   global_plan_ = orig_global_plan;
+  ++plan_version_;
 
   // we do not clear the local planner here, since setPlan is called frequently whenever the global planner updates the plan.
   // the local planner checks whether it is required to reinitialize the trajectory or not within each velocity computation step.  
@@ -243,6 +306,21 @@ uint32_t TebLocalPlannerROS::computeVelocityCommands(const geometry_msgs::PoseSt
     return mbf_msgs::ExePathResult::NOT_INITIALIZED;
   }
 
+  // publish the latency statistics of the previous cycles
+  if (cfg_.latency_statistics_period > 0)
+  {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - last_latency_publish_).count();
+    if (elapsed >= cfg_.latency_statistics_period)
+    {
+      visualization_->publishLatencyStatistics(elapsed);
+      last_latency_publish_ = now;
+    }
+  }
+
+  TEB_PROFILE_STAGE(Cycle);
+  std::chrono::steady_clock::time_point cycle_start = std::chrono::steady_clock::now();
+
   static uint32_t seq = 0;
   cmd_vel.header.seq = seq++;
   cmd_vel.header.stamp = ros::Time::now();
@@ -262,24 +340,54 @@ uint32_t TebLocalPlannerROS::computeVelocityCommands(const geometry_msgs::PoseSt
   robot_vel_.linear.y = robot_vel_tf.pose.position.y;
   robot_vel_.angular.z = tf2::getYaw(robot_vel_tf.pose.orientation);
   
-  // prune global plan to cut off parts of the past (spatially before the robot)
-  pruneGlobalPlan(*tf_, robot_pose, global_plan_, cfg_.trajectory.global_plan_prune_distance);
+  if (cfg_.pipeline_input_preparation)
+  {
+    if (!input_worker_)
+      input_worker_ = boost::make_shared<WorkerPool>(1, cfg_.hcp.worker_cpu_affinity);
+
+    // take the inputs prepared during the previous cycle, unless a new global plan has been received in the meantime
+    // or the previous cycle is too long ago (e.g. after a pause). Regular inputs are one controller period old.
+    input_worker_->waitAll();
+    ros::Time now = ros::Time::now();
+    if (next_input_pending_ && next_input_.plan_version == plan_version_ && (now - next_input_.stamp).toSec() <= 1.5 * controller_period_)
+    {
+      std::swap(input_, next_input_);
+      global_plan_.swap(input_.global_plan);
+    }
+    else
+      prepareInput(robot_pose, *costmap_, global_plan_, input_);
+    next_input_pending_ = false;
+
+    // start preparing the inputs of the next cycle, such that it overlaps with the optimization of this cycle.
+    // The costmap is copied, since it is only locked by the caller during computeVelocityCommands().
+    costmap_snapshot_ = *costmap_;
+    next_input_.global_plan = global_plan_;
+    next_input_.plan_version = plan_version_;
+    next_input_.stamp = now;
+    input_worker_->submit(boost::bind(&TebLocalPlannerROS::prepareInput, this, robot_pose, boost::cref(costmap_snapshot_),
+                                      boost::ref(next_input_.global_plan), boost::ref(next_input_)));
+    next_input_pending_ = true;
+  }
+  else
+  {
+    prepareInput(robot_pose, *costmap_, global_plan_, input_);
+  }
 
-  // Transform global plan to the frame of interest (w.r.t. the local costmap)
-  std::vector<geometry_msgs::PoseStamped> transformed_plan;
-  int goal_idx;
-  geometry_msgs::TransformStamped tf_plan_to_global;
-  if (!transformGlobalPlan(*tf_, global_plan_, robot_pose, *costmap_, global_frame_, cfg_.trajectory.max_global_plan_lookahead_dist, 
-                           transformed_plan, &goal_idx, &tf_plan_to_global))
+  if (!input_.plan_valid)
   {
     ROS_WARN("Could not transform the global plan to the frame of the controller");
     message = "Could not transform the global plan to the frame of the controller";
     return mbf_msgs::ExePathResult::INTERNAL_ERROR;
   }
 
+  // the prepared plan might stem from a previous robot pose; the start is patched below with the latest one
+  std::vector<geometry_msgs::PoseStamped>& transformed_plan = input_.transformed_plan;
+  int goal_idx = input_.goal_idx;
+  const geometry_msgs::TransformStamped& tf_plan_to_global = input_.tf_plan_to_global;
+
   // update via-points container
   if (!custom_via_points_active_)
-    updateViaPointsContainer(transformed_plan, cfg_.trajectory.global_plan_viapoint_sep);
+    via_points_.swap(input_.via_points);
 
   nav_msgs::Odometry base_odom;
   odom_helper_.getOdom(base_odom);
@@ -336,17 +444,8 @@ uint32_t TebLocalPlannerROS::computeVelocityCommands(const geometry_msgs::PoseSt
   }
   transformed_plan.front() = robot_pose; // update start
     
-  // clear currently existing obstacles
-  obstacles_.clear();
-  
-  // Update obstacle container with costmap information or polygons provided by a costmap_converter plugin
-  if (costmap_converter_)
-    updateObstacleContainerWithCostmapConverter();
-  else
-    updateObstacleContainerWithCostmap();
-  
-  // also consider custom obstacles (must be called after other updates, since the container is not cleared)
-  updateObstacleContainerWithCustomObstacles();
+  // replace currently existing obstacles
+  obstacles_.swap(input_.obstacles);
   
     
   // Do not allow config changes during the following optimization step
@@ -354,7 +453,19 @@ uint32_t TebLocalPlannerROS::computeVelocityCommands(const geometry_msgs::PoseSt
     
   // Now perform the actual planning
 //   bool success = planner_->plan(robot_pose_, robot_goal_, robot_vel_, cfg_.goal_tolerance.free_goal_vel); // straight line init
-  bool success = planner_->plan(transformed_plan, &robot_vel_, cfg_.goal_tolerance.free_goal_vel);
+  bool success;
+  unsigned long solver_iterations = planner_->getSolverIterations();
+  std::chrono::steady_clock::time_point plan_start = std::chrono::steady_clock::now();
+  {
+    TEB_PROFILE_STAGE(Plan);
+    success = planner_->plan(transformed_plan, &robot_vel_, cfg_.goal_tolerance.free_goal_vel);
+  }
+  if (recorder_.isRecording())
+  {
+    recordPlanningCycle(transformed_plan, success, planner_->getSolverIterations() - solver_iterations,
+                        std::chrono::duration<double>(plan_start - cycle_start).count(),
+                        std::chrono::duration<double>(std::chrono::steady_clock::now() - plan_start).count());
+  }
   if (!success)
   {
     planner_->clearPlanner(); // force reinitialization for next time
@@ -389,8 +500,13 @@ uint32_t TebLocalPlannerROS::computeVelocityCommands(const geometry_msgs::PoseSt
     footprint_spec_ = costmap_ros_->getRobotFootprint();
     costmap_2d::calculateMinAndMaxDistances(footprint_spec_, robot_inscribed_radius_, robot_circumscribed_radius);
   }
+  updateFootprintCache(); // only rebuilt if the footprint or the costmap geometry changed
 
-  bool feasible = planner_->isTrajectoryFeasible(costmap_model_.get(), footprint_spec_, robot_inscribed_radius_, robot_circumscribed_radius, cfg_.trajectory.feasibility_check_no_poses);
+  bool feasible;
+  {
+    TEB_PROFILE_STAGE(FeasibilityCheck);
+    feasible = planner_->isTrajectoryFeasible(costmap_model_.get(), footprint_spec_, robot_inscribed_radius_, robot_circumscribed_radius, cfg_.trajectory.feasibility_check_no_poses);
+  }
   if (!feasible)
   {
     cmd_vel.twist.linear.x = cmd_vel.twist.linear.y = cmd_vel.twist.angular.z = 0;
@@ -451,14 +567,147 @@ uint32_t TebLocalPlannerROS::computeVelocityCommands(const geometry_msgs::PoseSt
   last_cmd_ = cmd_vel.twist;
   
   // Now visualize everything    
-  planner_->visualize();
-  visualization_->publishObstacles(obstacles_);
-  visualization_->publishViaPoints(via_points_);
-  visualization_->publishGlobalPlan(global_plan_);
+  {
+    TEB_PROFILE_STAGE(Visualization);
+    planner_->visualize();
+    visualization_->publishObstacles(obstacles_);
+    visualization_->publishViaPoints(via_points_);
+    visualization_->publishGlobalPlan(global_plan_);
+  }
   return mbf_msgs::ExePathResult::SUCCESS;
 }
 
 
+void TebLocalPlannerROS::recordPlanningCycle(const std::vector<geometry_msgs::PoseStamped>& transformed_plan, bool success,
+                                             unsigned long solver_iterations, double prepare_time, double plan_time)
+{
+  // take over the changes received by other threads
+  obstacle_prediction::ObstacleArray::ConstPtr predictions;
+  nav_msgs::OccupancyGrid::ConstPtr costmap;
+  RobotFootprintModelPtr footprint;
+  bool config_changed;
+  {
+    boost::mutex::scoped_lock lock(record_mutex_);
+    predictions = record_predictions_;
+    costmap.swap(record_costmap_);
+    footprint.swap(record_footprint_);
+    config_changed = record_config_;
+    record_config_ = false;
+  }
+
+  // the config is locked by the caller; changes that are dropped are retried in the next cycle
+  if (config_changed)
+  {
+    config_hash_ = computeConfigHash(cfg_);
+    config_changed = !recorder_.recordConfig(cfg_);
+  }
+  if (footprint && recorder_.recordFootprint(*footprint))
+    footprint.reset();
+  if (costmap && recorder_.recordGlobalCostmap(costmap))
+    costmap.reset();
+  if (config_changed || footprint || costmap)
+  {
+    boost::mutex::scoped_lock lock(record_mutex_);
+    record_config_ = record_config_ || config_changed;
+    if (!record_footprint_)
+      record_footprint_ = footprint;
+    if (!record_costmap_)
+      record_costmap_ = costmap;
+  }
+
+  double stamp = ros::Time::now().toSec();
+  record_input_.stamp = stamp;
+  record_input_.plan = transformed_plan;
+  record_input_.robot_vel = robot_vel_;
+  record_input_.free_goal_vel = cfg_.goal_tolerance.free_goal_vel;
+  record_input_.obstacles = obstacles_;
+  record_input_.via_points = via_points_;
+  record_input_.predictions = predictions ? *predictions : obstacle_prediction::ObstacleArray();
+  record_input_.config_hash = config_hash_;
+
+  // results of the selected trajectory
+  TebOptimalPlannerPtr best_teb;
+  if (boost::shared_ptr<HomotopyClassPlanner> hcp = boost::dynamic_pointer_cast<HomotopyClassPlanner>(planner_))
+    best_teb = hcp->bestTeb();
+  else
+    best_teb = boost::dynamic_pointer_cast<TebOptimalPlanner>(planner_);
+
+  record_output_.stamp = stamp;
+  record_output_.success = success;
+  record_output_.cost = best_teb ? best_teb->getCurrentCost() : 0;
+  record_output_.solver_iterations = solver_iterations;
+  record_output_.prepare_time = prepare_time;
+  record_output_.plan_time = plan_time;
+  record_output_.trajectory.clear();
+  if (success && best_teb)
+  {
+    const TimedElasticBand& teb = best_teb->teb();
+    double time_from_start = 0;
+    for (int i = 0; i < teb.sizePoses(); ++i)
+    {
+      PlanningCycleOutput::TrajectoryPose pose = {teb.Pose(i).x(), teb.Pose(i).y(), teb.Pose(i).theta(), time_from_start};
+      record_output_.trajectory.push_back(pose);
+      if (i < teb.sizeTimeDiffs())
+        time_from_start += teb.TimeDiff(i);
+    }
+  }
+
+  if (!recorder_.recordCycle(record_input_, record_output_))
+    ROS_WARN_THROTTLE(5.0, "Planning log: the writer cannot keep up, dropping planning cycles.");
+}
+
+void TebLocalPlannerROS::recordPredictionsCB(const obstacle_prediction::ObstacleArray::ConstPtr& predictions_msg)
+{
+  boost::mutex::scoped_lock lock(record_mutex_);
+  record_predictions_ = predictions_msg;
+}
+
+void TebLocalPlannerROS::recordCostmapCB(const nav_msgs::OccupancyGrid::ConstPtr& costmap_msg)
+{
+  boost::mutex::scoped_lock lock(record_mutex_);
+  record_costmap_ = costmap_msg;
+}
+
+void TebLocalPlannerROS::prepareInput(const geometry_msgs::PoseStamped& robot_pose, const costmap_2d::Costmap2D& costmap,
+                                      std::vector<geometry_msgs::PoseStamped>& global_plan, PlanningInput& input)
+{
+  // prune global plan to cut off parts of the past (spatially before the robot)
+  {
+    TEB_PROFILE_STAGE(PrunePlan);
+    pruneGlobalPlan(*tf_, robot_pose, global_plan, cfg_.trajectory.global_plan_prune_distance);
+  }
+
+  // Transform global plan to the frame of interest (w.r.t. the local costmap)
+  {
+    TEB_PROFILE_STAGE(TransformPlan);
+    input.plan_valid = transformGlobalPlan(*tf_, global_plan, robot_pose, costmap, global_frame_, cfg_.trajectory.max_global_plan_lookahead_dist,
+                                           input.transformed_plan, &input.goal_idx, &input.tf_plan_to_global);
+  }
+  if (!input.plan_valid)
+    return;
+
+  // generate via-points (only taken if no custom via-points are active)
+  {
+    TEB_PROFILE_STAGE(UpdateViaPoints);
+    updateViaPointsContainer(input.transformed_plan, cfg_.trajectory.global_plan_viapoint_sep, input.via_points);
+  }
+
+  TEB_PROFILE_STAGE(UpdateObstacles);
+
+  // clear previously prepared obstacles
+  input.obstacles.clear();
+
+  // Update obstacle container with costmap information or polygons provided by a costmap_converter plugin
+  if (costmap_converter_)
+    updateObstacleContainerWithCostmapConverter(input.obstacles);
+  else
+    updateObstacleContainerWithCostmap(costmap, PoseSE2(robot_pose.pose), input.obstacles);
+
+  // also consider custom obstacles (must be called after other updates, since the container is not cleared)
+  updateObstacleContainerWithCustomObstacles(input.obstacles);
+}
+
+
 bool TebLocalPlannerROS::isGoalReached()
 {
   if (goal_reached_)
@@ -472,60 +721,60 @@ bool TebLocalPlannerROS::isGoalReached()
 
 
 
-void TebLocalPlannerROS::updateObstacleContainerWithCostmap()
+void TebLocalPlannerROS::updateObstacleContainerWithCostmap(const costmap_2d::Costmap2D& costmap, const PoseSE2& robot_pose, ObstContainer& obstacles)
 {  
   // Add costmap obstacles if desired
   if (cfg_.obstacles.include_costmap_obstacles)
   {
-    Eigen::Vector2d robot_orient = robot_pose_.orientationUnitVec();
+    Eigen::Vector2d robot_orient = robot_pose.orientationUnitVec();
     
-    for (unsigned int i=0; i<costmap_->getSizeInCellsX()-1; ++i)
+    for (unsigned int i=0; i<costmap.getSizeInCellsX()-1; ++i)
     {
-      for (unsigned int j=0; j<costmap_->getSizeInCellsY()-1; ++j)
+      for (unsigned int j=0; j<costmap.getSizeInCellsY()-1; ++j)
       {
-        if (costmap_->getCost(i,j) == costmap_2d::LETHAL_OBSTACLE)
+        if (costmap.getCost(i,j) == costmap_2d::LETHAL_OBSTACLE)
         {
           Eigen::Vector2d obs;
-          costmap_->mapToWorld(i,j,obs.coeffRef(0), obs.coeffRef(1));
+          costmap.mapToWorld(i,j,obs.coeffRef(0), obs.coeffRef(1));
             
           // check if obstacle is interesting (e.g. not far behind the robot)
-          Eigen::Vector2d obs_dir = obs-robot_pose_.position();
+          Eigen::Vector2d obs_dir = obs-robot_pose.position();
           if ( obs_dir.dot(robot_orient) < 0 && obs_dir.norm() > cfg_.obstacles.costmap_obstacles_behind_robot_dist  )
             continue;
             
-          obstacles_.push_back(ObstaclePtr(new PointObstacle(obs)));
+          obstacles.push_back(ObstaclePtr(new PointObstacle(obs)));
         }
       }
     }
   }
 }
 
-void TebLocalPlannerROS::updateObstacleContainerWithCostmapConverter()
+void TebLocalPlannerROS::updateObstacleContainerWithCostmapConverter(ObstContainer& obstacles)
 {
   if (!costmap_converter_)
     return;
     
   //Get obstacles from costmap converter
-  costmap_converter::ObstacleArrayConstPtr obstacles = costmap_converter_->getObstacles();
-  if (!obstacles)
+  costmap_converter::ObstacleArrayConstPtr obstacle_msg = costmap_converter_->getObstacles();
+  if (!obstacle_msg)
     return;
 
-  for (std::size_t i=0; i<obstacles->obstacles.size(); ++i)
+  for (std::size_t i=0; i<obstacle_msg->obstacles.size(); ++i)
   {
-    const costmap_converter::ObstacleMsg* obstacle = &obstacles->obstacles.at(i);
+    const costmap_converter::ObstacleMsg* obstacle = &obstacle_msg->obstacles.at(i);
     const geometry_msgs::Polygon* polygon = &obstacle->polygon;
 
     if (polygon->points.size()==1 && obstacle->radius > 0) // Circle
     {
-      obstacles_.push_back(ObstaclePtr(new CircularObstacle(polygon->points[0].x, polygon->points[0].y, obstacle->radius)));
+      obstacles.push_back(ObstaclePtr(new CircularObstacle(polygon->points[0].x, polygon->points[0].y, obstacle->radius)));
     }
     else if (polygon->points.size()==1) // Point
     {
-      obstacles_.push_back(ObstaclePtr(new PointObstacle(polygon->points[0].x, polygon->points[0].y)));
+      obstacles.push_back(ObstaclePtr(new PointObstacle(polygon->points[0].x, polygon->points[0].y)));
     }
     else if (polygon->points.size()==2) // Line
     {
-      obstacles_.push_back(ObstaclePtr(new LineObstacle(polygon->points[0].x, polygon->points[0].y,
+      obstacles.push_back(ObstaclePtr(new LineObstacle(polygon->points[0].x, polygon->points[0].y,
                                                         polygon->points[1].x, polygon->points[1].y )));
     }
     else if (polygon->points.size()>2) // Real polygon
@@ -536,17 +785,17 @@ void TebLocalPlannerROS::updateObstacleContainerWithCostmapConverter()
             polyobst->pushBackVertex(polygon->points[j].x, polygon->points[j].y);
         }
         polyobst->finalizePolygon();
-        obstacles_.push_back(ObstaclePtr(polyobst));
+        obstacles.push_back(ObstaclePtr(polyobst));
     }
 
     // Set velocity, if obstacle is moving
-    if(!obstacles_.empty())
-      obstacles_.back()->setCentroidVelocity(obstacles->obstacles[i].velocities, obstacles->obstacles[i].orientation);
+    if(!obstacles.empty())
+      obstacles.back()->setCentroidVelocity(obstacle_msg->obstacles[i].velocities, obstacle_msg->obstacles[i].orientation);
   }
 }
 
 
-void TebLocalPlannerROS::updateObstacleContainerWithCustomObstacles()
+void TebLocalPlannerROS::updateObstacleContainerWithCustomObstacles(ObstContainer& obstacles)
 {
   // Add custom obstacles obtained via message
   boost::mutex::scoped_lock l(custom_obst_mutex_);
@@ -575,14 +824,14 @@ void TebLocalPlannerROS::updateObstacleContainerWithCustomObstacles()
         Eigen::Vector3d pos( custom_obstacle_msg_.obstacles.at(i).polygon.points.front().x,
                              custom_obstacle_msg_.obstacles.at(i).polygon.points.front().y,
                              custom_obstacle_msg_.obstacles.at(i).polygon.points.front().z );
-        obstacles_.push_back(ObstaclePtr(new CircularObstacle( (obstacle_to_map_eig * pos).head(2), custom_obstacle_msg_.obstacles.at(i).radius)));
+        obstacles.push_back(ObstaclePtr(new CircularObstacle( (obstacle_to_map_eig * pos).head(2), custom_obstacle_msg_.obstacles.at(i).radius)));
       }
       else if (custom_obstacle_msg_.obstacles.at(i).polygon.points.size() == 1 ) // point
       {
         Eigen::Vector3d pos( custom_obstacle_msg_.obstacles.at(i).polygon.points.front().x,
                              custom_obstacle_msg_.obstacles.at(i).polygon.points.front().y,
                              custom_obstacle_msg_.obstacles.at(i).polygon.points.front().z );
-        obstacles_.push_back(ObstaclePtr(new PointObstacle( (obstacle_to_map_eig * pos).head(2) )));
+        obstacles.push_back(ObstaclePtr(new PointObstacle( (obstacle_to_map_eig * pos).head(2) )));
       }
       else if (custom_obstacle_msg_.obstacles.at(i).polygon.points.size() == 2 ) // line
       {
@@ -592,7 +841,7 @@ void TebLocalPlannerROS::updateObstacleContainerWithCustomObstacles()
         Eigen::Vector3d line_end( custom_obstacle_msg_.obstacles.at(i).polygon.points.back().x,
                                   custom_obstacle_msg_.obstacles.at(i).polygon.points.back().y,
                                   custom_obstacle_msg_.obstacles.at(i).polygon.points.back().z );
-        obstacles_.push_back(ObstaclePtr(new LineObstacle( (obstacle_to_map_eig * line_start).head(2),
+        obstacles.push_back(ObstaclePtr(new LineObstacle( (obstacle_to_map_eig * line_start).head(2),
                                                            (obstacle_to_map_eig * line_end).head(2) )));
       }
       else if (custom_obstacle_msg_.obstacles.at(i).polygon.points.empty())
@@ -611,19 +860,20 @@ void TebLocalPlannerROS::updateObstacleContainerWithCustomObstacles()
           polyobst->pushBackVertex( (obstacle_to_map_eig * pos).head(2) );
         }
         polyobst->finalizePolygon();
-        obstacles_.push_back(ObstaclePtr(polyobst));
+        obstacles.push_back(ObstaclePtr(polyobst));
       }
 
       // Set velocity, if obstacle is moving
-      if(!obstacles_.empty())
-        obstacles_.back()->setCentroidVelocity(custom_obstacle_msg_.obstacles[i].velocities, custom_obstacle_msg_.obstacles[i].orientation);
+      if(!obstacles.empty())
+        obstacles.back()->setCentroidVelocity(custom_obstacle_msg_.obstacles[i].velocities, custom_obstacle_msg_.obstacles[i].orientation);
     }
   }
 }
 
-void TebLocalPlannerROS::updateViaPointsContainer(const std::vector<geometry_msgs::PoseStamped>& transformed_plan, double min_separation)
+void TebLocalPlannerROS::updateViaPointsContainer(const std::vector<geometry_msgs::PoseStamped>& transformed_plan, double min_separation,
+                                                  ViaPointContainer& via_points)
 {
-  via_points_.clear();
+  via_points.clear();
   
   if (min_separation<=0)
     return;
@@ -636,7 +886,7 @@ void TebLocalPlannerROS::updateViaPointsContainer(const std::vector<geometry_msg
       continue;
         
     // add via-point
-    via_points_.push_back( Eigen::Vector2d( transformed_plan[i].pose.position.x, transformed_plan[i].pose.position.y ) );
+    via_points.push_back( Eigen::Vector2d( transformed_plan[i].pose.position.x, transformed_plan[i].pose.position.y ) );
     prev_idx = i;
   }
   
@@ -937,6 +1187,14 @@ void TebLocalPlannerROS::validateFootprints(double opt_inscribed_radius, double
                   "than the inscribed radius of the robot's footprint in the costmap parameters (%f, including 'footprint_padding'). "
                   "Infeasible optimziation results might occur frequently!", opt_inscribed_radius, min_obst_dist, costmap_inscribed_radius);
 }
+
+
+void TebLocalPlannerROS::updateFootprintCache()
+{
+  boost::shared_ptr<FootprintCostmapModel> cached_model = boost::dynamic_pointer_cast<FootprintCostmapModel>(costmap_model_);
+  if (cached_model)
+    cached_model->setFootprint(footprint_spec_);
+}
    
    
    
@@ -1048,6 +1306,13 @@ RobotFootprintModelPtr TebLocalPlannerROS::getRobotFootprintFromParamServer(cons
     ROS_INFO("No robot footprint model specified for trajectory optimization. Using point-shaped model.");
     return boost::make_shared<PointRobotFootprint>();
   }
+
+  // optional distance field of line and polygon footprints for point and circular obstacles (disabled by default).
+  // Its distances are conservative: they underestimate the exact distance by up to 0.71*distance_field_resolution.
+  double distance_field_resolution = 0.;
+  double distance_field_margin = 1.;
+  nh.param("footprint_model/distance_field_resolution", distance_field_resolution, distance_field_resolution);
+  nh.param("footprint_model/distance_field_margin", distance_field_margin, distance_field_margin);
     
   // point  
   if (model_name.compare("point") == 0)
@@ -1094,7 +1359,10 @@ RobotFootprintModelPtr TebLocalPlannerROS::getRobotFootprintFromParamServer(cons
     
     ROS_INFO_STREAM("Footprint model 'line' (line_start: [" << line_start[0] << "," << line_start[1] <<"]m, line_end: ["
                      << line_end[0] << "," << line_end[1] << "]m) loaded for trajectory optimization.");
-    return boost::make_shared<LineRobotFootprint>(Eigen::Map<const Eigen::Vector2d>(line_start.data()), Eigen::Map<const Eigen::Vector2d>(line_end.data()), config.obstacles.min_obstacle_dist);
+    boost::shared_ptr<LineRobotFootprint> line_model = boost::make_shared<LineRobotFootprint>(Eigen::Map<const Eigen::Vector2d>(line_start.data()),
+                                                                                               Eigen::Map<const Eigen::Vector2d>(line_end.data()), config.obstacles.min_obstacle_dist);
+    line_model->setDistanceField(distance_field_resolution, distance_field_margin);
+    return line_model;
   }
   
   // two circles
@@ -1136,8 +1404,24 @@ RobotFootprintModelPtr TebLocalPlannerROS::getRobotFootprintFromParamServer(cons
       try
       {
         Point2dContainer polygon = makeFootprintFromXMLRPC(footprint_xmlrpc, "/footprint_model/vertices");
+        // optionally cover the polygon with circles, which are cheaper to evaluate
+        double circle_approximation_error = 0.;
+        nh.param("footprint_model/circle_approximation_error", circle_approximation_error, circle_approximation_error);
+        if (circle_approximation_error > 0.)
+        {
+          boost::shared_ptr<MultiCircleRobotFootprint> circles_model = approximatePolygonCached(polygon, circle_approximation_error);
+          if (circles_model)
+          {
+            ROS_INFO_STREAM("Footprint model 'polygon' approximated by " << circles_model->numCircles() << " circles (max. error: "
+                            << circle_approximation_error << "m) loaded for trajectory optimization.");
+            return circles_model;
+          }
+          ROS_WARN("Footprint model 'polygon' cannot be approximated by circles, since it has less than three vertices. Using the polygon instead.");
+        }
         ROS_INFO_STREAM("Footprint model 'polygon' loaded for trajectory optimization.");
-        return boost::make_shared<PolygonRobotFootprint>(polygon);
+        boost::shared_ptr<PolygonRobotFootprint> polygon_model = boost::make_shared<PolygonRobotFootprint>(polygon);
+        polygon_model->setDistanceField(distance_field_resolution, distance_field_margin);
+        return polygon_model;
       } 
       catch(const std::exception& ex)
       {
@@ -38,7 +38,9 @@
 
 #include <teb_local_planner/visualization.h>
 #include <teb_local_planner/optimal_planner.h>
+#include <teb_local_planner/latency_profiler.h>
 #include <teb_local_planner/FeedbackMsg.h>
+#include <teb_local_planner/LatencyMsg.h>
 
 namespace teb_local_planner
 {
@@ -66,6 +68,7 @@ void TebVisualization::initialize(ros::NodeHandle& nh, const TebConfig& cfg)
   teb_poses_pub_ = nh.advertise<geometry_msgs::PoseArray>("teb_poses", 100);
   teb_marker_pub_ = nh.advertise<visualization_msgs::Marker>("teb_markers", 1000);
   feedback_pub_ = nh.advertise<teb_local_planner::FeedbackMsg>("teb_feedback", 10);  
+  latency_pub_ = nh.advertise<teb_local_planner::LatencyMsg>("teb_latency", 10);
   
   initialized_ = true; 
 }
@@ -289,7 +292,7 @@ void TebVisualization::publishObstacles(const ObstContainer& obstacles) const
     std::size_t idx = 0;
     for (ObstContainer::const_iterator obst = obstacles.begin(); obst != obstacles.end(); ++obst)
     {	
-      boost::shared_ptr<PolygonObstacle> pobst = boost::dynamic_pointer_cast<PolygonObstacle>(*obst);   
+      boost::shared_ptr<const PolygonObstacle> pobst = boost::dynamic_pointer_cast<const PolygonObstacle>(*obst); // read-only access keeps the polygon finalized
       if (!pobst)
 				continue;
       
@@ -494,6 +497,32 @@ void TebVisualization::publishFeedbackMessage(const TebOptimalPlanner& teb_plann
   feedback_pub_.publish(msg);
 }
 
+void TebVisualization::publishLatencyStatistics(double period)
+{
+  if ( printErrorWhenNotInitialized() )
+    return;
+
+  std::vector<StageStatistics> statistics;
+  LatencyProfiler::instance().getStatistics(statistics);
+
+  LatencyMsg msg;
+  msg.header.stamp = ros::Time::now();
+  msg.period = period;
+  msg.stages.resize(statistics.size());
+  for (std::size_t i=0; i<statistics.size(); ++i)
+  {
+    msg.stages[i].name = LatencyProfiler::stageName(statistics[i].stage);
+    msg.stages[i].count = statistics[i].count;
+    msg.stages[i].mean = statistics[i].mean;
+    msg.stages[i].median = statistics[i].median;
+    msg.stages[i].p90 = statistics[i].p90;
+    msg.stages[i].p99 = statistics[i].p99;
+    msg.stages[i].max = statistics[i].max;
+  }
+
+  latency_pub_.publish(msg);
+}
+
 std_msgs::ColorRGBA TebVisualization::toColorMsg(double a, double r, double g, double b)
 {
   std_msgs::ColorRGBA color;
@@ -0,0 +1,189 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#include <teb_local_planner/worker_pool.h>
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+
+#include <ros/console.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace teb_local_planner
+{
+
+WorkerPool::WorkerPool(int num_workers, const std::vector<int>& cpu_affinity) : cpu_affinity_(cpu_affinity), submitted_jobs_(0), active_jobs_(0), stop_(false)
+{
+  if (num_workers <= 0)
+    num_workers = std::max(1u, boost::thread::hardware_concurrency());
+
+  workers_.reserve(num_workers);
+  for (int i = 0; i < num_workers; ++i)
+  {
+    workers_.push_back( boost::make_shared<boost::thread>(boost::bind(&WorkerPool::workerLoop, this)) );
+
+    if (!cpu_affinity_.empty())
+    {
+      int cpu = cpu_affinity_[i % cpu_affinity_.size()];
+      if (!pinThread(*workers_.back(), cpu))
+        ROS_WARN("WorkerPool: cannot pin worker %d to cpu %d. Worker is not pinned.", i, cpu);
+    }
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    stop_ = true;
+  }
+  job_available_.notify_all();
+
+  for (std::size_t i = 0; i < workers_.size(); ++i)
+    workers_[i]->join();
+}
+
+void WorkerPool::submit(const Job& job, double effort)
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    QueuedJob queued;
+    queued.job = job;
+    queued.effort = effort;
+    queued.seq = submitted_jobs_++;
+    jobs_.push(queued);
+  }
+  job_available_.notify_one();
+}
+
+void WorkerPool::waitAll()
+{
+  // Jobs usually operate on data owned by the caller, hence we must not leave before all of them are finished.
+  boost::this_thread::disable_interruption di;
+
+  boost::mutex::scoped_lock lock(mutex_);
+
+  // help the workers instead of idling (unless the jobs must stay on the pinned cores)
+  if (cpu_affinity_.empty())
+  {
+    while (!jobs_.empty())
+    {
+      Job job = popJob();
+      lock.unlock();
+      runJob(job);
+      lock.lock();
+    }
+  }
+
+  while (!jobs_.empty() || active_jobs_ > 0)
+    jobs_done_.wait(lock);
+}
+
+WorkerPool::Job WorkerPool::popJob()
+{
+  Job job = jobs_.top().job;
+  jobs_.pop();
+  return job;
+}
+
+void WorkerPool::runJob(const Job& job)
+{
+  try
+  {
+    job();
+  }
+  catch (const std::exception& ex)
+  {
+    ROS_ERROR("WorkerPool: job terminated with an exception: %s", ex.what());
+  }
+  catch (...)
+  {
+    // an escaping exception would skip the bookkeeping of active_jobs_ and let waitAll() hang
+    ROS_ERROR("WorkerPool: job terminated with an unknown exception.");
+  }
+}
+
+void WorkerPool::workerLoop()
+{
+  while (true)
+  {
+    Job job;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      while (!stop_ && jobs_.empty())
+        job_available_.wait(lock);
+
+      if (jobs_.empty()) // stop_ is set and nothing left to do
+        return;
+
+      job = popJob();
+      ++active_jobs_;
+    }
+
+    runJob(job);
+
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      --active_jobs_;
+      if (jobs_.empty() && active_jobs_ == 0)
+        jobs_done_.notify_all();
+    }
+  }
+}
+
+bool WorkerPool::pinThread(boost::thread& worker, int cpu)
+{
+#ifdef __linux__
+  if (cpu < 0 || cpu >= CPU_SETSIZE)
+    return false;
+
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu, &cpuset);
+  return pthread_setaffinity_np(worker.native_handle(), sizeof(cpu_set_t), &cpuset) == 0;
+#else
+  return false;
+#endif
+}
+
+} // namespace teb_local_planner
@@ -0,0 +1,114 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#include <teb_local_planner/distance_calculations.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+
+
+using namespace teb_local_planner;
+
+namespace
+{
+
+//! Convex polygon with \c num_vertices vertices on a circle around \c center
+Point2dContainer makePolygon(long num_vertices, const Eigen::Vector2d& center, double radius, double rotation = 0.)
+{
+  Point2dContainer vertices;
+  for (long i = 0; i < num_vertices; ++i)
+  {
+    double angle = rotation + 2. * M_PI * i / num_vertices;
+    vertices.push_back(center + radius * Eigen::Vector2d(std::cos(angle), std::sin(angle)));
+  }
+  return vertices;
+}
+
+} // anonymous namespace
+
+
+// regression: the triangle reduction keeps a single vertex if it is the closest point to the origin.
+// The warm start triangle (2,0), (3,0), (3,1) of the Minkowski difference is closest at its vertex (2,0).
+TEST(ConvexPolygonDistance, TriangleReducedToVertex)
+{
+  Point2dContainer square1 = makePolygon(4, Eigen::Vector2d(3., 0.), std::sqrt(0.5), M_PI / 4.);
+  Point2dContainer square2 = makePolygon(4, Eigen::Vector2d::Zero(), std::sqrt(0.5), M_PI / 4.);
+  GjkSimplexCache cache;
+  cache.size = 3;
+  for (int i = 0; i < 3; ++i)
+  {
+    cache.index1[i] = (i + 2) % 4; // vertices (2.5,-0.5), (3.5,-0.5) and (3.5,0.5) of square1
+    cache.index2[i] = 3; // vertex (0.5,-0.5) of square2
+  }
+  EXPECT_NEAR(distance_convex_polygons_2d(square1, square2, &cache), 2., 1e-9);
+  EXPECT_GE(cache.size, 1);
+  EXPECT_LE(cache.size, 3);
+}
+
+// random pairs; the cache is shared across pairs, hence most queries start from an arbitrary simplex
+TEST(ConvexPolygonDistance, MatchesPairwiseReference)
+{
+  const long polygon_sizes[] = {3, 4, 8, 16, 32, 64};
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> position(-3., 3.);
+  std::uniform_real_distribution<double> radius(0.2, 1.);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  for (long size1 : polygon_sizes)
+  {
+    for (long size2 : polygon_sizes)
+    {
+      GjkSimplexCache shared_cache;
+      for (int k = 0; k < 50; ++k)
+      {
+        Point2dContainer polygon1 = makePolygon(size1, Eigen::Vector2d(position(rng), position(rng)), radius(rng), angle(rng));
+        Point2dContainer polygon2 = makePolygon(size2, Eigen::Vector2d(position(rng), position(rng)), radius(rng), angle(rng));
+        EXPECT_NEAR(distance_convex_polygon_to_polygon_2d(polygon1, polygon2, &shared_cache),
+                    distance_polygon_to_polygon_2d(polygon1, polygon2), 1e-9)
+          << "polygon sizes " << size1 << " and " << size2 << ", pair " << k;
+      }
+    }
+  }
+}
+
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,161 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#include <teb_local_planner/footprint_costmap_model.h>
+
+#include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/cost_values.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <utility>
+
+
+using namespace teb_local_planner;
+
+namespace
+{
+
+geometry_msgs::Point makePoint(double x, double y)
+{
+  geometry_msgs::Point point;
+  point.x = x;
+  point.y = y;
+  return point;
+}
+
+//! Convex polygon with \c num_vertices vertices on a circle around the origin
+std::vector<geometry_msgs::Point> makePolygon(int num_vertices, double radius, double rotation = 0.)
+{
+  std::vector<geometry_msgs::Point> footprint_spec;
+  for (int i = 0; i < num_vertices; ++i)
+  {
+    double angle = rotation + 2. * M_PI * i / num_vertices;
+    footprint_spec.push_back(makePoint(radius * std::cos(angle), radius * std::sin(angle)));
+  }
+  return footprint_spec;
+}
+
+//! Footprint of a robot towing a cart (2 m x 0.6 m)
+std::vector<geometry_msgs::Point> makeCart()
+{
+  return {makePoint(-1.6, -0.3), makePoint(0.4, -0.3), makePoint(0.4, 0.3), makePoint(-1.6, 0.3)};
+}
+
+std::vector<std::pair<std::string, std::vector<geometry_msgs::Point> > > makeFootprints()
+{
+  return {
+    {"polygon4", makePolygon(4, 0.4, M_PI / 4.)},
+    {"polygon12", makePolygon(12, 0.4)},
+    {"cart", makeCart()}
+  };
+}
+
+//! 10 m x 10 m costmap (5 cm resolution) with scattered lethal cells
+void fillCostmap(costmap_2d::Costmap2D& costmap, std::mt19937& rng)
+{
+  std::uniform_int_distribution<unsigned int> cell(0, costmap.getSizeInCellsX() - 1);
+  for (int i = 0; i < 800; ++i)
+    costmap.setCost(cell(rng), cell(rng), costmap_2d::LETHAL_OBSTACLE);
+}
+
+} // anonymous namespace
+
+
+// the cache is conservative: a pose for which base_local_planner::CostmapModel reports a lethal cell is never accepted
+TEST(FootprintCostmapModel, NeverAcceptsCollidingPose)
+{
+  costmap_2d::Costmap2D costmap(200, 200, 0.05, -5., -5., 0);
+  std::mt19937 rng(3);
+  fillCostmap(costmap, rng);
+
+  base_local_planner::CostmapModel exact_model(costmap);
+  std::uniform_real_distribution<double> position(-4., 4.);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  for (const std::pair<std::string, std::vector<geometry_msgs::Point> >& footprint : makeFootprints())
+  {
+    for (int num_headings : {8, 72, 360})
+    {
+      FootprintCostmapModel cached_model(costmap, num_headings);
+      cached_model.setFootprint(footprint.second);
+      int num_colliding = 0;
+      int num_missed = 0;
+      for (int k = 0; k < 20000; ++k)
+      {
+        double x = position(rng), y = position(rng), theta = angle(rng);
+        if (exact_model.footprintCost(x, y, theta, footprint.second) != -1)
+          continue;
+        ++num_colliding;
+        if (cached_model.cachedFootprintCost(x, y, theta, footprint.second) != -1)
+          ++num_missed;
+      }
+      EXPECT_GT(num_colliding, 0) << footprint.first;
+      EXPECT_EQ(num_missed, 0) << footprint.first << " with " << num_headings << " heading bins";
+    }
+  }
+}
+
+// footprints that are not cached are checked exactly instead of rasterizing them during the query
+TEST(FootprintCostmapModel, FallsBackToExactCheckForUncachedFootprint)
+{
+  costmap_2d::Costmap2D costmap(200, 200, 0.05, -5., -5., 0);
+  std::mt19937 rng(5);
+  fillCostmap(costmap, rng);
+
+  base_local_planner::CostmapModel exact_model(costmap);
+  FootprintCostmapModel cached_model(costmap, 72);
+  cached_model.setFootprint(makePolygon(12, 0.4));
+  std::vector<geometry_msgs::Point> cart = makeCart();
+
+  std::uniform_real_distribution<double> position(-4., 4.);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  for (int k = 0; k < 1000; ++k)
+  {
+    double x = position(rng), y = position(rng), theta = angle(rng);
+    EXPECT_EQ(cached_model.cachedFootprintCost(x, y, theta, cart), exact_model.footprintCost(x, y, theta, cart));
+  }
+}
+
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
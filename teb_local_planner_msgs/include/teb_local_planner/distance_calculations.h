@@ -191,6 +191,26 @@ inline double distance_point_to_polygon_2d(const Eigen::Vector2d& point, const P
   return dist;
 }  
 
+/**
+ * @brief Helper function to check whether a point lies inside a closed polygon (crossing number test)
+ * @param point 2D point
+ * @param vertices Vertices describing the closed polygon (the first vertex is not repeated at the end)
+ * @return \c true if the point is inside the polygon, \c false otherwise (undefined for points on the boundary)
+ */
+inline bool is_point_in_polygon_2d(const Eigen::Vector2d& point, const Point2dContainer& vertices)
+{
+  bool inside = false;
+  for (std::size_t i = 0, j = vertices.size() - 1; i < vertices.size(); j = i++)
+  {
+    const Eigen::Vector2d& a = vertices[i];
+    const Eigen::Vector2d& b = vertices[j];
+    if ((a.y() > point.y()) != (b.y() > point.y())
+        && point.x() < (b.x() - a.x()) * (point.y() - a.y()) / (b.y() - a.y()) + a.x())
+      inside = !inside;
+  }
+  return inside;
+}
+
 /**
  * @brief Helper function to calculate the smallest distance between a line segment and a closed polygon
  * @param line_start 2D point representing the start of the line segment
@@ -260,9 +280,373 @@ inline double distance_polygon_to_polygon_2d(const Point2dContainer& vertices1,
 
   return dist;
 }
+
+/**
+ * @brief Check whether a closed polygon is convex
+ *
+ * Collinear and repeated vertices are allowed. Polygons with less than four vertices (points, lines and triangles)
+ * are always convex. Self-intersecting polygons are rejected, even if all turns have the same direction.
+ * @param vertices Vertices describing the closed polygon (the first vertex is not repeated at the end)
+ * @return \c true if the polygon is convex, \c false otherwise
+ */
+inline bool is_convex_polygon_2d(const Point2dContainer& vertices)
+{
+  int num_vertices = (int)vertices.size();
+  if (num_vertices < 4)
+    return true;
+
+  // compare each edge with the previous one of non-zero length, starting with the last one
+  Eigen::Vector2d prev_edge = Eigen::Vector2d::Zero();
+  for (int i = num_vertices - 1; i >= 0 && prev_edge.isZero(); --i)
+    prev_edge = vertices[(i + 1) % num_vertices] - vertices[i];
+
+  bool turns_left = false;
+  bool turns_right = false;
+  double total_turn = 0;
+  for (int i = 0; i < num_vertices; ++i)
+  {
+    Eigen::Vector2d edge = vertices[(i + 1) % num_vertices] - vertices[i];
+    if (edge.isZero())
+      continue; // repeated vertex
+    double cross = prev_edge.x() * edge.y() - prev_edge.y() * edge.x();
+    double dot = prev_edge.dot(edge);
+    prev_edge = edge;
+    if (cross * cross <= 1e-24 * dot * dot)
+    {
+      if (dot < 0) // the polygon folds back onto itself
+        return false;
+      continue; // collinear vertex
+    }
+    if (cross > 0)
+      turns_left = true;
+    else
+      turns_right = true;
+    total_turn += std::atan2(cross, dot);
+  }
+  // a simple convex polygon turns exactly once around, a self-intersecting one (e.g. a pentagram) more often
+  return !(turns_left && turns_right) && std::abs(std::abs(total_turn) - 2 * M_PI) < 1e-6;
+}
+
+
+/**
+ * @brief Simplex of a previous distance_convex_polygons_2d() query
+ *
+ * The simplex is stored as pairs of vertex indices of both polygons, so that it remains valid if the polygons are
+ * transformed. Passing the simplex of the previous pose of a trajectory warm starts the next query, which then
+ * usually converges within one or two iterations.
+ */
+struct GjkSimplexCache
+{
+  int size = 0; //!< Number of simplex vertices (0 if the cache is empty)
+  int index1[3]; //!< Index of the vertex of the first polygon for each simplex vertex
+  int index2[3]; //!< Index of the vertex of the second polygon for each simplex vertex
+};
+
+/**
+ * @brief Helper function to calculate the smallest distance between two convex polygons with the GJK algorithm
+ *
+ * The Gilbert-Johnson-Keerthi algorithm iterates a simplex of the Minkowski difference of both polygons towards the
+ * origin. Each iteration requires one support point, hence the complexity is linear in the number of vertices
+ * instead of quadratic as for distance_polygon_to_polygon_2d().
+ * @remarks Both polygons must be convex (see is_convex_polygon_2d()), otherwise the distance to the convex hull is returned.
+ * @param vertices1 Vertices describing the first closed convex polygon (the first vertex is not repeated at the end)
+ * @param vertices2 Vertices describing the second closed convex polygon (the first vertex is not repeated at the end)
+ * @param[in,out] cache [optional] simplex of a previous query used as initial simplex, updated with the final simplex
+ * @return smallest distance between both polygons, or a negative value if they overlap or touch
+ */
+inline double distance_convex_polygons_2d(const Point2dContainer& vertices1, const Point2dContainer& vertices2, GjkSimplexCache* cache = NULL)
+{
+  int num_vertices1 = (int)vertices1.size();
+  int num_vertices2 = (int)vertices2.size();
+  if (num_vertices1 == 0 || num_vertices2 == 0)
+    return HUGE_VAL;
+
+  // simplex vertices w = v1 - v2 of the Minkowski difference and the indices of v1 and v2
+  Eigen::Vector2d w[3];
+  int index1[3];
+  int index2[3];
+  int size = 0;
+  if (cache)
+  {
+    for (int i = 0; i < cache->size; ++i)
+    {
+      if (cache->index1[i] >= num_vertices1 || cache->index2[i] >= num_vertices2)
+      {
+        size = 0; // the cache belongs to other polygons
+        break;
+      }
+      index1[size] = cache->index1[i];
+      index2[size] = cache->index2[i];
+      w[size] = vertices1[index1[size]] - vertices2[index2[size]];
+      ++size;
+    }
+  }
+  if (size == 0)
+  {
+    index1[0] = 0;
+    index2[0] = 0;
+    w[0] = vertices1[0] - vertices2[0];
+    size = 1;
+  }
+
+  double dist = -1;
+  const int max_iterations = num_vertices1 + num_vertices2 + 4; // reported as overlap if exceeded due to rounding
+  for (int iteration = 0; iteration < max_iterations; ++iteration)
+  {
+    // closest point of the simplex to the origin, the simplex is reduced to the vertices spanning it
+    Eigen::Vector2d closest;
+    if (size == 3)
+    {
+      double cross0 = w[0].x() * w[1].y() - w[0].y() * w[1].x();
+      double cross1 = w[1].x() * w[2].y() - w[1].y() * w[2].x();
+      double cross2 = w[2].x() * w[0].y() - w[2].y() * w[0].x();
+      if ((cross0 > 0 && cross1 > 0 && cross2 > 0) || (cross0 < 0 && cross1 < 0 && cross2 < 0))
+        break; // the origin lies inside the triangle, hence the polygons overlap
+      // closest point is located on the edge (or a vertex) with the smallest distance
+      int best_keep[2] = {0, 0};
+      int best_num = 0;
+      double best_sq_dist = HUGE_VAL;
+      for (int i = 0; i < 3; ++i)
+      {
+        const Eigen::Vector2d& a = w[i];
+        const Eigen::Vector2d& b = w[(i + 1) % 3];
+        Eigen::Vector2d ab = b - a;
+        double sq_norm = ab.squaredNorm();
+        double t = sq_norm > 0 ? -a.dot(ab) / sq_norm : 0;
+        Eigen::Vector2d point;
+        int keep[2] = {i, i};
+        int num;
+        if (t <= 0)
+        {
+          point = a; keep[0] = i; num = 1;
+        }
+        else if (t >= 1)
+        {
+          point = b; keep[0] = (i + 1) % 3; num = 1;
+        }
+        else
+        {
+          point = a + t * ab; keep[0] = i; keep[1] = (i + 1) % 3; num = 2;
+        }
+        double sq_dist = point.squaredNorm();
+        if (sq_dist < best_sq_dist)
+        {
+          best_sq_dist = sq_dist;
+          closest = point;
+          best_num = num;
+          best_keep[0] = keep[0];
+          best_keep[1] = keep[1];
+        }
+      }
+      Eigen::Vector2d new_w[2] = {w[best_keep[0]], w[best_keep[1]]};
+      int new_index1[2] = {index1[best_keep[0]], index1[best_keep[1]]};
+      int new_index2[2] = {index2[best_keep[0]], index2[best_keep[1]]};
+      for (int i = 0; i < best_num; ++i)
+      {
+        w[i] = new_w[i];
+        index1[i] = new_index1[i];
+        index2[i] = new_index2[i];
+      }
+      size = best_num;
+    }
+    else if (size == 2)
+    {
+      Eigen::Vector2d ab = w[1] - w[0];
+      double sq_norm = ab.squaredNorm();
+      double t = sq_norm > 0 ? -w[0].dot(ab) / sq_norm : 0;
+      if (t <= 0)
+      {
+        closest = w[0];
+        size = 1;
+      }
+      else if (t >= 1)
+      {
+        closest = w[1];
+        w[0] = w[1]; index1[0] = index1[1]; index2[0] = index2[1];
+        size = 1;
+      }
+      else
+        closest = w[0] + t * ab;
+    }
+    else
+      closest = w[0];
+
+    double sq_dist = closest.squaredNorm();
+    if (sq_dist <= 1e-20)
+      break; // the polygons touch
+
+    // support point of the Minkowski difference in the direction of the origin
+    int support1 = 0;
+    double max_proj1 = -HUGE_VAL;
+    for (int i = 0; i < num_vertices1; ++i)
+    {
+      double proj = -closest.dot(vertices1[i]);
+      if (proj > max_proj1)
+      {
+        max_proj1 = proj;
+        support1 = i;
+      }
+    }
+    int support2 = 0;
+    double max_proj2 = -HUGE_VAL;
+    for (int i = 0; i < num_vertices2; ++i)
+    {
+      double proj = closest.dot(vertices2[i]);
+      if (proj > max_proj2)
+      {
+        max_proj2 = proj;
+        support2 = i;
+      }
+    }
+    Eigen::Vector2d support = vertices1[support1] - vertices2[support2];
+
+    // terminate if the support point does not get (significantly) closer to the origin than the current simplex
+    bool converged = sq_dist - closest.dot(support) <= 1e-12 * sq_dist;
+    for (int i = 0; i < size && !converged; ++i)
+      converged = index1[i] == support1 && index2[i] == support2;
+    if (converged)
+    {
+      dist = std::sqrt(sq_dist);
+      break;
+    }
+
+    w[size] = support;
+    index1[size] = support1;
+    index2[size] = support2;
+    ++size;
+  }
+
+  if (cache)
+  {
+    cache->size = size;
+    for (int i = 0; i < size; ++i)
+    {
+      cache->index1[i] = index1[i];
+      cache->index2[i] = index2[i];
+    }
+  }
+  return dist;
+}
+
+/**
+ * @brief Helper function to calculate the smallest distance between two convex polygons
+ *
+ * Same result as distance_polygon_to_polygon_2d(), but computed with distance_convex_polygons_2d() if the polygons
+ * are separated. Overlapping polygons are passed to distance_polygon_to_polygon_2d(), which returns zero if the
+ * boundaries intersect and the distance between the boundaries if one polygon contains the other.
+ * @param vertices1 Vertices describing the first closed convex polygon (the first vertex is not repeated at the end)
+ * @param vertices2 Vertices describing the second closed convex polygon (the first vertex is not repeated at the end)
+ * @param[in,out] cache [optional] simplex used to warm start the GJK algorithm (@see GjkSimplexCache)
+ * @return smallest distance between both polygons
+ */
+inline double distance_convex_polygon_to_polygon_2d(const Point2dContainer& vertices1, const Point2dContainer& vertices2, GjkSimplexCache* cache = NULL)
+{
+  double dist = distance_convex_polygons_2d(vertices1, vertices2, cache);
+  if (dist >= 0)
+    return dist;
+  return distance_polygon_to_polygon_2d(vertices1, vertices2);
+}
+
+  
   
   
   
+/**
+ * @brief Edges of a closed polygon in structure of arrays layout
+ *
+ * The edges are precomputed once per polygon, so that distance_points_to_polygon_2d() can evaluate
+ * many query points at once. It covers the same edges as distance_point_to_polygon_2d().
+ */
+struct PolygonEdgeArrays
+{
+  Eigen::ArrayXd start_x; //!< x-coordinate of the first vertex of each edge
+  Eigen::ArrayXd start_y; //!< y-coordinate of the first vertex of each edge
+  Eigen::ArrayXd diff_x; //!< x-component of the vector from the first to the second vertex of each edge
+  Eigen::ArrayXd diff_y; //!< y-component of the vector from the first to the second vertex of each edge
+  Eigen::ArrayXd inv_sq_norm; //!< Inverse squared length of each edge, zero for edges of zero length
+
+  PolygonEdgeArrays() {}
+
+  explicit PolygonEdgeArrays(const Point2dContainer& vertices) {set(vertices);}
+
+  /**
+   * @brief Compute the edges of a closed polygon
+   * @param vertices Vertices describing the closed polygon (the first vertex is not repeated at the end)
+   */
+  void set(const Point2dContainer& vertices)
+  {
+    // a single vertex is treated as edge of zero length, two vertices describe a line that is not closed
+    int num_edges = vertices.size() > 2 ? (int)vertices.size() : std::min<int>(1, vertices.size());
+    start_x.resize(num_edges);
+    start_y.resize(num_edges);
+    diff_x.resize(num_edges);
+    diff_y.resize(num_edges);
+    inv_sq_norm.resize(num_edges);
+    for (int i = 0; i < num_edges; ++i)
+    {
+      const Eigen::Vector2d& start = vertices[i];
+      const Eigen::Vector2d& end = vertices[(i + 1) % vertices.size()];
+      Eigen::Vector2d diff = end - start;
+      double sq_norm = diff.squaredNorm();
+      start_x[i] = start.x();
+      start_y[i] = start.y();
+      diff_x[i] = diff.x();
+      diff_y[i] = diff.y();
+      inv_sq_norm[i] = sq_norm == 0 ? 0. : 1. / sq_norm;
+    }
+  }
+
+  //! Number of edges
+  int size() const {return (int)start_x.size();}
+};
+
+/**
+ * @brief Helper function to calculate the smallest distance between many points and a closed polygon at once
+ *
+ * Batched version of distance_point_to_polygon_2d(): the polygon edges are iterated in the outer loop, the query points
+ * in the inner loop, which is free of branches and vectorized by Eigen (SSE/AVX/NEON depending on the target, scalar
+ * if vectorization is disabled). The results agree with distance_point_to_polygon_2d() up to rounding.
+ * @param points_x x-coordinates of the query points
+ * @param points_y y-coordinates of the query points
+ * @param edges Precomputed edges of the polygon
+ * @param[out] distances smallest distance between each query point and the polygon (same size as the query points)
+ */
+inline void distance_points_to_polygon_2d(const Eigen::Ref<const Eigen::ArrayXd>& points_x, const Eigen::Ref<const Eigen::ArrayXd>& points_y,
+                                          const PolygonEdgeArrays& edges, Eigen::Ref<Eigen::ArrayXd> distances)
+{
+  // accumulate squared distances and take the square root once
+  distances.setConstant(HUGE_VAL);
+  Eigen::ArrayXd u(points_x.size());
+  for (int i = 0; i < edges.size(); ++i)
+  {
+    // parameter of the closest point on the edge, clamped to the edge
+    u = (((points_x - edges.start_x[i]) * edges.diff_x[i] + (points_y - edges.start_y[i]) * edges.diff_y[i]) * edges.inv_sq_norm[i]).max(0.).min(1.);
+    distances = distances.min((edges.start_x[i] + u * edges.diff_x[i] - points_x).square() + (edges.start_y[i] + u * edges.diff_y[i] - points_y).square());
+  }
+  distances = distances.sqrt();
+}
+
+/**
+ * @brief Helper function to calculate the distance between many points and a line segment at once
+ *
+ * Batched version of distance_point_to_segment_2d(), vectorized by Eigen.
+ * @param points_x x-coordinates of the query points
+ * @param points_y y-coordinates of the query points
+ * @param line_start 2D point representing the start of the line segment
+ * @param line_end 2D point representing the end of the line segment
+ * @param[out] distances distance between each query point and the line segment (same size as the query points)
+ */
+inline void distance_points_to_segment_2d(const Eigen::Ref<const Eigen::ArrayXd>& points_x, const Eigen::Ref<const Eigen::ArrayXd>& points_y,
+                                          const Eigen::Ref<const Eigen::Vector2d>& line_start, const Eigen::Ref<const Eigen::Vector2d>& line_end,
+                                          Eigen::Ref<Eigen::ArrayXd> distances)
+{
+  Eigen::Vector2d diff = line_end - line_start;
+  double sq_norm = diff.squaredNorm();
+  double inv_sq_norm = sq_norm == 0 ? 0. : 1. / sq_norm;
+  Eigen::ArrayXd u = (((points_x - line_start.x()) * diff.x() + (points_y - line_start.y()) * diff.y()) * inv_sq_norm).max(0.).min(1.);
+  distances = ((line_start.x() + u * diff.x() - points_x).square() + (line_start.y() + u * diff.y() - points_y).square()).sqrt();
+}
+  
   
 // Further distance calculations:
 
@@ -0,0 +1,227 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2016,
+ *  TU Dortmund - Institute of Control Theory and Systems Engineering.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the institute nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************/
+
+#ifndef FOOTPRINT_DISTANCE_FIELD_H_
+#define FOOTPRINT_DISTANCE_FIELD_H_
+
+#include <teb_local_planner/pose_se2.h>
+#include <teb_local_planner/obstacles.h>
+#include <teb_local_planner/distance_calculations.h>
+
+#include <ros/console.h>
+
+#include <algorithm>
+#include <cmath>
+#include <typeinfo>
+#include <vector>
+
+
+namespace teb_local_planner
+{
+
+/**
+ * @class FootprintDistanceField
+ * @brief Signed distance to a robot footprint sampled on a regular grid in the robot frame
+ *
+ * Distances of point and circular obstacles are obtained by transforming the obstacle into the robot frame and
+ * interpolating bilinearly between the four surrounding grid nodes, independently of the number of footprint vertices
+ * and without transforming the footprint into the world frame. Points beyond the margin are not covered, callers
+ * fall back to the exact distance.
+ *
+ * The interpolated distance is conservative: since the distance is 1-Lipschitz, bilinear interpolation overestimates
+ * it by at most resolution*sqrt(fx*(1-fx) + fy*(1-fy)) for the fractional grid coordinates fx, fy (at most
+ * 0.71*resolution in the cell center, largest close to the footprint corners). This bound is subtracted, hence the
+ * result never exceeds the exact distance and underestimates it by at most 0.71*resolution. As for the exact path,
+ * the result is not negative for points inside the footprint (it is clamped to zero instead).
+ */
+class FootprintDistanceField
+{
+public:
+
+  /**
+   * @brief Default constructor, the field is empty
+   */
+  FootprintDistanceField() : origin_x_(0.), origin_y_(0.), resolution_(0.), margin_(0.), cols_(0), rows_(0) {}
+
+  /**
+   * @brief Sample the signed distance to a footprint
+   * @param footprint Footprint vertices in the robot frame: a closed polygon (the first vertex is not repeated at the end),
+   *                  a line (two vertices) or a point
+   * @param resolution Distance between grid nodes [m], the field is cleared if it is not positive
+   * @param margin Distance [m] by which the grid extends beyond the bounding box of the footprint
+   */
+  void build(const Point2dContainer& footprint, double resolution, double margin)
+  {
+    clear();
+    if (resolution <= 0. || footprint.empty())
+      return;
+
+    Eigen::Vector2d min_corner = footprint.front();
+    Eigen::Vector2d max_corner = footprint.front();
+    for (const Eigen::Vector2d& vertex : footprint)
+    {
+      min_corner = min_corner.cwiseMin(vertex);
+      max_corner = max_corner.cwiseMax(vertex);
+    }
+    margin = std::max(margin, 0.);
+    int cols = (int)std::ceil((max_corner.x() - min_corner.x() + 2. * margin) / resolution) + 2;
+    int rows = (int)std::ceil((max_corner.y() - min_corner.y() + 2. * margin) / resolution) + 2;
+    if ((double)cols * rows > max_nodes_)
+    {
+      ROS_WARN("Footprint distance field: %d x %d nodes exceed the limit of %d, use a coarser resolution (%g m) or a smaller margin (%g m). "
+               "Using the exact distances instead.", cols, rows, max_nodes_, resolution, margin);
+      return;
+    }
+
+    origin_x_ = min_corner.x() - margin;
+    origin_y_ = min_corner.y() - margin;
+    resolution_ = resolution;
+    margin_ = margin;
+    cols_ = cols;
+    rows_ = rows;
+    values_.resize((std::size_t)cols_ * rows_);
+
+    bool closed = footprint.size() > 2;
+    for (int row = 0; row < rows_; ++row)
+    {
+      for (int col = 0; col < cols_; ++col)
+      {
+        Eigen::Vector2d node(origin_x_ + col * resolution_, origin_y_ + row * resolution_);
+        double dist = distance_point_to_polygon_2d(node, footprint);
+        if (closed && is_point_in_polygon_2d(node, footprint))
+          dist = -dist;
+        values_[(std::size_t)row * cols_ + col] = (float)dist;
+      }
+    }
+  }
+
+  /**
+   * @brief Remove all samples, afterwards empty() returns \c true
+   */
+  void clear()
+  {
+    values_.clear();
+    resolution_ = 0.;
+    margin_ = 0.;
+    cols_ = rows_ = 0;
+  }
+
+  //! Check if the field contains samples
+  bool empty() const {return values_.empty();}
+
+  double resolution() const {return resolution_;} //!< Distance between grid nodes (zero if empty)
+  double margin() const {return margin_;} //!< Extent of the grid beyond the bounding box of the footprint
+
+  /**
+   * @brief Interpolate a lower bound of the distance between a point in the robot frame and the footprint
+   * @param x x-coordinate w.r.t. the robot center
+   * @param y y-coordinate w.r.t. the robot center
+   * @param[out] distance distance to the footprint, zero inside (only written if the point is covered by the grid)
+   * @return \c true if the point is covered by the grid, \c false otherwise
+   */
+  bool getDistance(double x, double y, double& distance) const
+  {
+    double grid_x = (x - origin_x_) / resolution_;
+    double grid_y = (y - origin_y_) / resolution_;
+    if (!(grid_x >= 0. && grid_y >= 0. && grid_x < cols_ - 1 && grid_y < rows_ - 1)) // also rejects NaN and empty fields
+      return false;
+    int col = (int)grid_x;
+    int row = (int)grid_y;
+    double frac_x = grid_x - col;
+    double frac_y = grid_y - row;
+    const float* lower = &values_[(std::size_t)row * cols_ + col];
+    const float* upper = lower + cols_;
+    double interpolated = (1. - frac_y) * ((1. - frac_x) * lower[0] + frac_x * lower[1])
+                        + frac_y * ((1. - frac_x) * upper[0] + frac_x * upper[1]);
+    double error_bound = resolution_ * std::sqrt(frac_x * (1. - frac_x) + frac_y * (1. - frac_y));
+    distance = std::max(interpolated - error_bound, 0.);
+    return true;
+  }
+
+  /**
+   * @brief Interpolate the distance between the footprint at a given pose and a point or circular obstacle
+   * @param pose Robot pose
+   * @param obstacle Pointer to the obstacle, other types than PointObstacle and CircularObstacle are not supported
+   * @param t [optional] time at which the obstacle position is predicted (constant velocity model)
+   * @param[out] distance lower bound of the distance to the obstacle (only written if the obstacle is supported and covered by the grid)
+   * @return \c true if \c distance has been computed, \c false if the exact distance is required
+   */
+  bool getObstacleDistance(const PoseSE2& pose, const Obstacle* obstacle, double& distance, double t = 0.) const
+  {
+    if (empty())
+      return false;
+
+    // compare the exact type, which is cheaper than a dynamic_cast in this hot path
+    double radius = 0.;
+    const std::type_info& type = typeid(*obstacle);
+    if (type == typeid(CircularObstacle))
+      radius = static_cast<const CircularObstacle*>(obstacle)->radius();
+    else if (type != typeid(PointObstacle))
+      return false;
+
+    Eigen::Vector2d position;
+    if (t == 0.)
+      position = obstacle->getCentroid();
+    else
+      obstacle->predictCentroidConstantVelocity(t, position);
+
+    // rotate the obstacle into the robot frame instead of the footprint into the world frame
+    Eigen::Vector2d delta = position - pose.position();
+    double cos_th = std::cos(pose.theta());
+    double sin_th = std::sin(pose.theta());
+    if (!getDistance(cos_th * delta.x() + sin_th * delta.y(), -sin_th * delta.x() + cos_th * delta.y(), distance))
+      return false;
+    distance -= radius;
+    return true;
+  }
+
+private:
+
+  static const int max_nodes_ = 1 << 22; //!< Upper bound of the number of grid nodes (16 MB)
+
+  std::vector<float> values_; //!< Signed distance at each grid node (row-major)
+  double origin_x_; //!< x-coordinate of the first grid node in the robot frame
+  double origin_y_; //!< y-coordinate of the first grid node in the robot frame
+  double resolution_; //!< Distance between grid nodes
+  double margin_; //!< Extent of the grid beyond the bounding box of the footprint
+  int cols_; //!< Number of grid nodes along the x-axis
+  int rows_; //!< Number of grid nodes along the y-axis
+};
+
+} // namespace teb_local_planner
+
+#endif /* FOOTPRINT_DISTANCE_FIELD_H_ */
@@ -143,6 +143,22 @@ public:
    */
   virtual double getMinimumDistance(const Point2dContainer& polygon) const = 0;
 
+  /**
+   * @brief Get the minimum euclidean distances of many reference positions to the obstacle at once
+   *
+   * Equivalent to calling getMinimumDistance() for each position. Obstacle types override it
+   * with a version that is vectorized over the positions.
+   * @param positions_x x-coordinates of the reference positions
+   * @param positions_y y-coordinates of the reference positions
+   * @param[out] distances nearest possible distance of each position to the obstacle (same size as the positions)
+   */
+  virtual void getMinimumDistances(const Eigen::Ref<const Eigen::ArrayXd>& positions_x, const Eigen::Ref<const Eigen::ArrayXd>& positions_y,
+                                   Eigen::Ref<Eigen::ArrayXd> distances) const
+  {
+    for (int i = 0; i < positions_x.size(); ++i)
+      distances[i] = getMinimumDistance(Eigen::Vector2d(positions_x[i], positions_y[i]));
+  }
+
   /**
    * @brief Get the closest point on the boundary of the obstacle w.r.t. a specified reference position
    * @param position reference 2d position
@@ -359,6 +375,13 @@ public:
   {
     return (position-pos_).norm();
   }
+
+  // implements getMinimumDistances() of the base class
+  virtual void getMinimumDistances(const Eigen::Ref<const Eigen::ArrayXd>& positions_x, const Eigen::Ref<const Eigen::ArrayXd>& positions_y,
+                                   Eigen::Ref<Eigen::ArrayXd> distances) const
+  {
+    distances = ((positions_x - pos_.x()).square() + (positions_y - pos_.y()).square()).sqrt();
+  }
   
   // implements getMinimumDistance() of the base class
   virtual double getMinimumDistance(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end) const
@@ -504,6 +527,13 @@ public:
     return (position-pos_).norm() - radius_;
   }
 
+  // implements getMinimumDistances() of the base class
+  virtual void getMinimumDistances(const Eigen::Ref<const Eigen::ArrayXd>& positions_x, const Eigen::Ref<const Eigen::ArrayXd>& positions_y,
+                                   Eigen::Ref<Eigen::ArrayXd> distances) const
+  {
+    distances = ((positions_x - pos_.x()).square() + (positions_y - pos_.y()).square()).sqrt() - radius_;
+  }
+
   // implements getMinimumDistance() of the base class
   virtual double getMinimumDistance(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end) const
   {
@@ -654,6 +684,13 @@ public:
   {
     return distance_point_to_segment_2d(position, start_, end_);
   }
+
+  // implements getMinimumDistances() of the base class
+  virtual void getMinimumDistances(const Eigen::Ref<const Eigen::ArrayXd>& positions_x, const Eigen::Ref<const Eigen::ArrayXd>& positions_y,
+                                   Eigen::Ref<Eigen::ArrayXd> distances) const
+  {
+    distance_points_to_segment_2d(positions_x, positions_y, start_, end_, distances);
+  }
   
   // implements getMinimumDistance() of the base class
   virtual double getMinimumDistance(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end) const
@@ -802,6 +839,14 @@ public:
     return distance_point_to_segment_2d(position, start_, end_) - radius_;
   }
 
+  // implements getMinimumDistances() of the base class
+  virtual void getMinimumDistances(const Eigen::Ref<const Eigen::ArrayXd>& positions_x, const Eigen::Ref<const Eigen::ArrayXd>& positions_y,
+                                   Eigen::Ref<Eigen::ArrayXd> distances) const
+  {
+    distance_points_to_segment_2d(positions_x, positions_y, start_, end_, distances);
+    distances -= radius_;
+  }
+
   // implements getMinimumDistance() of the base class
   virtual double getMinimumDistance(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end) const
   {
@@ -859,6 +904,7 @@ public:
   void setStart(const Eigen::Ref<const Eigen::Vector2d>& start) {start_ = start; calcCentroid();}
   const Eigen::Vector2d& end() const {return end_;}
   void setEnd(const Eigen::Ref<const Eigen::Vector2d>& end) {end_ = end; calcCentroid();}
+  double radius() const {return radius_;} //!< Return the radius of the pill (read-only)
 
   // implements toPolygonMsg() of the base class
   virtual void toPolygonMsg(geometry_msgs::Polygon& polygon)
@@ -902,7 +948,7 @@ public:
   /**
     * @brief Default constructor of the polygon obstacle class
     */
-  PolygonObstacle() : Obstacle(), finalized_(false)
+  PolygonObstacle() : Obstacle(), convex_(false), finalized_(false)
   {
     centroid_.setConstant(NAN);
   }
@@ -969,6 +1015,16 @@ public:
   {
     return distance_point_to_polygon_2d(position, vertices_);
   }
+
+  // implements getMinimumDistances() of the base class
+  virtual void getMinimumDistances(const Eigen::Ref<const Eigen::ArrayXd>& positions_x, const Eigen::Ref<const Eigen::ArrayXd>& positions_y,
+                                   Eigen::Ref<Eigen::ArrayXd> distances) const
+  {
+    if (!finalized_) // the edges are computed in finalizePolygon()
+      Obstacle::getMinimumDistances(positions_x, positions_y, distances);
+    else
+      distance_points_to_polygon_2d(positions_x, positions_y, edges_, distances);
+  }
   
   // implements getMinimumDistance() of the base class
   virtual double getMinimumDistance(const Eigen::Vector2d& line_start, const Eigen::Vector2d& line_end) const
@@ -981,6 +1037,21 @@ public:
   {
     return distance_polygon_to_polygon_2d(polygon, vertices_);
   }
+
+  /**
+    * @brief Get the minimum euclidean distance to a convex polygon
+    *
+    * Uses the GJK algorithm if this polygon is convex as well, otherwise getMinimumDistance(const Point2dContainer&).
+    * @param polygon Vertices of a closed convex polygon (e.g. a polygonal robot footprint)
+    * @param[in,out] cache [optional] simplex of the previous query to warm start the GJK algorithm (@see GjkSimplexCache)
+    * @return Euclidean distance to the polygon
+    */
+  double getMinimumDistanceToConvex(const Point2dContainer& polygon, GjkSimplexCache* cache = NULL) const
+  {
+    if (convex_ && finalized_)
+      return distance_convex_polygon_to_polygon_2d(polygon, vertices_, cache);
+    return distance_polygon_to_polygon_2d(polygon, vertices_);
+  }
   
   // implements getMinimumDistanceVec() of the base class
   virtual Eigen::Vector2d getClosestPoint(const Eigen::Vector2d& position) const;
@@ -1043,7 +1114,12 @@ public:
   
   // Access or modify polygon
   const Point2dContainer& vertices() const {return vertices_;} //!< Access vertices container (read-only)
-  Point2dContainer& vertices() {return vertices_;} //!< Access vertices container
+
+  /**
+    * @brief Access vertices container
+    * @warning The cached edges and convexity are invalidated, call finalizePolygon() after modifying the vertices
+    */
+  Point2dContainer& vertices() {finalized_ = false; return vertices_;}
   
   /**
     * @brief Add a vertex to the polygon (edge-point)
@@ -1077,6 +1153,8 @@ public:
   {
     fixPolygonClosure();
     calcCentroid();
+    edges_.set(vertices_);
+    convex_ = is_convex_polygon_2d(vertices_);
     finalized_ = true;
   }
   
@@ -1089,6 +1167,11 @@ public:
     * @brief Get the number of vertices defining the polygon (the first vertex is counted once)
     */
   int noVertices() const {return (int)vertices_.size();}
+
+  /**
+    * @brief Check if the polygon is convex (determined in finalizePolygon())
+    */
+  bool isConvex() const {return convex_;}
   
   
   ///@}
@@ -1102,6 +1185,8 @@ protected:
   
   Point2dContainer vertices_; //!< Store vertices defining the polygon (@see pushBackVertex)
   Eigen::Vector2d centroid_; //!< Store the centroid coordinates of the polygon (@see calcCentroid)
+  PolygonEdgeArrays edges_; //!< Edges of the polygon for batched distance calculations (@see getMinimumDistances)
+  bool convex_; //!< Store whether the polygon is convex (@see getMinimumDistanceToConvex)
   
   bool finalized_; //!< Flat that keeps track if the polygon was finalized after adding all vertices
   
@@ -42,8 +42,12 @@
 
 #include <teb_local_planner/pose_se2.h>
 #include <teb_local_planner/obstacles.h>
+#include <teb_local_planner/footprint_distance_field.h>
 #include <visualization_msgs/Marker.h>
 
+#include <functional>
+#include <queue>
+
 namespace teb_local_planner
 {
 
@@ -82,6 +86,24 @@ public:
     */
   virtual double calculateDistance(const PoseSE2& current_pose, const Obstacle* obstacle) const = 0;
 
+  /**
+    * @brief Calculate the distances between the robot at many poses and an obstacle at once
+    *
+    * Equivalent to calling calculateDistance() for each pose. Footprint models that reduce to
+    * point distances override it using the batched Obstacle::getMinimumDistances().
+    * @param poses_x x-coordinates of the robot poses
+    * @param poses_y y-coordinates of the robot poses
+    * @param poses_theta orientations of the robot poses
+    * @param obstacle Pointer to the obstacle
+    * @param[out] distances Euclidean distance of the robot at each pose (same size as the poses)
+    */
+  virtual void calculateDistances(const Eigen::Ref<const Eigen::ArrayXd>& poses_x, const Eigen::Ref<const Eigen::ArrayXd>& poses_y,
+                                  const Eigen::Ref<const Eigen::ArrayXd>& poses_theta, const Obstacle* obstacle, Eigen::Ref<Eigen::ArrayXd> distances) const
+  {
+    for (int i = 0; i < poses_x.size(); ++i)
+      distances[i] = calculateDistance(PoseSE2(poses_x[i], poses_y[i], poses_theta[i]), obstacle);
+  }
+
   /**
     * @brief Estimate the distance between the robot and the predicted location of an obstacle at time t
     * @param current_pose robot pose, from which the distance to the obstacle is estimated
@@ -151,6 +173,11 @@ public:
    */
   virtual ~PointRobotFootprint() {}
 
+  /**
+    * @brief Get the minimum obstacle distance the footprint was constructed with
+    */
+  double getMinObstacleDist() const {return min_obstacle_dist_;}
+
   /**
     * @brief Calculate the distance between the robot and an obstacle
     * @param current_pose Current robot pose
@@ -161,6 +188,13 @@ public:
   {
     return obstacle->getMinimumDistance(current_pose.position());
   }
+
+  // implements calculateDistances() of the base class
+  virtual void calculateDistances(const Eigen::Ref<const Eigen::ArrayXd>& poses_x, const Eigen::Ref<const Eigen::ArrayXd>& poses_y,
+                                  const Eigen::Ref<const Eigen::ArrayXd>& poses_theta, const Obstacle* obstacle, Eigen::Ref<Eigen::ArrayXd> distances) const
+  {
+    obstacle->getMinimumDistances(poses_x, poses_y, distances);
+  }
   
   /**
     * @brief Estimate the distance between the robot and the predicted location of an obstacle at time t
@@ -253,6 +287,11 @@ public:
     * @param radius radius of the robot
     */
   void setRadius(double radius) {radius_ = radius;}
+
+  /**
+    * @brief Get radius of the circular robot
+    */
+  double getRadius() const {return radius_;}
   
   /**
     * @brief Calculate the distance between the robot and an obstacle
@@ -265,6 +304,14 @@ public:
     return obstacle->getMinimumDistance(current_pose.position()) - radius_;
   }
 
+  // implements calculateDistances() of the base class
+  virtual void calculateDistances(const Eigen::Ref<const Eigen::ArrayXd>& poses_x, const Eigen::Ref<const Eigen::ArrayXd>& poses_y,
+                                  const Eigen::Ref<const Eigen::ArrayXd>& poses_theta, const Obstacle* obstacle, Eigen::Ref<Eigen::ArrayXd> distances) const
+  {
+    obstacle->getMinimumDistances(poses_x, poses_y, distances);
+    distances -= radius_;
+  }
+
   /**
     * @brief Estimate the distance between the robot and the predicted location of an obstacle at time t
     * @param current_pose robot pose, from which the distance to the obstacle is estimated
@@ -341,6 +388,12 @@ public:
    */
   void setParameters(double front_offset, double front_radius, double rear_offset, double rear_radius) 
   {front_offset_=front_offset; front_radius_=front_radius; rear_offset_=rear_offset; rear_radius_=rear_radius;}
+
+  // Access parameters of the contour/footprint
+  double getFrontOffset() const {return front_offset_;} //!< Get the offset of the front circle
+  double getFrontRadius() const {return front_radius_;} //!< Get the radius of the front circle
+  double getRearOffset() const {return rear_offset_;} //!< Get the offset of the rear circle
+  double getRearRadius() const {return rear_radius_;} //!< Get the radius of the rear circle
   
   /**
     * @brief Calculate the distance between the robot and an obstacle
@@ -356,6 +409,18 @@ public:
     return std::min(dist_front, dist_rear);
   }
 
+  // implements calculateDistances() of the base class
+  virtual void calculateDistances(const Eigen::Ref<const Eigen::ArrayXd>& poses_x, const Eigen::Ref<const Eigen::ArrayXd>& poses_y,
+                                  const Eigen::Ref<const Eigen::ArrayXd>& poses_theta, const Obstacle* obstacle, Eigen::Ref<Eigen::ArrayXd> distances) const
+  {
+    Eigen::ArrayXd cos_theta = poses_theta.cos();
+    Eigen::ArrayXd sin_theta = poses_theta.sin();
+    Eigen::ArrayXd dist_rear(poses_x.size());
+    obstacle->getMinimumDistances(poses_x + front_offset_*cos_theta, poses_y + front_offset_*sin_theta, distances);
+    obstacle->getMinimumDistances(poses_x - rear_offset_*cos_theta, poses_y - rear_offset_*sin_theta, dist_rear);
+    distances = (distances - front_radius_).min(dist_rear - rear_radius_);
+  }
+
   /**
     * @brief Estimate the distance between the robot and the predicted location of an obstacle at time t
     * @param current_pose robot pose, from which the distance to the obstacle is estimated
@@ -475,6 +540,8 @@ public:
     line_start_.y() = line_start.y; 
     line_end_.x() = line_end.x;
     line_end_.y() = line_end.y;
+    if (!distance_field_.empty())
+      setDistanceField(distance_field_.resolution(), distance_field_.margin());
   }
   
   /**
@@ -485,7 +552,31 @@ public:
   {
     line_start_ = line_start; 
     line_end_ = line_end;
+    if (!distance_field_.empty())
+      setDistanceField(distance_field_.resolution(), distance_field_.margin());
+  }
+
+  /**
+   * @brief Precompute the distance field used for point and circular obstacles (@see FootprintDistanceField)
+   * @param resolution Distance between grid nodes [m], the exact distances are used if it is not positive.
+   *                   Interpolated distances are underestimated by at most 0.71*resolution, but never overestimated.
+   * @param margin Extent of the grid beyond the line [m], obstacles further away are evaluated exactly
+   */
+  void setDistanceField(double resolution, double margin)
+  {
+    Point2dContainer line;
+    line.push_back(line_start_);
+    line.push_back(line_end_);
+    distance_field_.build(line, resolution, margin);
   }
+
+  //! Access the distance field (empty if disabled)
+  const FootprintDistanceField& getDistanceField() const {return distance_field_;}
+
+  // Access the line w.r.t. the robot center
+  const Eigen::Vector2d& getLineStart() const {return line_start_;} //!< Get the start of the line (robot frame)
+  const Eigen::Vector2d& getLineEnd() const {return line_end_;} //!< Get the end of the line (robot frame)
+  double getMinObstacleDist() const {return min_obstacle_dist_;} //!< Get the minimum obstacle distance the footprint was constructed with
   
   /**
     * @brief Calculate the distance between the robot and an obstacle
@@ -495,6 +586,9 @@ public:
     */
   virtual double calculateDistance(const PoseSE2& current_pose, const Obstacle* obstacle) const
   {
+    double dist;
+    if (distance_field_.getObstacleDistance(current_pose, obstacle, dist))
+      return dist;
     Eigen::Vector2d line_start_world;
     Eigen::Vector2d line_end_world;
     transformToWorld(current_pose, line_start_world, line_end_world);
@@ -510,6 +604,9 @@ public:
     */
   virtual double estimateSpatioTemporalDistance(const PoseSE2& current_pose, const Obstacle* obstacle, double t) const
   {
+    double dist;
+    if (distance_field_.getObstacleDistance(current_pose, obstacle, dist, t))
+      return dist;
     Eigen::Vector2d line_start_world;
     Eigen::Vector2d line_end_world;
     transformToWorld(current_pose, line_start_world, line_end_world);
@@ -620,6 +717,7 @@ private:
   Eigen::Vector2d line_start_;
   Eigen::Vector2d line_end_;
   const double min_obstacle_dist_ = 0.0;
+  FootprintDistanceField distance_field_; //!< Optional distance field for point and circular obstacles
   
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -642,7 +740,7 @@ public:
     * @brief Default constructor of the abstract obstacle class
     * @param vertices footprint vertices (only x and y) around the robot center (0,0) (do not repeat the first and last vertex at the end)
     */
-  PolygonRobotFootprint(const Point2dContainer& vertices) : vertices_(vertices) { }
+  PolygonRobotFootprint(const Point2dContainer& vertices) : vertices_(vertices), convex_(is_convex_polygon_2d(vertices)) { }
   
   /**
    * @brief Virtual destructor.
@@ -653,7 +751,29 @@ public:
    * @brief Set vertices of the contour/footprint
    * @param vertices footprint vertices (only x and y) around the robot center (0,0) (do not repeat the first and last vertex at the end)
    */
-  void setVertices(const Point2dContainer& vertices) {vertices_ = vertices;}
+  void setVertices(const Point2dContainer& vertices)
+  {
+    vertices_ = vertices;
+    convex_ = is_convex_polygon_2d(vertices);
+    if (!distance_field_.empty())
+      distance_field_.build(vertices_, distance_field_.resolution(), distance_field_.margin());
+  }
+
+  /**
+   * @brief Precompute the distance field used for point and circular obstacles (@see FootprintDistanceField)
+   * @param resolution Distance between grid nodes [m], the exact distances are used if it is not positive.
+   *                   Interpolated distances are underestimated by at most 0.71*resolution, but never overestimated.
+   * @param margin Extent of the grid beyond the bounding box of the footprint [m], obstacles further away are evaluated exactly
+   */
+  void setDistanceField(double resolution, double margin) {distance_field_.build(vertices_, resolution, margin);}
+
+  //! Access the distance field (empty if disabled)
+  const FootprintDistanceField& getDistanceField() const {return distance_field_;}
+
+  /**
+   * @brief Get vertices of the contour/footprint (robot frame)
+   */
+  const Point2dContainer& getVertices() const {return vertices_;}
   
   /**
     * @brief Calculate the distance between the robot and an obstacle
@@ -663,11 +783,37 @@ public:
     */
   virtual double calculateDistance(const PoseSE2& current_pose, const Obstacle* obstacle) const
   {
+    double dist;
+    if (distance_field_.getObstacleDistance(current_pose, obstacle, dist))
+      return dist;
     Point2dContainer polygon_world(vertices_.size());
     transformToWorld(current_pose, polygon_world);
+    const PolygonObstacle* polygon_obstacle = convex_ ? dynamic_cast<const PolygonObstacle*>(obstacle) : NULL;
+    if (polygon_obstacle)
+      return polygon_obstacle->getMinimumDistanceToConvex(polygon_world);
     return obstacle->getMinimumDistance(polygon_world);
   }
 
+  // implements calculateDistances() of the base class
+  virtual void calculateDistances(const Eigen::Ref<const Eigen::ArrayXd>& poses_x, const Eigen::Ref<const Eigen::ArrayXd>& poses_y,
+                                  const Eigen::Ref<const Eigen::ArrayXd>& poses_theta, const Obstacle* obstacle, Eigen::Ref<Eigen::ArrayXd> distances) const
+  {
+    const PolygonObstacle* polygon_obstacle = convex_ ? dynamic_cast<const PolygonObstacle*>(obstacle) : NULL;
+    if (!polygon_obstacle)
+    {
+      BaseRobotFootprintModel::calculateDistances(poses_x, poses_y, poses_theta, obstacle, distances);
+      return;
+    }
+    // consecutive poses are close to each other, hence the simplex of the previous pose warm starts the next query
+    GjkSimplexCache cache;
+    Point2dContainer polygon_world(vertices_.size());
+    for (int i = 0; i < poses_x.size(); ++i)
+    {
+      transformToWorld(PoseSE2(poses_x[i], poses_y[i], poses_theta[i]), polygon_world);
+      distances[i] = polygon_obstacle->getMinimumDistanceToConvex(polygon_world, &cache);
+    }
+  }
+
   /**
     * @brief Estimate the distance between the robot and the predicted location of an obstacle at time t
     * @param current_pose robot pose, from which the distance to the obstacle is estimated
@@ -677,6 +823,9 @@ public:
     */
   virtual double estimateSpatioTemporalDistance(const PoseSE2& current_pose, const Obstacle* obstacle, double t) const
   {
+    double dist;
+    if (distance_field_.getObstacleDistance(current_pose, obstacle, dist, t))
+      return dist;
     Point2dContainer polygon_world(vertices_.size());
     transformToWorld(current_pose, polygon_world);
     return obstacle->getMinimumSpatioTemporalDistance(polygon_world, t);
@@ -766,11 +915,345 @@ private:
   }
 
   Point2dContainer vertices_;
+  bool convex_; //!< Store whether the footprint is convex, which enables the GJK distance to convex polygon obstacles
+  FootprintDistanceField distance_field_; //!< Optional distance field for point and circular obstacles
   
 };
 
 
 
+/**
+ * @class MultiCircleRobotFootprint
+ * @brief Class that approximates the robot with an arbitrary number of circles
+ *
+ * The distance to an obstacle is the minimum of the distances to all circles. It generalizes TwoCirclesRobotFootprint,
+ * e.g. for long carts, and the circles can be fitted to a polygon footprint with approximatePolygon().
+ */
+class MultiCircleRobotFootprint : public BaseRobotFootprintModel
+{
+public:
+
+  /**
+    * @brief Construct the footprint from a set of circles
+    * @param centers centers of the circles w.r.t. the robot center (0,0)
+    * @param radii radii of the circles (same size as \c centers)
+    */
+  MultiCircleRobotFootprint(const Point2dContainer& centers, const std::vector<double>& radii) {setCircles(centers, radii);}
+
+  /**
+   * @brief Virtual destructor.
+   */
+  virtual ~MultiCircleRobotFootprint() { }
+
+  /**
+   * @brief Set the circles of the footprint
+   * @param centers centers of the circles w.r.t. the robot center (0,0)
+   * @param radii radii of the circles (same size as \c centers)
+   */
+  void setCircles(const Point2dContainer& centers, const std::vector<double>& radii)
+  {
+    assert(centers.size() == radii.size() && "Provide a radius for each center.");
+    centers_x_.resize(centers.size());
+    centers_y_.resize(centers.size());
+    radii_.resize(centers.size());
+    for (std::size_t i = 0; i < centers.size(); ++i)
+    {
+      centers_x_[i] = centers[i].x();
+      centers_y_[i] = centers[i].y();
+      radii_[i] = radii[i];
+    }
+  }
+
+  // Access the circles w.r.t. the robot center
+  int numCircles() const {return (int)radii_.size();} //!< Get the number of circles
+  Eigen::Vector2d getCenter(int i) const {return Eigen::Vector2d(centers_x_[i], centers_y_[i]);} //!< Get the center of the i-th circle
+  double getRadius(int i) const {return radii_[i];} //!< Get the radius of the i-th circle
+
+  /**
+   * @brief Cover a polygon footprint conservatively with circles
+   *
+   * The polygon is sampled on a grid and along its boundary. Every candidate circle is centered at a sample and its
+   * radius is the clearance of the center plus \c max_error, hence it extends at most \c max_error beyond the polygon.
+   * Circles are selected greedily by the number of samples they newly cover (with a margin that accounts for the
+   * spacing of the samples) until the whole polygon is covered. Elongated footprints require few circles, sharp
+   * corners and small error bounds many.
+   * @param vertices vertices of the closed polygon w.r.t. the robot center (do not repeat the first vertex at the end)
+   * @param max_error maximum distance [m] by which the circles may extend beyond the polygon
+   * @return circle footprint, or an empty pointer if the polygon has less than three vertices or the error is not positive
+   */
+  static boost::shared_ptr<MultiCircleRobotFootprint> approximatePolygon(const Point2dContainer& vertices, double max_error)
+  {
+    if (vertices.size() < 3 || max_error <= 0)
+      return boost::shared_ptr<MultiCircleRobotFootprint>();
+
+    Eigen::Vector2d min_corner = vertices.front();
+    Eigen::Vector2d max_corner = vertices.front();
+    for (const Eigen::Vector2d& vertex : vertices)
+    {
+      min_corner = min_corner.cwiseMin(vertex);
+      max_corner = max_corner.cwiseMax(vertex);
+    }
+    Eigen::Vector2d extent = max_corner - min_corner;
+
+    // each point of the polygon is closer than 1.25 * spacing to a sample (grid node inside or boundary point)
+    const double max_samples = 1e5;
+    double spacing = max_error / 5.;
+    if ((extent.x() / spacing + 1.) * (extent.y() / spacing + 1.) > max_samples)
+    {
+      spacing = std::max(std::sqrt(extent.x() * extent.y() / max_samples), std::max(extent.x(), extent.y()) / max_samples);
+      ROS_WARN("MultiCircleRobotFootprint: the error bound of %.3f m requires too many samples, using %.4f m instead.", max_error, 5. * spacing);
+      max_error = 5. * spacing;
+    }
+    double margin = 1.25 * spacing;
+
+    // samples on the grid and the boundary. Every third grid node and every other boundary sample is a candidate center,
+    // which is sufficient to cover each sample since the candidates reach at least 3.75 * spacing.
+    Point2dContainer samples, candidates;
+    int cols = (int)(extent.x() / spacing) + 1;
+    int rows = (int)(extent.y() / spacing) + 1;
+    for (int row = 0; row < rows; ++row)
+    {
+      for (int col = 0; col < cols; ++col)
+      {
+        Eigen::Vector2d node = min_corner + spacing * Eigen::Vector2d(col, row);
+        if (!is_point_in_polygon_2d(node, vertices))
+          continue;
+        samples.push_back(node);
+        if (row % 3 == 0 && col % 3 == 0)
+          candidates.push_back(node);
+      }
+    }
+    for (std::size_t i = 0; i < vertices.size(); ++i)
+    {
+      const Eigen::Vector2d& start = vertices[i];
+      const Eigen::Vector2d& end = vertices[(i + 1) % vertices.size()];
+      int num_points = std::max(1, (int)std::ceil((end - start).norm() / spacing));
+      for (int k = 0; k < num_points; ++k)
+      {
+        samples.push_back(start + (double)k / num_points * (end - start));
+        if (k % 2 == 0)
+          candidates.push_back(samples.back());
+      }
+    }
+
+    // a sample is covered by a candidate if it lies inside the circle shrunk by the margin
+    std::vector<double> reach;
+    reach.reserve(candidates.size());
+    for (const Eigen::Vector2d& center : candidates)
+    {
+      double clearance = distance_point_to_polygon_2d(center, vertices);
+      if (!is_point_in_polygon_2d(center, vertices))
+        clearance = 0; // boundary sample
+      reach.push_back(clearance + max_error - margin);
+    }
+
+    // buckets of samples to visit only the samples close to a candidate
+    const double bucket_size = 8. * spacing;
+    int bucket_cols = (int)(extent.x() / bucket_size) + 1;
+    int bucket_rows = (int)(extent.y() / bucket_size) + 1;
+    std::vector<std::vector<int> > buckets(bucket_cols * bucket_rows);
+    for (std::size_t i = 0; i < samples.size(); ++i)
+    {
+      int col = std::min(bucket_cols - 1, std::max(0, (int)((samples[i].x() - min_corner.x()) / bucket_size)));
+      int row = std::min(bucket_rows - 1, std::max(0, (int)((samples[i].y() - min_corner.y()) / bucket_size)));
+      buckets[row * bucket_cols + col].push_back((int)i);
+    }
+    auto forEachSampleInReach = [&](std::size_t candidate, const std::function<void(int)>& visit)
+    {
+      const Eigen::Vector2d& center = candidates[candidate];
+      double sq_reach = reach[candidate] * reach[candidate];
+      int first_col = std::max(0, (int)((center.x() - reach[candidate] - min_corner.x()) / bucket_size));
+      int last_col = std::min(bucket_cols - 1, (int)((center.x() + reach[candidate] - min_corner.x()) / bucket_size));
+      int first_row = std::max(0, (int)((center.y() - reach[candidate] - min_corner.y()) / bucket_size));
+      int last_row = std::min(bucket_rows - 1, (int)((center.y() + reach[candidate] - min_corner.y()) / bucket_size));
+      for (int row = first_row; row <= last_row; ++row)
+      {
+        for (int col = first_col; col <= last_col; ++col)
+        {
+          for (int i : buckets[row * bucket_cols + col])
+          {
+            if ((samples[i] - center).squaredNorm() <= sq_reach)
+              visit(i);
+          }
+        }
+      }
+    };
+
+    std::vector<bool> covered(samples.size(), false);
+    std::size_t num_uncovered = samples.size();
+    auto countUncovered = [&](std::size_t candidate)
+    {
+      int count = 0;
+      forEachSampleInReach(candidate, [&](int i) {count += !covered[i];});
+      return count;
+    };
+
+    // greedy set cover, the gains are evaluated lazily since they never increase
+    std::vector<std::size_t> selected;
+    std::priority_queue<std::pair<int, std::size_t> > queue;
+    for (std::size_t i = 0; i < candidates.size(); ++i)
+      queue.push(std::make_pair(countUncovered(i), i));
+    while (num_uncovered > 0 && !queue.empty())
+    {
+      std::size_t candidate = queue.top().second;
+      queue.pop();
+      int gain = countUncovered(candidate);
+      if (gain == 0)
+        continue;
+      if (!queue.empty() && gain < queue.top().first)
+      {
+        queue.push(std::make_pair(gain, candidate));
+        continue;
+      }
+      forEachSampleInReach(candidate, [&](int i)
+      {
+        if (!covered[i])
+        {
+          covered[i] = true;
+          --num_uncovered;
+        }
+      });
+      selected.push_back(candidate);
+    }
+
+    // remove circles that became redundant by circles selected later
+    std::vector<int> coverage_count(samples.size(), 0);
+    for (std::size_t candidate : selected)
+      forEachSampleInReach(candidate, [&](int i) {++coverage_count[i];});
+    Point2dContainer centers;
+    std::vector<double> radii;
+    for (int k = (int)selected.size() - 1; k >= 0; --k)
+    {
+      bool redundant = true;
+      forEachSampleInReach(selected[k], [&](int i) {redundant = redundant && coverage_count[i] > 1;});
+      if (redundant)
+        forEachSampleInReach(selected[k], [&](int i) {--coverage_count[i];});
+      else
+      {
+        centers.push_back(candidates[selected[k]]);
+        radii.push_back(reach[selected[k]] + margin);
+      }
+    }
+    // safeguard for degenerate polygons: circles around samples that are not covered yet
+    for (std::size_t i = 0; i < samples.size(); ++i)
+    {
+      if (covered[i])
+        continue;
+      centers.push_back(samples[i]);
+      radii.push_back(max_error);
+      for (std::size_t k = i; k < samples.size(); ++k)
+        covered[k] = covered[k] || (samples[k] - samples[i]).norm() <= max_error - margin;
+    }
+    return boost::shared_ptr<MultiCircleRobotFootprint>(new MultiCircleRobotFootprint(centers, radii));
+  }
+
+  /**
+    * @brief Calculate the distance between the robot and an obstacle
+    * @param current_pose Current robot pose
+    * @param obstacle Pointer to the obstacle
+    * @return Euclidean distance to the robot
+    */
+  virtual double calculateDistance(const PoseSE2& current_pose, const Obstacle* obstacle) const
+  {
+    double cos_th = std::cos(current_pose.theta());
+    double sin_th = std::sin(current_pose.theta());
+    double dist = HUGE_VAL;
+    for (int i = 0; i < numCircles(); ++i)
+    {
+      Eigen::Vector2d center(current_pose.x() + cos_th * centers_x_[i] - sin_th * centers_y_[i],
+                             current_pose.y() + sin_th * centers_x_[i] + cos_th * centers_y_[i]);
+      dist = std::min(dist, obstacle->getMinimumDistance(center) - radii_[i]);
+    }
+    return dist;
+  }
+
+  // implements calculateDistances() of the base class
+  virtual void calculateDistances(const Eigen::Ref<const Eigen::ArrayXd>& poses_x, const Eigen::Ref<const Eigen::ArrayXd>& poses_y,
+                                  const Eigen::Ref<const Eigen::ArrayXd>& poses_theta, const Obstacle* obstacle, Eigen::Ref<Eigen::ArrayXd> distances) const
+  {
+    Eigen::ArrayXd cos_theta = poses_theta.cos();
+    Eigen::ArrayXd sin_theta = poses_theta.sin();
+    Eigen::ArrayXd dist_circle(poses_x.size());
+    distances.setConstant(HUGE_VAL);
+    for (int i = 0; i < numCircles(); ++i)
+    {
+      obstacle->getMinimumDistances(poses_x + centers_x_[i] * cos_theta - centers_y_[i] * sin_theta,
+                                    poses_y + centers_x_[i] * sin_theta + centers_y_[i] * cos_theta, dist_circle);
+      distances = distances.min(dist_circle - radii_[i]);
+    }
+  }
+
+  /**
+    * @brief Estimate the distance between the robot and the predicted location of an obstacle at time t
+    * @param current_pose robot pose, from which the distance to the obstacle is estimated
+    * @param obstacle Pointer to the dynamic obstacle (constant velocity model is assumed)
+    * @param t time, for which the predicted distance to the obstacle is calculated
+    * @return Euclidean distance to the robot
+    */
+  virtual double estimateSpatioTemporalDistance(const PoseSE2& current_pose, const Obstacle* obstacle, double t) const
+  {
+    double cos_th = std::cos(current_pose.theta());
+    double sin_th = std::sin(current_pose.theta());
+    double dist = HUGE_VAL;
+    for (int i = 0; i < numCircles(); ++i)
+    {
+      Eigen::Vector2d center(current_pose.x() + cos_th * centers_x_[i] - sin_th * centers_y_[i],
+                             current_pose.y() + sin_th * centers_x_[i] + cos_th * centers_y_[i]);
+      dist = std::min(dist, obstacle->getMinimumSpatioTemporalDistance(center, t) - radii_[i]);
+    }
+    return dist;
+  }
+
+  /**
+    * @brief Visualize the robot using a markers
+    * 
+    * Fill a marker message with all necessary information (type, pose, scale and color).
+    * The header, namespace, id and marker lifetime will be overwritten.
+    * @param current_pose Current robot pose
+    * @param[out] markers container of marker messages describing the robot shape
+    * @param color Color of the footprint
+    */
+  virtual void visualizeRobot(const PoseSE2& current_pose, std::vector<visualization_msgs::Marker>& markers, const std_msgs::ColorRGBA& color) const
+  {
+    double cos_th = std::cos(current_pose.theta());
+    double sin_th = std::sin(current_pose.theta());
+    for (int i = 0; i < numCircles(); ++i)
+    {
+      if (radii_[i] <= 0)
+        continue;
+      markers.push_back(visualization_msgs::Marker());
+      visualization_msgs::Marker& marker = markers.back();
+      marker.type = visualization_msgs::Marker::CYLINDER;
+      current_pose.toPoseMsg(marker.pose);
+      marker.pose.position.x += cos_th * centers_x_[i] - sin_th * centers_y_[i];
+      marker.pose.position.y += sin_th * centers_x_[i] + cos_th * centers_y_[i];
+      marker.scale.x = marker.scale.y = 2*radii_[i]; // scale = diameter
+      marker.color = color;
+    }
+  }
+
+  /**
+   * @brief Compute the inscribed radius of the footprint model
+   * @return inscribed radius (largest circle around the robot center contained in one of the circles)
+   */
+  virtual double getInscribedRadius()
+  {
+    double radius = 0;
+    for (int i = 0; i < numCircles(); ++i)
+      radius = std::max(radius, radii_[i] - std::hypot(centers_x_[i], centers_y_[i]));
+    return radius;
+  }
+
+private:
+
+  Eigen::ArrayXd centers_x_; //!< x-coordinates of the circle centers (robot frame)
+  Eigen::ArrayXd centers_y_; //!< y-coordinates of the circle centers (robot frame)
+  Eigen::ArrayXd radii_; //!< Radii of the circles
+};
+
+
+
+
 
 
 } // namespace teb_local_planner
@@ -65,6 +65,10 @@ public:
 
   std::string odom_topic; //!< Topic name of the odometry message, provided by the robot driver or simulator
   std::string map_frame; //!< Global planning frame
+  bool pipeline_input_preparation; //!< If true, the inputs of the next cycle (plan transformation, via-points, obstacles) are prepared by a separate thread while the current cycle is optimized. Obstacles are one control cycle old (inputs older than 1.5 controller periods are prepared again synchronously), the robot pose is always the latest one. Read at startup only (not dynamically reconfigurable).
+  double latency_statistics_period; //!< Period [s] in which the latency statistics of the planning stages are published on the teb_latency topic (0: disabled; requires the cmake option TEB_LATENCY_PROFILING).
+  std::string planning_log; //!< File to which the inputs and results of each planning cycle are recorded (empty: disabled), see planning_record.h. Read at startup only (not dynamically reconfigurable).
+  int planning_log_queue_size; //!< Maximum number of records waiting to be written to the planning log (further records are dropped). Read at startup only (not dynamically reconfigurable).
 
   RobotFootprintModelPtr robot_model; //!< model of the robot's footprint
 
@@ -89,6 +93,7 @@ public:
     double feasibility_check_lookahead_distance; //!< Specify up to which distance (and with an index below feasibility_check_no_poses) from the robot the feasibility should be checked each sampling interval; if -1, all poses up to feasibility_check_no_poses are checked.
     bool publish_feedback; //!< Publish planner feedback containing the full trajectory and a list of active obstacles (should be enabled only for evaluation or debugging purposes)
     double min_resolution_collision_check_angular; //! Min angular resolution used during the costmap collision check. If not respected, intermediate samples are added. [rad]
+    int feasibility_check_heading_bins; //!< Number of heading bins for which the footprint outline is rasterized once and reused by the feasibility check (0: rasterize the footprint for each pose). The cached outline is widened conservatively by pi * circumscribed radius / bins, see FootprintCostmapModel. Only worth enabling for footprints with many vertices (e.g. 12-gon), it is slower than the exact check for simple elongated footprints (e.g. a 2 m cart rectangle). The cache is rebuilt whenever a dynamic footprint changes. Read at startup only (not dynamically reconfigurable).
     int control_look_ahead_poses; //! Index of the pose used to extract the velocity command
     int prevent_look_ahead_poses_near_goal; //! Prevents control_look_ahead_poses to look within this many poses of the goal in order to prevent overshoot & oscillation when xy_goal_tolerance is very small
   } trajectory; //!< Trajectory related parameters
@@ -184,7 +189,10 @@ public:
   {
     bool enable_homotopy_class_planning; //!< Activate homotopy class planning (Requires much more resources that simple planning, since multiple trajectories are optimized at once).
     bool enable_multithreading; //!< Activate multiple threading for planning multiple trajectories in parallel.
+    int worker_pool_size; //!< Number of persistent worker threads used if enable_multithreading is true (0: min(number of cpu cores, max_number_classes)). Read at startup only (not dynamically reconfigurable).
+    std::vector<int> worker_cpu_affinity; //!< Cpu cores the worker threads are pinned to (empty: no pinning). Read at startup only (not dynamically reconfigurable).
     bool simple_exploration; //!< If true, distinctive trajectories are explored using a simple left-right approach (pass each obstacle on the left or right side) for path generation, otherwise sample possible roadmaps randomly in a specified region between start and goal.
+    bool async_exploration; //!< If true, new homotopy classes are explored by a background thread on a snapshot of the obstacles. Paths found are initialized as new candidates in the next planning cycle, such that exploration is removed from the control loop.
     int max_number_classes; //!< Specify the maximum number of allowed alternative homotopy classes (limits computational effort)
     int max_number_plans_in_current_class; //!< Specify the maximum number of trajectories to try that are in the same homotopy class as the current trajectory (helps avoid local minima)
     double selection_cost_hysteresis; //!< Specify how much trajectory cost must a new candidate have w.r.t. a previously selected trajectory in order to be selected (selection if new_cost < old_cost*factor).
@@ -193,13 +201,25 @@ public:
     double selection_viapoint_cost_scale; //!< Extra scaling of via-point cost terms just for selecting the 'best' candidate.
     bool selection_alternative_time_cost; //!< If true, time cost is replaced by the total transition time.
     double selection_dropping_probability; //!< At each planning cycle, TEBs other than the current 'best' one will be randomly dropped with this probability. Prevents becoming 'fixated' on sub-optimal alternative homotopies.
+    bool selection_lower_bound_pruning; //!< If true, the selected trajectory is optimized first and candidates whose estimated cost lower bound cannot beat it are optimized with a reduced number of outer iterations (heuristic, might discard a better candidate).
+    int selection_pruned_outer_iterations; //!< Number of outer iterations for candidates pruned by selection_lower_bound_pruning (0: skip optimization, the candidate is not selectable in this cycle).
+    std::string optimization_budget_policy; //!< Distribution of the outer iterations among the candidates: 'uniform' (each candidate receives no_outer_iterations) or 'successive_halving' (only the better half of the candidates is optimized further after each round).
     double switching_blocking_period; //!< Specify a time duration in seconds that needs to be expired before a switch to new equivalence class is allowed
 
     int roadmap_graph_no_samples; //! < Specify the number of samples generated for creating the roadmap graph, if simple_exploration is turend off.
     double roadmap_graph_area_width; //!< Random keypoints/waypoints are sampled in a rectangular region between start and goal. Specify the width of that region in meters.
     double roadmap_graph_area_length_scale; //!< The length of the rectangular region is determined by the distance between start and goal. This parameter further scales the distance such that the geometric center remains equal!
+    double roadmap_graph_max_edge_length; //!< Maximum length [m] of an edge in the roadmap graph (0: unbounded). Limits the number of edges (and collision checks) for large numbers of samples.
+    bool roadmap_graph_reuse; //!< If true, roadmap keypoints are drawn from a low-discrepancy sequence and kept across planning cycles while they remain inside the sampling area (collision checks of their edges are cached), otherwise keypoints are sampled randomly in each cycle.
+    int graph_search_max_expansions; //!< Maximum number of partial paths expanded while searching the exploration graph for paths of distinct homotopy classes (0: unbounded).
     double h_signature_prescaler; //!< Scale number of obstacle value in order to allow huge number of obstacles. Do not choose it extremly low, otherwise obstacles cannot be distinguished from each other (0.2<H<=1).
     double h_signature_threshold; //!< Two h-signatures are assumed to be equal, if both the difference of real parts and complex parts are below the specified threshold.
+    int h_signature_int_steps; //!< Number of integration steps per path segment for the 3d h-signature (used if dynamic obstacles are included). Upper bound if h_signature_adaptive_int_steps is enabled.
+    bool h_signature_adaptive_int_steps; //!< If true, path segments far away from all obstacles are integrated with fewer steps (step length <= half of the distance to the closest obstacle) when computing the 3d h-signature.
+    bool h_signature_filter_obstacles; //!< If true, equivalence classes are computed w.r.t. a reduced obstacle set (obstacles close to the start-goal corridor, nearby point obstacles merged).
+    double h_signature_corridor_width; //!< Width [m] of the corridor around the straight line from start to goal. Static obstacles outside are ignored for computing equivalence classes (requires h_signature_filter_obstacles).
+    double h_signature_cluster_dist; //!< Static point obstacles closer than this distance [m] are merged into a single obstacle for computing equivalence classes (requires h_signature_filter_obstacles, 0 disables clustering).
+    double h_signature_cache_tolerance; //!< Obstacle contributions to the h-signature of a trajectory are reused in the next cycle if obstacle and trajectory moved less than this fraction of their distance (0 disables caching, obstacles that moved more than 0.25 m are always recomputed).
 
     double obstacle_keypoint_offset; //!< If simple_exploration is turned on, this parameter determines the distance on the left and right side of the obstacle at which a new keypoint will be cretead (in addition to min_obstacle_dist).
     double obstacle_heading_threshold; //!< Specify the value of the normalized scalar product between obstacle heading and goal heading in order to take them (obstacles) into account for exploration [0,1]
@@ -247,6 +267,10 @@ public:
 
     odom_topic = "odom";
     map_frame = "odom";
+    pipeline_input_preparation = false;
+    latency_statistics_period = 1.0;
+    planning_log = "";
+    planning_log_queue_size = 16;
     robot_model = boost::make_shared<PointRobotFootprint>();
 
     // Trajectory
@@ -269,6 +293,7 @@ public:
     trajectory.feasibility_check_lookahead_distance = -1;
     trajectory.publish_feedback = false;
     trajectory.min_resolution_collision_check_angular = M_PI;
+    trajectory.feasibility_check_heading_bins = 0;
     trajectory.control_look_ahead_poses = 1;
     trajectory.prevent_look_ahead_poses_near_goal = 0;
 
@@ -349,7 +374,9 @@ public:
 
     hcp.enable_homotopy_class_planning = true;
     hcp.enable_multithreading = true;
+    hcp.worker_pool_size = 0;
     hcp.simple_exploration = false;
+    hcp.async_exploration = false;
     hcp.max_number_classes = 5;
     hcp.selection_cost_hysteresis = 1.0;
     hcp.selection_prefer_initial_plan = 0.95;
@@ -357,14 +384,26 @@ public:
     hcp.selection_viapoint_cost_scale = 1.0;
     hcp.selection_alternative_time_cost = false;
     hcp.selection_dropping_probability = 0.0;
+    hcp.selection_lower_bound_pruning = false;
+    hcp.selection_pruned_outer_iterations = 1;
+    hcp.optimization_budget_policy = "uniform";
 
     hcp.obstacle_keypoint_offset = 0.1;
     hcp.obstacle_heading_threshold = 0.45;
     hcp.roadmap_graph_no_samples = 15;
     hcp.roadmap_graph_area_width = 6; // [m]
     hcp.roadmap_graph_area_length_scale = 1.0;
+    hcp.roadmap_graph_max_edge_length = 0.0;
+    hcp.roadmap_graph_reuse = false;
+    hcp.graph_search_max_expansions = 10000;
     hcp.h_signature_prescaler = 1;
     hcp.h_signature_threshold = 0.1;
+    hcp.h_signature_int_steps = 10;
+    hcp.h_signature_adaptive_int_steps = false;
+    hcp.h_signature_filter_obstacles = false;
+    hcp.h_signature_corridor_width = 6.0;
+    hcp.h_signature_cluster_dist = 0.4;
+    hcp.h_signature_cache_tolerance = 0.05;
     hcp.switching_blocking_period = 0.0;
 
     hcp.viapoints_all_candidates = true;